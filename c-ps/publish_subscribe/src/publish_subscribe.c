@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <signal.h>
 #include <unistd.h>
+#include <math.h>
 
 // API headers
 #include "polysync_core.h"
@@ -11,6 +12,9 @@
 #include "polysync_message.h"
 #include "polysync_node_template.h"
 
+// asynchronous log, nothing is formatted nor written in the callback
+#include "ps_log.h"
+
 
 
 
@@ -22,16 +26,11 @@
 #define NODE_FLAGS_VALUE (0)
 #endif
 
-#define DEBUG_DEAN
-#ifdef DEBUG_DEAN
-
-	//#define TESE
-	//#define DETAIL
-	#define OUTPUT
-
-#endif
-
 static const char NODE_NAME[] = "polysync-publish-subscribe-c";
+
+// log of the points, PS_LOG=debug:points for the points in front, trace for all of them
+static const char LOG_FILE[] = "polysync-publish-subscribe-c.log";
+static Logger my_logger;
 static const char LIDAR_POINTS_MSG_NAME[] = "ps_lidar_points_msg";
 static const char POINTS_MSG_NAME[] = "ps_lidar_points_msg";
 typedef struct
@@ -72,53 +71,37 @@ static void ps_lidar_points_msg__handler(
 {
     // cast to message
     const ps_lidar_points_msg * const lidar_points_msg = (ps_lidar_points_msg*) message;
+    const ps_lidar_point *_buffer = lidar_points_msg->points._buffer;
+    unsigned long lidar_points_index = 0;
 
-    #ifdef DETAIL
-		// print details
-    	printf( "  received lidar_points message from node 0x%016llX (%llu)\n",
-            	(unsigned long long) lidar_points_msg->header.src_guid,
-            	(unsigned long long) lidar_points_msg->header.src_guid );
+	LOG_AT( &my_logger, LOGGER_DEBUG, LOGGER_POINTS,
+			"lidar_points message from node 0x%016llX, timestamp %llu, %lu points",
+			(unsigned long long) lidar_points_msg->header.src_guid,
+			(unsigned long long) lidar_points_msg->header.timestamp,
+			(unsigned long) lidar_points_msg->points._length );
 
-    	printf( "  received lidar_points message from node 0x%016llX (%llu)\n",
-            	(unsigned long long) lidar_points_msg->header.timestamp,
-            	(unsigned long long) lidar_points_msg->header.timestamp );
-	#endif
+	// one record per point, only when they are logged at all
+	if( !loggerEnabled( &my_logger, LOGGER_DEBUG, LOGGER_POINTS ) )
+	{
+		return;
+	}
 
-    unsigned long lidar_points_index = 0;
-    // 
     while( lidar_points_index < lidar_points_msg->points._length )
     {
-
-        const ps_lidar_point *_buffer = lidar_points_msg->points._buffer;
-
-	#ifdef DETAIL
-        	printf( "  publishers lidar_points :\n");
-        	printf( "  received length = 0x%016llX\n",
-               	 	(unsigned long) lidar_points_msg->points._length);
-			printf( "  received position:\nx = %016lf\ny = %016lf\nz = %016lf\n",
-				(double) _buffer[lidar_points_index].position[0],
-				(double) _buffer[lidar_points_index].position[1],
-				(double) _buffer[lidar_points_index].position[2]);
-	#endif
-
-	#ifdef	OUTPUT
-
-		if(		_buffer[lidar_points_index].position[0] < 15 && 
-				abs( _buffer[lidar_points_index].position[1]*10) < 12 && 
-				_buffer[lidar_points_index].position[2] > 0)
-		
-			printf( "%016lf\t%016lf\t%016lf\n",
-                		(double) _buffer[lidar_points_index].position[0],
-						(double) _buffer[lidar_points_index].position[1],
-						(double) _buffer[lidar_points_index].position[2]);
-	#endif
+		const float * const position = _buffer[lidar_points_index].position;
+
+		// all of them, or the ones of the lane in front
+		if( loggerEnabled( &my_logger, LOGGER_TRACE, LOGGER_POINTS )
+				|| (position[0] < 15 && fabs( position[1] * 10 ) < 12 && position[2] > 0) )
+		{
+			LOG_AT( &my_logger, LOGGER_DEBUG, LOGGER_POINTS, "%016lf\t%016lf\t%016lf",
+					(double) position[0],
+					(double) position[1],
+					(double) position[2] );
+		}
 
         lidar_points_index++;
     }
-
-    printf( "\n" );
-    
-    
 }
 
 
@@ -186,6 +169,17 @@ static void on_init(
     ps_msg_type msg_type = PSYNC_MSG_TYPE_INVALID;
 	
 
+    // log of the points, PS_LOG sets what is logged
+    if( openLogger( &my_logger, LOG_FILE, LOGGER_RECORDS ) != 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_WARN,
+                "%s : (%u) -- failed to open the log %s, nothing is logged",
+                __FILE__,
+                __LINE__,
+                LOG_FILE );
+    }
+
     // get diagnostic trace message type identifier
     ret = psync_message_get_type_by_name(
             node_ref,
@@ -314,7 +308,9 @@ static void on_release(
         free( node_data );
         node_data = NULL;
     }
-    
+
+    // write what is still queued
+    closeLogger( &my_logger );
 }
 
 
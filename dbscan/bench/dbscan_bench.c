@@ -0,0 +1,894 @@
+#define _GNU_SOURCE
+#include"dbscan.h"
+
+#define BENCH_NEIGHBORHOOD  0.3
+#define BENCH_OBJECT_POINTS 40
+#define BENCH_REPEAT        5
+#define BENCH_SWEEP_SIZE    10000
+#define BENCH_DENSE_SIZE    20000   //points of the dense frame, a close wall of a high resolution scan
+#define BENCH_DENSE_SIDE    4.0     //side of the square they are spread on, about 350 neighbors a point
+#define BENCH_KNN           8
+#define BENCH_MINPTS        5
+#define BENCH_FRAMES        20
+#define BENCH_QUEUE_POINTS  20000
+#define BENCH_QUEUE_ROUNDS  200
+#define BENCH_THREAD_FRAMES 5
+#define BENCH_KERNEL_SIZE   1024
+#define BENCH_KERNEL_ROUNDS 20000
+#define BENCH_LOAD_SIZE     100000
+#define BENCH_SIGN_HEIGHT   2.0     //z of the signs stacked over every other object
+#define BENCH_NEIGHBORHOOD_Z 0.15
+#define BENCH_SCAN_FOV      50.0    //half of the field of view of the synthetic LUX scan, degrees
+#define BENCH_SCAN_OBJECTS  40      //posts and cars of the scan, vertical cylinders
+#define BENCH_SCAN_HEIGHT   0.5     //height of the scanner above the ground
+#define BENCH_SCAN_RANGE    60.0    //no return beyond
+#define BENCH_SCAN_POINTS   100000  //largest recorded scan read
+
+static const int bench_size[] = {500, 1000, 2000, 5000, 10000, 20000};
+static const double bench_sweep[] = {0.1, 0.2, 0.3, 0.5, 0.8};
+static const int bench_thread_size[] = {1000, 10000, 100000};
+static const int bench_threads[] = {1, 2, 4, 8};
+static const char* bench_simd_name[] = {"scalar", "sse2", "avx2"};
+static const int bench_stack_size[] = {1000, 10000, 50000};
+static const int bench_scan_beams[] = {800, 3200, 12800};
+
+    /*
+     * monotonic time in milliseconds
+     * */
+    static double nowMs()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+    }
+
+    static double uniform(double low, double high)
+    {
+        return low + (high - low) * rand() / (double)RAND_MAX;
+    }
+
+    /*
+     * a synthetic scan in front of the car: objects of BENCH_OBJECT_POINTS returns
+     * spread over 0.5 m, plus one point in ten of uniform noise, point[1..size]
+     * */
+    static void makeFrame(Point* point, int size)
+    {
+        int i = 1;
+        double cx = 0, cy = 0;
+        while( i <= size )
+        {
+            if( i % 10 == 0 )
+            {
+                point[i].x = uniform(0, 50);
+                point[i].y = uniform(-20, 20);
+            }
+            else
+            {
+                if( i % BENCH_OBJECT_POINTS == 1 )
+                {
+                    cx = uniform(0, 50);
+                    cy = uniform(-20, 20);
+                }
+                point[i].x = cx + uniform(-0.5, 0.5);
+                point[i].y = cy + uniform(-0.5, 0.5);
+            }
+            point[i].z = 0;
+            i++;
+        }
+    }
+
+    /*
+     * @size points spread evenly on a square of BENCH_DENSE_SIDE, every neighborhood holds hundreds of them
+     * */
+    static void makeDenseFrame(Point* point, int size)
+    {
+        int i;
+        for( i = 1; i <= size; i++ )
+        {
+            point[i].x = uniform(0, BENCH_DENSE_SIDE);
+            point[i].y = uniform(0, BENCH_DENSE_SIDE);
+            point[i].z = 0;
+        }
+    }
+
+    /*
+     * the O(n^2) scan of calculateDistance_BetweenOneToAll, reference for the grid
+     * */
+    static int searchAll(const Point* point, int size, int pointID, double eps, int* result)
+    {
+        int i;
+        int count = 0;
+        for( i = 1; i <= size; i++ )
+        {
+            if( i != pointID && sqrt( pow((double)(point[pointID].x - point[i].x), 2) + pow((double)(point[pointID].y - point[i].y), 2)) <= eps )
+                result[count++] = i;
+        }
+        return count;
+    }
+
+    /*
+     * the frame of makeFrame in 3D: the objects are 0.3 m high on the ground, every other one
+     * has a sign of the same footprint BENCH_SIGN_HEIGHT above it, the noise is spread up to 3 m
+     * */
+    static void makeStackedFrame(Point* point, int size)
+    {
+        int i;
+        makeFrame(point, size);
+        for( i = 1; i <= size; i++ )
+        {
+            if( i % 10 == 0 )
+                point[i].z = uniform(0, 3);
+            else
+                point[i].z = uniform(0, 0.3) + ((i - 1) / BENCH_OBJECT_POINTS % 2) * BENCH_SIGN_HEIGHT;
+        }
+    }
+
+    /*
+     * per-frame neighbor search time, full scan against the grid
+     *  the last row is the dense frame, where the lists are long and must still be merged in linear time
+     * */
+    static void benchNeighbor()
+    {
+        int sizes = (int)(sizeof(bench_size) / sizeof(bench_size[0]));
+        int s, r, i;
+        printf("neighbor search, neighborhood %.2f, mean of %d frames\n", BENCH_NEIGHBORHOOD, BENCH_REPEAT);
+        printf("%8s %6s %12s %12s %9s %12s %10s\n", "points", "frame", "scan ms", "grid ms", "speedup", "graph ms", "edges");
+        for( s = 0; s <= sizes; s++ )
+        {
+            int size = s < sizes ? bench_size[s] : BENCH_DENSE_SIZE;
+            Point* point = (Point*)malloc(sizeof(Point) * (size + 1));
+            int* expect = (int*)malloc(sizeof(int) * (size + 1));
+            int* result = (int*)malloc(sizeof(int) * (size + 1));
+            GridIndex grid;
+            NeighborGraph graph;
+            double scanMs = 0, gridMs = 0, graphMs = 0, start;
+            long edges = 0;
+            if( !point || !expect || !result )
+            {
+                printf("bench malloc error!\n");
+                exit(0);
+            }
+            initialGrid(&grid, size);
+            initialGraph(&graph, size);
+            for( r = 0; r < BENCH_REPEAT; r++ )
+            {
+                if( s < sizes )
+                    makeFrame(point, size);
+                else
+                    makeDenseFrame(point, size);
+
+                start = nowMs();
+                for( i = 1; i <= size; i++ )
+                    edges += searchAll(point, size, i, BENCH_NEIGHBORHOOD, expect);
+                scanMs += nowMs() - start;
+
+                start = nowMs();
+                buildGrid(&grid, point, size, BENCH_NEIGHBORHOOD, 2, 0);
+                for( i = 1; i <= size; i++ )
+                    searchGrid(&grid, point, i, BENCH_NEIGHBORHOOD, result, graph.scratch);
+                gridMs += nowMs() - start;
+
+                start = nowMs();
+                buildGrid(&grid, point, size, BENCH_NEIGHBORHOOD, 2, 0);
+                buildGraph(&graph, &grid, point, size, BENCH_NEIGHBORHOOD);
+                graphMs += nowMs() - start;
+            }
+            printf("%8d %6s %12.3f %12.3f %8.1fx %12.3f %10ld\n", size, s < sizes ? "spread" : "dense", scanMs / BENCH_REPEAT, gridMs / BENCH_REPEAT,
+                    scanMs / gridMs, graphMs / BENCH_REPEAT, edges / BENCH_REPEAT);
+            destroyGrid(&grid);
+            destroyGraph(&graph);
+            free(point);
+            free(expect);
+            free(result);
+        }
+    }
+
+    /*
+     * epsilon sweep on one frame: the grid is rebuilt for every neighborhood,
+     * the kd-tree is built once and answers all of them
+     * */
+    static void benchKdTree()
+    {
+        int size = BENCH_SWEEP_SIZE;
+        Point* point = (Point*)malloc(sizeof(Point) * (size + 1));
+        int* expect = (int*)malloc(sizeof(int) * (size + 1));
+        int* result = (int*)malloc(sizeof(int) * (size + 1));
+        double distance[BENCH_KNN];
+        GridIndex grid;
+        KdTree tree;
+        double start, gridMs, treeMs, buildMs, knnMs;
+        int s, i;
+        if( !point || !expect || !result || initialGrid(&grid, size) != 0 || initialKdTree(&tree, size, 3) != 0 )
+        {
+            printf("bench malloc error!\n");
+            exit(0);
+        }
+        makeFrame(point, size);
+
+        start = nowMs();
+        buildKdTree(&tree, (const double*)point, size);
+        buildMs = nowMs() - start;
+
+        printf("\nneighborhood sweep on %d points, kd-tree built once in %.3f ms\n", size, buildMs);
+        printf("%8s %12s %12s\n", "eps", "grid ms", "kd-tree ms");
+        for( s = 0; s < (int)(sizeof(bench_sweep) / sizeof(bench_sweep[0])); s++ )
+        {
+            start = nowMs();
+            buildGrid(&grid, point, size, bench_sweep[s], 2, 0);
+            for( i = 1; i <= size; i++ )
+                searchGrid(&grid, point, i, bench_sweep[s], expect, result);
+            gridMs = nowMs() - start;
+
+            start = nowMs();
+            for( i = 1; i <= size; i++ )
+                searchKdTree(&tree, (const double*)&point[i], bench_sweep[s], i, result);
+            treeMs = nowMs() - start;
+            printf("%8.2f %12.3f %12.3f\n", bench_sweep[s], gridMs, treeMs);
+        }
+
+        start = nowMs();
+        for( i = 1; i <= size; i++ )
+            nearestKdTree(&tree, (const double*)&point[i], BENCH_KNN, i, result, distance);
+        knnMs = nowMs() - start;
+        printf("%d-nearest of every point: %.3f ms\n", BENCH_KNN, knnMs);
+
+        destroyGrid(&grid);
+        destroyKdTree(&tree);
+        free(point);
+        free(expect);
+        free(result);
+    }
+
+    /*
+     * the linked-list queue dbscan used before the ring buffer, one malloc per insert
+     * */
+    typedef struct QueueNode
+    {
+        int data;
+        struct QueueNode* next;
+    }QueueNode;
+
+    typedef struct LinkQueue
+    {
+        QueueNode* front;
+        QueueNode* rear;
+    }LinkQueue;
+
+    static void initialLinkQueue(LinkQueue* LQ)
+    {
+        LQ->front = (QueueNode*)malloc(sizeof(QueueNode));
+        LQ->rear = LQ->front;
+        LQ->rear->next = NULL;
+    }
+
+    static void insertLinkQueue(LinkQueue* LQ, int pointID)
+    {
+        QueueNode* node = (QueueNode*)malloc(sizeof(QueueNode));
+        node->data = pointID;
+        node->next = NULL;
+        LQ->rear->next = node;
+        LQ->rear = node;
+    }
+
+    static void deleteLinkQueue(LinkQueue* LQ, int* pointID)
+    {
+        QueueNode* p = LQ->front->next;
+        *pointID = p->data;
+        LQ->front->next = p->next;
+        if( p == LQ->rear )
+            LQ->rear = LQ->front;
+        free(p);
+    }
+
+    /*
+     * the access pattern of the cluster expansion: a burst of inserts, then delete one
+     * and insert a few until the queue drains, every point passing through once
+     * */
+    static void benchQueue()
+    {
+        LinkQueue link;
+        RingQueue ring;
+        double start, linkMs, ringMs;
+        int r, i, id;
+        initialLinkQueue(&link);
+        initialQueue(&ring, BENCH_QUEUE_POINTS + 1);
+
+        start = nowMs();
+        for( r = 0; r < BENCH_QUEUE_ROUNDS; r++ )
+        {
+            for( i = 1; i <= 64; i++ )
+                insertLinkQueue(&link, i);
+            for( i = 65; link.front != link.rear; )
+            {
+                deleteLinkQueue(&link, &id);
+                if( i <= BENCH_QUEUE_POINTS )
+                    insertLinkQueue(&link, i++);
+            }
+        }
+        linkMs = nowMs() - start;
+
+        start = nowMs();
+        for( r = 0; r < BENCH_QUEUE_ROUNDS; r++ )
+        {
+            for( i = 1; i <= 64; i++ )
+                insertQueue(&ring, i);
+            for( i = 65; !isEmptyQueue(&ring); )
+            {
+                deleteQueue(&ring, &id);
+                if( i <= BENCH_QUEUE_POINTS )
+                    insertQueue(&ring, i++);
+            }
+        }
+        ringMs = nowMs() - start;
+
+        printf("\nwork queue, %d rounds of %d points\n", BENCH_QUEUE_ROUNDS, BENCH_QUEUE_POINTS);
+        printf("%12s %12s %9s\n", "linked ms", "ring ms", "speedup");
+        printf("%12.3f %12.3f %8.1fx\n", linkMs, ringMs, linkMs / ringMs);
+        free(link.front);
+        destroyQueue(&ring);
+    }
+
+    /*
+     * whole clustering of a frame with one context reused frame after frame,
+     * the first frame sizes the buffers and is not counted
+     * */
+    static void benchPipeline()
+    {
+        int s, f;
+        printf("\ndbscan_ctx_run, ordered seeds, neighborhood %.2f, MinPts %d, mean of %d frames\n", BENCH_NEIGHBORHOOD, BENCH_MINPTS, BENCH_FRAMES);
+        printf("%8s %12s %10s\n", "points", "frame ms", "clusters");
+        for( s = 0; s < (int)(sizeof(bench_size) / sizeof(bench_size[0])); s++ )
+        {
+            int size = bench_size[s];
+            Point* frame = (Point*)malloc(sizeof(Point) * (size + 1));
+            dbscan_ctx* ctx = dbscan_ctx_create(size, BENCH_NEIGHBORHOOD, BENCH_MINPTS);
+            double total = 0, start;
+            int clusters = 0;
+            if( !frame || !ctx )
+            {
+                printf("bench malloc error!\n");
+                exit(0);
+            }
+            ctx->seedMode = DBSCAN_SEED_ORDERED;
+            for( f = 0; f <= BENCH_FRAMES; f++ )
+            {
+                makeFrame(frame, size);
+                start = nowMs();
+                clusters = dbscan_ctx_run(ctx, frame + 1, size);
+                if( f > 0 )
+                    total += nowMs() - start;
+            }
+            printf("%8d %12.3f %10d\n", size, total / BENCH_FRAMES, clusters);
+            dbscan_ctx_destroy(ctx);
+            free(frame);
+        }
+    }
+
+    /*
+     * dbscan_ctx_run on 1 to 8 threads, the same frames for every thread count
+     * */
+    static void benchThreads()
+    {
+        int s, t, f;
+        printf("\ndbscan_ctx_run by threads, ordered seeds, neighborhood %.2f, mean of %d frames\n", BENCH_NEIGHBORHOOD, BENCH_THREAD_FRAMES);
+        printf("%8s %8s %12s %10s\n", "points", "threads", "frame ms", "speedup");
+        for( s = 0; s < (int)(sizeof(bench_thread_size) / sizeof(bench_thread_size[0])); s++ )
+        {
+            int size = bench_thread_size[s];
+            Point* frame = (Point*)malloc(sizeof(Point) * (size + 1) * BENCH_THREAD_FRAMES);
+            double serialMs = 0;
+            if( !frame )
+            {
+                printf("bench malloc error!\n");
+                exit(0);
+            }
+            for( f = 0; f < BENCH_THREAD_FRAMES; f++ )
+                makeFrame(frame + f * (size + 1), size);
+            for( t = 0; t < (int)(sizeof(bench_threads) / sizeof(bench_threads[0])); t++ )
+            {
+                dbscan_ctx* ctx = dbscan_ctx_create(size, BENCH_NEIGHBORHOOD, BENCH_MINPTS);
+                double total = 0, start;
+                ctx->seedMode = DBSCAN_SEED_ORDERED;
+                dbscan_ctx_set_threads(ctx, bench_threads[t]);
+                //one frame to size the buffers of the workers
+                dbscan_ctx_run(ctx, frame + 1, size);
+                for( f = 0; f < BENCH_THREAD_FRAMES; f++ )
+                {
+                    start = nowMs();
+                    dbscan_ctx_run(ctx, frame + f * (size + 1) + 1, size);
+                    total += nowMs() - start;
+                }
+                total /= BENCH_THREAD_FRAMES;
+                if( t == 0 )
+                    serialMs = total;
+                printf("%8d %8d %12.3f %10.2f\n", size, bench_threads[t], total, serialMs / total);
+                dbscan_ctx_destroy(ctx);
+            }
+            free(frame);
+        }
+    }
+
+    /*
+     * DBSCAN_LABEL_UNION on 1 to 8 threads against the BFS of the same frames
+     * */
+    static void benchUnion()
+    {
+        int s, t, f;
+        printf("\ndbscan_ctx_run with union-find labels, neighborhood %.2f, mean of %d frames\n", BENCH_NEIGHBORHOOD, BENCH_THREAD_FRAMES);
+        printf("%8s %8s %12s %12s %10s\n", "points", "threads", "bfs ms", "union ms", "borders");
+        for( s = 0; s < (int)(sizeof(bench_thread_size) / sizeof(bench_thread_size[0])); s++ )
+        {
+            int size = bench_thread_size[s];
+            Point* frame = (Point*)malloc(sizeof(Point) * (size + 1) * BENCH_THREAD_FRAMES);
+            int* bfs = (int*)malloc(sizeof(int) * size * BENCH_THREAD_FRAMES);
+            if( !frame || !bfs )
+            {
+                printf("bench malloc error!\n");
+                exit(0);
+            }
+            for( f = 0; f < BENCH_THREAD_FRAMES; f++ )
+                makeFrame(frame + f * (size + 1), size);
+            for( t = 0; t < (int)(sizeof(bench_threads) / sizeof(bench_threads[0])); t++ )
+            {
+                dbscan_ctx* ctx = dbscan_ctx_create(size, BENCH_NEIGHBORHOOD, BENCH_MINPTS);
+                double bfsMs = 0, unionMs = 0, start;
+                int moved = 0, i;
+                const int* cluster;
+                ctx->seedMode = DBSCAN_SEED_ORDERED;
+                dbscan_ctx_set_threads(ctx, bench_threads[t]);
+                dbscan_ctx_run(ctx, frame + 1, size);
+                for( f = 0; f < BENCH_THREAD_FRAMES; f++ )
+                {
+                    ctx->labelMode = DBSCAN_LABEL_BFS;
+                    start = nowMs();
+                    dbscan_ctx_run(ctx, frame + f * (size + 1) + 1, size);
+                    bfsMs += nowMs() - start;
+                    memcpy(bfs + f * size, dbscan_ctx_results(ctx, NULL), sizeof(int) * size);
+
+                    ctx->labelMode = DBSCAN_LABEL_UNION;
+                    start = nowMs();
+                    dbscan_ctx_run(ctx, frame + f * (size + 1) + 1, size);
+                    unionMs += nowMs() - start;
+                    cluster = dbscan_ctx_results(ctx, NULL);
+                    for( i = 0; i < size; i++ )
+                        moved += cluster[i] != bfs[f * size + i];
+                }
+                //borders: points put in another cluster than the BFS did, each of them next to both
+                printf("%8d %8d %12.3f %12.3f %10d\n", size, bench_threads[t], bfsMs / BENCH_THREAD_FRAMES, unionMs / BENCH_THREAD_FRAMES, moved);
+                dbscan_ctx_destroy(ctx);
+            }
+            free(bfs);
+            free(frame);
+        }
+    }
+
+    /*
+     * one query against BENCH_KERNEL_SIZE candidates: the sqrt(pow) test of the original code
+     * against the squared-distance kernel at every level, in ns per candidate
+     * then the whole neighbor graph with every kernel
+     * */
+    static void benchKernel()
+    {
+        PointStore store;
+        int* hit = (int*)malloc(sizeof(int) * BENCH_KERNEL_SIZE);
+        int level, r, k, s, hits = 0;
+        double start, eps = BENCH_NEIGHBORHOOD * 4;
+        RadiusKernel kernel;
+        if( !hit )
+        {
+            printf("bench malloc error!\n");
+            exit(0);
+        }
+        initialPointStore(&store, BENCH_KERNEL_SIZE, 2);
+        for( k = 0; k < BENCH_KERNEL_SIZE; k++ )
+        {
+            store.x[k] = uniform(-2, 2);
+            store.y[k] = uniform(-2, 2);
+        }
+        printf("\ndistance kernel, one query against %d candidates, best level of this cpu: %s\n", BENCH_KERNEL_SIZE, bench_simd_name[detectSimd()]);
+        printf("%8s %12s %10s\n", "kernel", "ns/point", "inside");
+        start = nowMs();
+        for( r = 0; r < BENCH_KERNEL_ROUNDS; r++ )
+        {
+            for( k = 0, hits = 0; k < BENCH_KERNEL_SIZE; k++ )
+            {
+                if( sqrt( pow(store.x[k] - r * 1e-9, 2) + pow(store.y[k], 2)) <= eps )
+                    hit[hits++] = k;
+            }
+        }
+        printf("%8s %12.3f %10d\n", "sqrt pow", (nowMs() - start) * 1e6 / ((double)BENCH_KERNEL_ROUNDS * BENCH_KERNEL_SIZE), hits);
+        for( level = SIMD_SCALAR; level <= detectSimd(); level++ )
+        {
+            kernel = selectRadiusKernel(level);
+            start = nowMs();
+            for( r = 0; r < BENCH_KERNEL_ROUNDS; r++ )
+                hits = kernel(store.x, store.y, BENCH_KERNEL_SIZE, r * 1e-9, 0, eps * eps, hit);
+            printf("%8s %12.3f %10d\n", bench_simd_name[level], (nowMs() - start) * 1e6 / ((double)BENCH_KERNEL_ROUNDS * BENCH_KERNEL_SIZE), hits);
+        }
+        destroyPointStore(&store);
+        free(hit);
+
+        printf("\nneighbor graph by kernel, neighborhood %.2f, mean of %d frames\n", BENCH_NEIGHBORHOOD, BENCH_REPEAT);
+        printf("%8s %8s %12s %10s\n", "points", "kernel", "graph ms", "speedup");
+        for( s = 0; s < (int)(sizeof(bench_thread_size) / sizeof(bench_thread_size[0])); s++ )
+        {
+            int size = bench_thread_size[s];
+            Point* point = (Point*)malloc(sizeof(Point) * (size + 1) * BENCH_REPEAT);
+            double scalarMs = 0, total;
+            GridIndex grid;
+            NeighborGraph graph;
+            if( !point )
+            {
+                printf("bench malloc error!\n");
+                exit(0);
+            }
+            for( r = 0; r < BENCH_REPEAT; r++ )
+                makeFrame(point + r * (size + 1), size);
+            initialGrid(&grid, size);
+            initialGraph(&graph, size);
+            for( level = SIMD_SCALAR; level <= detectSimd(); level++ )
+            {
+                grid.kernel = selectRadiusKernel(level);
+                total = 0;
+                for( r = 0; r < BENCH_REPEAT; r++ )
+                {
+                    start = nowMs();
+                    buildGrid(&grid, point + r * (size + 1), size, BENCH_NEIGHBORHOOD, 2, 0);
+                    buildGraph(&graph, &grid, point + r * (size + 1), size, BENCH_NEIGHBORHOOD);
+                    total += nowMs() - start;
+                }
+                total /= BENCH_REPEAT;
+                if( level == SIMD_SCALAR )
+                    scalarMs = total;
+                printf("%8d %8s %12.3f %10.2f\n", size, bench_simd_name[level], total, scalarMs / total);
+            }
+            destroyGraph(&graph);
+            destroyGrid(&grid);
+            free(point);
+        }
+    }
+
+    /*
+     * loading a recorded frame: ReadData on the text file against the mapped point cloud,
+     * both up to the points being in a context, written next to the bench and removed afterwards
+     * */
+    static void benchLoad()
+    {
+        const char* text = "dbscan_bench_cloud.txt";
+        const char* binary = "dbscan_bench_cloud.bin";
+        Point* point = (Point*)malloc(sizeof(Point) * (BENCH_LOAD_SIZE + 1));
+        Point* loaded = (Point*)malloc(sizeof(Point) * BENCH_LOAD_SIZE);
+        float* xyz = (float*)malloc(sizeof(float) * 2 * BENCH_LOAD_SIZE);
+        dbscan_ctx* ctx = dbscan_ctx_create(BENCH_LOAD_SIZE, BENCH_NEIGHBORHOOD, BENCH_MINPTS);
+        PointCloud cloud;
+        FILE* fwrite_text;
+        double textMs = 0, cloudMs = 0, start;
+        int i, r;
+        if( !point || !loaded || !xyz || !ctx )
+        {
+            printf("bench malloc error!\n");
+            exit(0);
+        }
+        makeFrame(point, BENCH_LOAD_SIZE);
+        if( NULL == (fwrite_text = fopen(text, "w")))
+        {
+            printf("open file(%s) error\n", text);
+            exit(0);
+        }
+        for( i = 1; i <= BENCH_LOAD_SIZE; i++ )
+        {
+            fprintf(fwrite_text, "%f\t%f\n", point[i].x, point[i].y);
+            xyz[(i - 1) * 2] = (float)point[i].x;
+            xyz[(i - 1) * 2 + 1] = (float)point[i].y;
+        }
+        fclose(fwrite_text);
+        if( writeCloud(binary, xyz, 2, BENCH_LOAD_SIZE, 0) != 0 )
+            exit(0);
+
+        for( r = 0; r < BENCH_REPEAT; r++ )
+        {
+            start = nowMs();
+            if( ReadData(text, loaded, BENCH_LOAD_SIZE) != 0 )
+                exit(0);
+            memcpy(ctx->point + 1, loaded, sizeof(Point) * BENCH_LOAD_SIZE);
+            textMs += nowMs() - start;
+
+            start = nowMs();
+            if( openCloud(&cloud, binary) != 0 )
+            {
+                printf("%s is not a point cloud\n", binary);
+                exit(1);
+            }
+            for( i = 0; i < (int)cloud.header->count; i++ )
+            {
+                ctx->point[i + 1].x = cloud.xyz[i * 2];
+                ctx->point[i + 1].y = cloud.xyz[i * 2 + 1];
+            }
+            closeCloud(&cloud);
+            cloudMs += nowMs() - start;
+        }
+        printf("\nloading %d points, mean of %d reads\n", BENCH_LOAD_SIZE, BENCH_REPEAT);
+        printf("%12s %12s %9s\n", "text ms", "cloud ms", "speedup");
+        printf("%12.3f %12.3f %8.1fx\n", textMs / BENCH_REPEAT, cloudMs / BENCH_REPEAT, textMs / cloudMs);
+        remove(text);
+        remove(binary);
+        dbscan_ctx_destroy(ctx);
+        free(xyz);
+        free(loaded);
+        free(point);
+    }
+
+    /*
+     * the stacked frame clustered on x y, then on x y z with a sphere and with the anisotropic metric
+     * */
+    static void benchDimensions()
+    {
+        static const char* metric[] = {"2D", "3D", "3D aniso"};
+        int s, m, r, clusters = 0;
+        double start, ms;
+        printf("\nclustering in 3D, signs %.1f m over half of the objects, neighborhood %.2f, z %.2f, MinPts %d, mean of %d frames\n",
+                BENCH_SIGN_HEIGHT, BENCH_NEIGHBORHOOD, BENCH_NEIGHBORHOOD_Z, BENCH_MINPTS, BENCH_REPEAT);
+        printf("%8s %10s %12s %10s\n", "points", "metric", "frame ms", "clusters");
+        for( s = 0; s < (int)(sizeof(bench_stack_size) / sizeof(bench_stack_size[0])); s++ )
+        {
+            int size = bench_stack_size[s];
+            Point* point = (Point*)malloc(sizeof(Point) * (size + 1));
+            dbscan_ctx* ctx = dbscan_ctx_create(size, BENCH_NEIGHBORHOOD, BENCH_MINPTS);
+            if( !point || !ctx )
+            {
+                printf("bench malloc error!\n");
+                exit(0);
+            }
+            ctx->seedMode = DBSCAN_SEED_ORDERED;
+            makeStackedFrame(point, size);
+            for( m = 0; m < 3; m++ )
+            {
+                dbscan_ctx_set_dimensions(ctx, m == 0 ? 2 : 3, m == 2 ? BENCH_NEIGHBORHOOD_Z : 0);
+                start = nowMs();
+                for( r = 0; r < BENCH_REPEAT; r++ )
+                    clusters = dbscan_ctx_run(ctx, point + 1, size);
+                ms = (nowMs() - start) / BENCH_REPEAT;
+                printf("%8d %10s %12.3f %10d\n", size, metric[m], ms, clusters);
+            }
+
+            dbscan_ctx_destroy(ctx);
+            free(point);
+        }
+    }
+
+    /*
+     * a LUX scan of BENCH_SCAN_OBJECTS cylinders 2 m high standing on the ground, in scan order:
+     * layer after layer, @beams angles each, one beam in 50 hits rain at a random range
+     * the returns are written to point[1..], the return value is their number
+     * */
+    static int makeScan(Point* point, int beams)
+    {
+        double cx[BENCH_SCAN_OBJECTS], cy[BENCH_SCAN_OBJECTS], radius[BENCH_SCAN_OBJECTS];
+        double azimuth, elevation, ux, uy, along, across, t, best;
+        int layer, b, o, size = 0;
+        for( o = 0; o < BENCH_SCAN_OBJECTS; o++ )
+        {
+            cx[o] = uniform(3, 40);
+            cy[o] = uniform(-25, 25);
+            radius[o] = uniform(0.2, 1.0);
+        }
+        for( layer = 0; layer < RANGE_LAYERS; layer++ )
+        {
+            elevation = RANGE_ELEVATION_MIN + (layer + 0.5) * RANGE_LAYER_SPACING;
+            for( b = 0; b < beams; b++ )
+            {
+                azimuth = (-BENCH_SCAN_FOV + 2 * BENCH_SCAN_FOV * b / beams) * M_PI / 180;
+                ux = cos(azimuth);
+                uy = sin(azimuth);
+                best = BENCH_SCAN_RANGE;
+                if( rand() % 50 == 0 )
+                    best = uniform(1, BENCH_SCAN_RANGE);
+                //nearest cylinder hit, by the horizontal distance along the beam
+                for( o = 0; o < BENCH_SCAN_OBJECTS; o++ )
+                {
+                    along = ux * cx[o] + uy * cy[o];
+                    across = cx[o] * cx[o] + cy[o] * cy[o] - along * along;
+                    if( along <= 0 || across > radius[o] * radius[o] )
+                        continue;
+                    t = along - sqrt(radius[o] * radius[o] - across);
+                    if( t < best && fabs(t * tan(elevation)) < 2 - BENCH_SCAN_HEIGHT )
+                        best = t;
+                }
+                if( best >= BENCH_SCAN_RANGE )
+                    continue;
+                size++;
+                point[size].x = best * ux;
+                point[size].y = best * uy;
+                point[size].z = best * tan(elevation);
+            }
+        }
+        return size;
+    }
+
+    /*
+     * a scan of "x y z" lines, at most BENCH_SCAN_POINTS, into point[1..], the return value is their number
+     * */
+    static int readScan(const char* Filename, Point* point)
+    {
+        FILE* fread;
+        int size = 0;
+        if( NULL == (fread = fopen(Filename, "r")))
+        {
+            printf("open file(%s) error!\n", Filename);
+            return 0;
+        }
+        while( size < BENCH_SCAN_POINTS
+                && 3 == fscanf(fread, "%lf %lf %lf", &point[size + 1].x, &point[size + 1].y, &point[size + 1].z) )
+            size++;
+        fclose(fread);
+        return size;
+    }
+
+    /*
+     * adjusted Rand index of two labelings of @size points, a noise point is a cluster of its own
+     *  1 for the same partition, around 0 for unrelated ones
+     * */
+    static double adjustedRand(const int* a, int ka, const int* b, int kb, int size)
+    {
+        long long* table = (long long*)calloc((size_t)(ka + 1) * (kb + 1), sizeof(long long));
+        long long* rowSize = (long long*)calloc(ka + 1, sizeof(long long));
+        long long* columnSize = (long long*)calloc(kb + 1, sizeof(long long));
+        double pairs = 0, rowPairs = 0, columnPairs = 0, all, expected;
+        int i, j;
+        if( !table || !rowSize || !columnSize )
+        {
+            printf("bench malloc error!\n");
+            exit(0);
+        }
+        for( i = 0; i < size; i++ )
+        {
+            table[(size_t)a[i] * (kb + 1) + b[i]]++;
+            rowSize[a[i]]++;
+            columnSize[b[i]]++;
+        }
+        for( i = 1; i <= ka; i++ )
+        {
+            rowPairs += rowSize[i] * (rowSize[i] - 1) / 2.0;
+            for( j = 1; j <= kb; j++ )
+                pairs += table[(size_t)i * (kb + 1) + j] * (table[(size_t)i * (kb + 1) + j] - 1) / 2.0;
+        }
+        for( j = 1; j <= kb; j++ )
+            columnPairs += columnSize[j] * (columnSize[j] - 1) / 2.0;
+        free(table);
+        free(rowSize);
+        free(columnSize);
+        all = size * (size - 1.0) / 2;
+        expected = rowPairs * columnPairs / all;
+        return rowPairs + columnPairs == 2 * expected ? 1 : (pairs - expected) / ((rowPairs + columnPairs) / 2 - expected);
+    }
+
+    /*
+     * one scan clustered by DBSCAN on the grid and by the range image, same context and metric
+     * */
+    static void compareRange(dbscan_ctx* ctx, const char* name, const Point* point, int size)
+    {
+        int* density = (int*)malloc(sizeof(int) * (size + 1));
+        double start, densityMs, rangeMs;
+        int r, i, densityCount = 0, rangeCount = 0, noise = 0;
+        const int* cluster;
+        if( !density )
+        {
+            printf("bench malloc error!\n");
+            exit(0);
+        }
+        ctx->clusterMode = DBSCAN_CLUSTER_DENSITY;
+        start = nowMs();
+        for( r = 0; r < BENCH_REPEAT; r++ )
+            densityCount = dbscan_ctx_run(ctx, point + 1, size);
+        densityMs = (nowMs() - start) / BENCH_REPEAT;
+        memcpy(density, dbscan_ctx_results(ctx, NULL), sizeof(int) * size);
+
+        ctx->clusterMode = DBSCAN_CLUSTER_RANGE;
+        start = nowMs();
+        for( r = 0; r < BENCH_REPEAT; r++ )
+            rangeCount = dbscan_ctx_run(ctx, point + 1, size);
+        rangeMs = (nowMs() - start) / BENCH_REPEAT;
+        cluster = dbscan_ctx_results(ctx, NULL);
+
+        for( i = 0; i < size; i++ )
+            noise += (density[i] == 0) == (cluster[i] == 0);
+        printf("%10s %8d %10.3f %10.3f %8.1fx %8d %8d %8.4f %8.2f%%\n", name, size, densityMs, rangeMs, densityMs / rangeMs,
+                densityCount, rangeCount, adjustedRand(density, densityCount, cluster, rangeCount, size), 100.0 * noise / size);
+        free(density);
+    }
+
+    /*
+     * the range image against DBSCAN on synthetic LUX scans, then on the recorded scan of @recording if any
+     *  adjusted Rand index of the two partitions, and the share of points both call noise or both do not
+     * */
+    static void benchRange(const char* recording)
+    {
+        Point* point = (Point*)malloc(sizeof(Point) * (BENCH_SCAN_POINTS + 1));
+        dbscan_ctx* ctx = dbscan_ctx_create(BENCH_SCAN_POINTS, BENCH_NEIGHBORHOOD, BENCH_MINPTS);
+        char name[32];
+        int s, size;
+        if( !point || !ctx )
+        {
+            printf("bench malloc error!\n");
+            exit(0);
+        }
+        ctx->seedMode = DBSCAN_SEED_ORDERED;
+        dbscan_ctx_set_dimensions(ctx, 3, 0);
+        printf("\nrange image against DBSCAN, neighborhood %.2f, MinPts %d, 3D, mean of %d frames\n",
+                BENCH_NEIGHBORHOOD, BENCH_MINPTS, BENCH_REPEAT);
+        printf("%10s %8s %10s %10s %9s %8s %8s %8s %9s\n", "scan", "points", "dbscan ms", "range ms", "speedup",
+                "dbscan", "range", "ARI", "noise eq");
+        for( s = 0; s < (int)(sizeof(bench_scan_beams) / sizeof(bench_scan_beams[0])); s++ )
+        {
+            size = makeScan(point, bench_scan_beams[s]);
+            snprintf(name, sizeof(name), "lux %d", bench_scan_beams[s]);
+            compareRange(ctx, name, point, size);
+        }
+        if( recording && (size = readScan(recording, point)) > 0 )
+            compareRange(ctx, "recorded", point, size);
+        dbscan_ctx_destroy(ctx);
+        free(point);
+    }
+
+//the recorded scan of "x y z" lines to compare the range image on, e.g. points_socket_writer/bin/test009.txt
+static const char* bench_recording;
+
+    static void benchRecordedRange()
+    {
+        benchRange(bench_recording);
+    }
+
+typedef struct BenchSection
+{
+    const char* name;
+    void (*run)(void);
+}BenchSection;
+
+static const BenchSection bench_section[] = {
+    {"neighbor", benchNeighbor},
+    {"kdtree", benchKdTree},
+    {"queue", benchQueue},
+    {"pipeline", benchPipeline},
+    {"threads", benchThreads},
+    {"union", benchUnion},
+    {"kernel", benchKernel},
+    {"load", benchLoad},
+    {"dimensions", benchDimensions},
+    {"range", benchRecordedRange},
+};
+
+    //index of the section @name, -1 if there is none
+    static int findSection(const char* name)
+    {
+        int b;
+        for( b = 0; b < (int)(sizeof(bench_section) / sizeof(bench_section[0])); b++ )
+        {
+            if( strcmp(name, bench_section[b].name) == 0 )
+                return b;
+        }
+        return -1;
+    }
+
+//every section, or those named on the command line; any other argument is the recorded scan of the range section
+int main(int argc, char* argv[])
+{
+    int b, a, selected, named = 0;
+    for( a = 1; a < argc; a++ )
+    {
+        if( findSection(argv[a]) >= 0 )
+            named++;
+        else
+            bench_recording = argv[a];
+    }
+    for( b = 0; b < (int)(sizeof(bench_section) / sizeof(bench_section[0])); b++ )
+    {
+        for( a = 1, selected = named == 0; a < argc && !selected; a++ )
+            selected = findSection(argv[a]) == b;
+        if( !selected )
+            continue;
+        //every section on the same numbers, whichever ran before
+        srand(1);
+        bench_section[b].run();
+    }
+    return 0;
+}
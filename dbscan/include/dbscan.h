@@ -1,66 +1,117 @@
 #ifndef DBSCAN_H_
 #define DBSCAN_H_
-    
+
 #include<stdio.h>  
 #include<stdlib.h>  
 #include<math.h>  
 #include<time.h>  
 #include<string.h>  
 #include"ps_queue.h"      
-
-//#define INITIALASSIGN_COREOBJECT      100  
-//#define INCREASEMENT_COREOBJECT       100       
-#define INITIALASSIGN_DIRECTLYDENSITYREACHABLE  100  
-#define INCREASEMENT_DIRECTLYDENSITYREACHABLE   10  
+#include"dbscan_grid.h"
+#include"dbscan_range.h"
+#include"dbscan_kdtree.h"
+#include"dbscan_graph.h"
+#include"dbscan_pool.h"
+#include"dbscan_cloud.h"
 
       //collected core_object  
-      
+
+//z is only read by a context set to 3 dimensions, 2D callers may leave it 0
 typedef struct Point  
 {  
 	double x;  
 	double y;  
+	double z;  
 }Point;  
 
 typedef struct CoreObject  
 {  
 	int coreObjectID;  
-	int* directlyDensityReachable;  //store the directly density_reachable point of corePointID  
+	int* directlyDensityReachable;  //[1..reachableSize] the directly density_reachable point of corePointID, points into @graph  
 	int reachableSize;      //the number of directly density reachable  
-	int capacity;           //the current capacity of the dynamic array @directlyDensityReachable  
 }CoreObject;  
 
-static double neighborhood = 0.1;  
-static int MinPts = 5;  
-static char Filename[200] = "../TEST_data/test009.txt";  
-static int data_size = 450;   
-static int size_of_core_object;  
-static Point* point;  
-static CoreObject* coreObject_Collection;  //collectint the core_object  
-static CoreObject* coreObject;         
-
-      
-void Init();  
-void ReadData();  
-double calculateDistance_BetweenTwo(int, int);  
-void calculateDistance_BetweenOneToAll(int);  
-void calculateDistance_BetweenAll();  
-void statisticCoreObject();  
-void showInformation();  
-void setCoreObject();  
-int* preparatory_DBSCAN();  
-void DBSCAN();  
-void refreshOld_unAccessed_Set(int*, int*);  
-int existCoreObject();  
-int getRandomCoreObject();  
-void addToQueue_baseCoreObject(LinkQueue*, int);  
-void updateUnaccessSet(int*, int);  
-void addToQueue_intersectionBased(LinkQueue*, int*, int);  
-void getCluster(int*, int*, int);  
-void updateCoreObject(int*);  
-void saveNoise(int*);  
-
- 
+//one worker's share of a parallel neighbor search: the lists of points begin..end-1,
+//found into its own buffer and copied into @graph once all offsets are known
+typedef struct GraphPart
+{
+	int begin;
+	int end;
+	int* neighbor;          //the lists of the range back to back, kept across frames
+	int capacity;
+	int edges;              //number of ids in @neighbor
+	int* scratch;           //ids of one search while its runs are merged, kept across frames
+	int scratchCapacity;
+	int cores;              //number of core objects in the range
+	int coreStart;          //index in @coreObject of the first core of the range
+	int roots;              //number of union-find roots in the range
+	int rootStart;          //cluster id of the first root of the range
+	int failed;             //the buffers could not grow, the range is not searched
+}GraphPart;
+
+#define DBSCAN_SEED_RANDOM      0   //seed cores in random order, like the original algorithm
+#define DBSCAN_SEED_ORDERED     1   //seed cores in point order, the same clusters every run
+
+#define DBSCAN_LABEL_BFS        0   //expand one cluster after the other from a seed core
+#define DBSCAN_LABEL_UNION      1   //union the core neighbors on all threads, then attach the borders
+
+#define DBSCAN_CLUSTER_DENSITY  0   //DBSCAN on the neighbor graph of the grid
+#define DBSCAN_CLUSTER_RANGE    1   //connected returns of adjacent beams and layers on the range image, O(n)
+
+//all the state of one clustering, allocated once for @capacity points and reused frame after frame
+//two contexts share nothing, so two sensors can be clustered at the same time
+typedef struct dbscan_ctx
+{  
+	double neighborhood;
+	int dimensions;                     //2 clusters on x y, 3 on x y z
+	double neighborhoodZ;               //in 3D the reach along z, 0 for the same as @neighborhood
+	int MinPts;
+	int seedMode;                       //DBSCAN_SEED_RANDOM or DBSCAN_SEED_ORDERED
+	int labelMode;                      //DBSCAN_LABEL_BFS or DBSCAN_LABEL_UNION
+	int clusterMode;                    //DBSCAN_CLUSTER_DENSITY or DBSCAN_CLUSTER_RANGE, may change between frames
+	int capacity;                       //number of points the buffers can hold
+	int data_size;                      //number of points of the current frame
+	int size_of_core_object;
+	int cluster_count;
+	int seedCursor;                     //next entry of @coreObject to try as a seed
+	Point* point;                       //[1..data_size] copy of the frame
+	CoreObject* coreObject_Collection;  //[1..data_size] collecting the core_object
+	CoreObject* coreObject;             //[1..size_of_core_object]
+	int* cluster;                       //[1..data_size] cluster of every point, 0 for noise
+	int* parent;                        //[1..data_size] union-find forest of DBSCAN_LABEL_UNION
+	RingQueue workQueue;                //the directly_density_reachable still to expand
+	GridIndex grid;
+	RangeImage range;                   //DBSCAN_CLUSTER_RANGE only
+	NeighborGraph graph;                //the lists of all points, one contiguous block
+	WorkerPool pool;                    //threads of the neighbor search, size 1 runs it serially
+	GraphPart part[POOL_MAX_THREADS];
+}dbscan_ctx;
+
+dbscan_ctx* dbscan_ctx_create(int, double, int);
+void dbscan_ctx_reset(dbscan_ctx*);
+int dbscan_ctx_run(dbscan_ctx*, const Point*, int);
+int dbscan_ctx_run_cloud(dbscan_ctx*, const float*, int, int);
+const int* dbscan_ctx_results(const dbscan_ctx*, int*);
+void dbscan_ctx_destroy(dbscan_ctx*);
+void dbscan_ctx_set_threads(dbscan_ctx*, int);
+void dbscan_ctx_set_dimensions(dbscan_ctx*, int, double);
+
+int ReadData(const char*, Point*, int);
+int calculateDistance_BetweenAll(dbscan_ctx*);
+int parallel_calculateDistance_BetweenAll(dbscan_ctx*);
+void splitParts(dbscan_ctx*);
+void statisticCoreObject(dbscan_ctx*);
+void showInformation(const dbscan_ctx*);
+void setCoreObject(dbscan_ctx*);
+void preparatory_DBSCAN(dbscan_ctx*);
+void DBSCAN(dbscan_ctx*);
+void unionFind_DBSCAN(dbscan_ctx*);
+int rangeImage_DBSCAN(dbscan_ctx*);
+int getNextCoreObject(dbscan_ctx*);
+void addToQueue_intersectionBased(dbscan_ctx*, int);
+
+
 
 #endif
-      
-  
+
+
@@ -0,0 +1,36 @@
+#ifndef DBSCAN_CLOUD_H_
+#define DBSCAN_CLOUD_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+
+#define CLOUD_MAGIC         0x43504244u     //"DBPC" read as a little-endian word
+#define CLOUD_VERSION       1
+
+//header of a binary point cloud file, little-endian, followed by @count points of @dim packed float32
+//coordinates (x y or x y z), so point i starts at byte sizeof(CloudHeader) + i * dim * 4
+typedef struct CloudHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t dim;           //2 or 3
+	uint32_t count;
+	uint32_t reserved;
+	uint64_t timestamp;     //microseconds, time of the scan
+}CloudHeader;
+
+//a point cloud file mapped read-only, @xyz points into the mapping
+typedef struct PointCloud
+{
+	const CloudHeader* header;
+	const float* xyz;
+	void* map;
+	size_t mapSize;
+}PointCloud;
+
+int openCloud(PointCloud*, const char*);
+void closeCloud(PointCloud*);
+int writeCloud(const char*, const float*, int, int, uint64_t);
+
+#endif
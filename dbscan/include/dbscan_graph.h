@@ -0,0 +1,25 @@
+#ifndef DBSCAN_GRAPH_H_
+#define DBSCAN_GRAPH_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+#include"dbscan_grid.h"
+
+//directly_density_reachable of all points in compressed sparse row form
+//the neighbors of point i are neighbor[offset[i] .. offset[i+1]-1], in ascending order
+//like @point both arrays are 1-based: offset[1] == 1 and neighbor[0] is unused
+typedef struct NeighborGraph
+{
+	int size;               //number of points in the graph
+	int pointCapacity;
+	int edgeCapacity;       //number of ids @neighbor can hold
+	int* offset;
+	int* neighbor;
+	int* scratch;           //ids of one search while its runs are merged, @pointCapacity of them
+}NeighborGraph;
+
+int initialGraph(NeighborGraph*, int);
+int buildGraph(NeighborGraph*, const GridIndex*, const struct Point*, int, double);
+void destroyGraph(NeighborGraph*);
+
+#endif
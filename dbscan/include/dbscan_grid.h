@@ -0,0 +1,43 @@
+#ifndef DBSCAN_GRID_H_
+#define DBSCAN_GRID_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<math.h>
+#include"dbscan_simd.h"
+
+#define GRID_SCAN_CHUNK     64      //candidates given to the kernel at once
+
+struct Point;
+
+//uniform spatial hash grid, cell size equal to the neighborhood
+//points are bucketed by the hash of their cell, a query only visits the 3x3 cell block around the point,
+//or the 3x3x3 block in 3D
+//
+//the 3D metric may be anisotropic: z is scaled by neighborhood / neighborhoodZ before anything else,
+//so a point is a neighbor when dx^2 + dy^2 + (dz * scaleZ)^2 <= neighborhood^2, an ellipsoid of
+//half-height neighborhoodZ, and the cells and the kernel stay the ones of an isotropic metric
+typedef struct GridIndex
+{
+	double cellSize;        //side of one cell, equal to the neighborhood
+	int dimensions;         //2 or 3, of the last buildGrid
+	double scaleZ;          //factor of z in 3D, 1 for an isotropic metric
+	int pointCapacity;      //number of points the arrays below can hold
+	int tableSize;          //number of hash buckets, power of two
+	int* cellX;             //cell coordinate of every point (1-based like @point)
+	int* cellY;
+	int* cellZ;             //0 in 2D
+	int* bucketStart;       //bucket b holds bucketPoints[bucketStart[b] .. bucketStart[b+1]-1]
+	int* bucketPoints;      //point ids sorted by bucket, ascending inside one bucket
+	PointStore sorted;      //coordinates of bucketPoints[k] at k, what the distance kernel reads, z already scaled
+	RadiusKernel kernel;    //chosen at runtime by initialGrid, may be set to a lower level
+	RadiusKernel3 kernel3;  //the same for 3D
+}GridIndex;
+
+int initialGrid(GridIndex*, int);
+void buildGrid(GridIndex*, const struct Point*, int, double, int, double);
+int countGrid(const GridIndex*, const struct Point*, int, double);
+int searchGrid(const GridIndex*, const struct Point*, int, double, int*, int*);
+void destroyGrid(GridIndex*);
+
+#endif
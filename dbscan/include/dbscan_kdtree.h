@@ -0,0 +1,43 @@
+#ifndef DBSCAN_KDTREE_H_
+#define DBSCAN_KDTREE_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<math.h>
+
+#define KD_MAX_DIM      3
+#define KD_LEAF_SIZE    8
+#define KD_STACK_SIZE   128
+
+//kd-tree over 2D or 3D points, built once per frame and shared by any number of queries
+//the coordinates of point i are coord[i * dim .. i * dim + dim - 1], index 0 unused like @point,
+//so a Point array can be passed as (const double*)point with dim 3
+typedef struct KdNode
+{
+	int begin;              //the node holds index[begin .. end-1]
+	int end;
+	int left;               //children, -1 for a leaf
+	int right;
+	int splitDim;
+	double splitValue;
+}KdNode;
+
+typedef struct KdTree
+{
+	int dim;
+	int pointCapacity;
+	int size;
+	const double* coord;    //not owned, must outlive the queries
+	int* index;             //permutation of the point ids, grouped by node
+	KdNode* node;           //node[0] is the root
+	int nodeCount;
+	int nodeCapacity;
+}KdTree;
+
+int initialKdTree(KdTree*, int, int);
+void buildKdTree(KdTree*, const double*, int);
+int searchKdTree(const KdTree*, const double*, double, int, int*);
+int nearestKdTree(const KdTree*, const double*, int, int, int*, double*);
+void destroyKdTree(KdTree*);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef DBSCAN_POOL_H_
+#define DBSCAN_POOL_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<pthread.h>
+
+#define POOL_MAX_THREADS    64
+
+typedef void (*PoolJob)(void*, int);
+
+struct WorkerPool;
+
+typedef struct WorkerSlot
+{
+	struct WorkerPool* pool;
+	int index;              //worker number passed to the job, 1..size-1
+}WorkerSlot;
+
+//threads started once and woken for every job, the caller runs the job as worker 0
+//a job is run by all the workers at once, each one picks its share by its worker number
+typedef struct WorkerPool
+{
+	int size;               //number of workers, the caller included
+	pthread_t thread[POOL_MAX_THREADS];
+	WorkerSlot slot[POOL_MAX_THREADS];
+	pthread_mutex_t lock;
+	pthread_cond_t start;   //a new job was posted
+	pthread_cond_t done;    //the last worker finished
+	unsigned int generation;    //number of jobs posted
+	int pending;            //workers still running the current job
+	int quit;
+	PoolJob job;
+	void* arg;
+}WorkerPool;
+
+void initialPool(WorkerPool*, int);
+void runPool(WorkerPool*, PoolJob, void*);
+void destroyPool(WorkerPool*);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef DBSCAN_RANGE_H_
+#define DBSCAN_RANGE_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<math.h>
+
+//the 4 layers of the ibeo LUX, 0.8 degree apart, and the beams grouped by angle
+#define RANGE_LAYERS            4
+#define RANGE_ELEVATION_MIN     (-1.6 * M_PI / 180)     //bottom edge of layer 0
+#define RANGE_LAYER_SPACING     (0.8 * M_PI / 180)
+#define RANGE_BIN_WIDTH         (0.25 * M_PI / 180)     //twice the finest angle step of the LUX
+#define RANGE_GAP_BINS          2                       //bins always searched on each side
+#define RANGE_GAP_MAX_BINS      16                      //bins searched at most, near the scanner
+
+struct Point;
+
+//range image of a frame: the points bucketed by layer and by azimuth bin over the full turn
+//the layer of a point is found from its elevation, so any frame of x y z works, in scan order or not
+//a point is only compared with the points of its own cell, of the next bins of its layer and of the bins
+//around it in the layer above; as many bins as the neighborhood spans at its range, at least gapBins and
+//at most maxGapBins, so missing returns are bridged like DBSCAN would and a scan is still O(n)
+//a cell keeps the widest window of its points, and two cells are compared when the window of either
+//spans them, so a near and a far point are paired whichever of the two the scan starts from
+typedef struct RangeImage
+{
+	int layers;
+	int bins;               //over the full turn, from -pi
+	double elevationMin;
+	double layerSpacing;
+	double binWidth;
+	int gapBins;
+	int maxGapBins;
+	int pointCapacity;
+	int cellCapacity;       //number of cells @cellStart and @cellGap can hold
+	int* cell;              //[1..size] cell of every point, layer * bins + bin
+	int* cellStart;         //cell c holds cellPoints[cellStart[c] .. cellStart[c+1]-1]
+	int* cellGap;           //bins the nearest point of a cell searches on each side, 0 for an empty cell
+	int* cellPoints;        //point ids sorted by cell, ascending inside one cell
+}RangeImage;
+
+int initialRangeImage(RangeImage*, int);
+int buildRangeImage(RangeImage*, const struct Point*, int, double);
+void destroyRangeImage(RangeImage*);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef DBSCAN_SIMD_H_
+#define DBSCAN_SIMD_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+
+#define SIMD_SCALAR     0
+#define SIMD_SSE2       1   //2 candidates per instruction
+#define SIMD_AVX2       2   //4 candidates per instruction
+
+//structure-of-arrays copy of the points, the candidates of a query are read with unit stride
+//@z is NULL for a 2D frame
+typedef struct PointStore
+{
+	int size;
+	int capacity;
+	double* x;
+	double* y;
+	double* z;
+}PointStore;
+
+//test the query against candidates 0..count-1 by squared distance <= @eps2,
+//the positions of the candidates inside are written to @hit in ascending order, the return value is their number
+typedef int (*RadiusKernel)(const double*, const double*, int, double, double, double, int*);
+typedef int (*RadiusKernel3)(const double*, const double*, const double*, int, double, double, double, double, int*);
+
+int initialPointStore(PointStore*, int, int);
+void destroyPointStore(PointStore*);
+int detectSimd();
+RadiusKernel selectRadiusKernel(int);
+RadiusKernel3 selectRadiusKernel3(int);
+
+#endif
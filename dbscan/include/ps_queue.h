@@ -1,3 +1,4 @@
+
 #ifndef PS_QUEUE_H_
 #define PS_QUEUE_H_
 
@@ -6,24 +7,23 @@
 #include<math.h>
 
 //sequence queue  
-typedef struct QueueNode  
-{  
-	int data;  
-	struct QueueNode* next;  
-}QueueNode, *QueueNodePtr;  
-
-typedef struct LinkQueue  
+//ring buffer of point ids, sized once per frame so inserting and deleting never allocate
+typedef struct RingQueue  
 {  
-	QueueNodePtr front;  
-	QueueNodePtr rear;  
-}LinkQueue;  
+	int* data;  
+	int capacity;       //power of two  
+	int front;          //index of the next id to delete  
+	int size;           //number of ids in the queue  
+}RingQueue;  
       
-void initialQueue(LinkQueue*);  
-void insertQueue(LinkQueue*, int);  
-void deleteQueue(LinkQueue*, int*);  
-void printQueue(LinkQueue);  
+int initialQueue(RingQueue*, int);  
+int reserveQueue(RingQueue*, int);  
+int insertQueue(RingQueue*, int);  
+void deleteQueue(RingQueue*, int*);  
+void printQueue(const RingQueue*);  
 void testQueue();  
-int isEmptyQueue(LinkQueue);  
+int isEmptyQueue(const RingQueue*);  
+void destroyQueue(RingQueue*);
       
     //sequence queue END  
 
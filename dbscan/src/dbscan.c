@@ -1,32 +1,180 @@
+
+#include<unistd.h>
 #include"dbscan.h"
 
+#define DBSCAN_FIXED_SEED   1   //seed of rand in the deterministic mode, -d
+
+static double neighborhood = 0.1;
+static int MinPts = 5;
+static int seedMode = DBSCAN_SEED_RANDOM;
+static int labelMode = DBSCAN_LABEL_BFS;
+static int threads = 1;
+static int dimensions = 2;
+static double neighborhoodZ = 0;
+
+    /*
+     * write every cluster to ../DBSCAN_cluster/cluster_<id>.txt
+     * */
+    void saveCluster(const Point* point, const int* cluster, int data_size, int cluster_count)
+    {  
+        char filename[200];
+        FILE* fwrite;
+        int clusterID;
+        int i;
+        for( clusterID = 1; clusterID <= cluster_count; clusterID++ )
+        {  
+            sprintf(filename, "../DBSCAN_cluster/cluster_%d.txt", clusterID);
+            if( NULL == (fwrite = fopen(filename, "w")))
+            {
+                printf("open file(%s) error\n", filename);
+                exit(0);
+            }
+            for( i = 0; i < data_size; i++ )
+            {
+                if( cluster[i] == clusterID )
+                {
+                    fprintf(fwrite, "%f\t%f\n", point[i].x, point[i].y);
+                }
+            }
+            fclose(fwrite);
+        }    
+    }  
+
+    void saveNoise(const Point* point, const int* cluster, int data_size)
+    {  
+        FILE* fwriteNoise;
+        if( NULL == (fwriteNoise = fopen("../DBSCAN_cluster/noise.txt", "w")))
+        {  
+            printf("open file(nosie.data) error!\n");
+            exit(0);  
+        }    
+        int i;
+        printf("\nshow the noise data:\n");
+        for( i = 0; i < data_size; i++ )
+        {  
+            if( cluster[i] == 0 )
+            {
+                fprintf(fwriteNoise, "%f\t%f\n", point[i].x, point[i].y);
+                printf("%f\t%f\n", point[i].x, point[i].y);
+            }
+        }    
+        fclose(fwriteNoise);
+    }  
+
+    /*
+     * a context for @data_size points with the options of the command line
+     * */
+    static dbscan_ctx* createCtx(int data_size)
+    {
+        dbscan_ctx* ctx = dbscan_ctx_create(data_size, neighborhood, MinPts);
+        if( !ctx )
+        {
+            printf("dbscan_ctx malloc error: %d\n", data_size);
+            exit(0);
+        }
+        ctx->seedMode = seedMode;
+        ctx->labelMode = labelMode;
+        dbscan_ctx_set_threads(ctx, threads);
+        dbscan_ctx_set_dimensions(ctx, dimensions, neighborhoodZ);
+        return ctx;
+    }
+
+    static void usage(const char* name)
+    {
+        printf("usage: %s [-d] [-s seed] [-t threads] [-u] [-3] [-z reach] <file> [data_size [neighborhood [MinPts]]]"  
+                "\n\t\tfile is a point cloud written by dbscan_convert, or a text file of \"x\\ty\" lines"  
+                "\n\t\tdata_size is needed for a text file, a point cloud is read whole by default"  
+                "\n\t\tneighborhood and MinPts default to %g and %d"  
+                "\n\t-d\tdeterministic, cores seeded in point order and the seed fixed to %d"  
+                "\n\t-s\tseed of rand, the time by default"  
+                "\n\t-t\tthreads of the neighbor search, 1 by default"  
+                "\n\t-u\tunion-find labels instead of expanding one cluster after the other"  
+                "\n\t-3\tcluster on x y z, z is 0 in a text file"  
+                "\n\t-z\treach along z in 3D, the neighborhood by default, implies -3\n",  
+                name, neighborhood, MinPts, DBSCAN_FIXED_SEED);  
+    }
+
 int main(int argc, char* argv[])  
     {  
-        /*
-		if( argc != 5 )  
+        unsigned seed = (unsigned)time(NULL);
+        int option;
+
+        while( (option = getopt(argc, argv, "ds:t:u3z:h")) != -1 )
+        {
+            switch( option )
+            {
+                case 'd': seedMode = DBSCAN_SEED_ORDERED; seed = DBSCAN_FIXED_SEED; break;
+                case 's': seed = (unsigned)strtoul(optarg, NULL, 10); break;
+                case 't': threads = atoi(optarg); break;
+                case 'u': labelMode = DBSCAN_LABEL_UNION; break;
+                case '3': dimensions = 3; break;
+                case 'z': dimensions = 3; neighborhoodZ = atof(optarg); break;
+                default: usage(argv[0]); exit(0);
+            }
+        }
+        if( argc - optind < 1 || argc - optind > 4 )
         {  
-            printf("this program need 5 parematers to run,"  
-                    "\n\t\tthe first to indicate the neighborhood"  
-                    "\n\t\tthe second to indicate the MinPts"  
-                    "\n\t\tthe third to indicate the filename contain data"  
-                    "\n\t\tthe fourth to indicate the data size\n");  
+            usage(argv[0]);
             exit(0);  
         }    
-        neighborhood = atof(argv[1]);  
-        MinPts = atoi(argv[2]);  
-        strcat(filename, argv[3]);  
-        data_size = atoi(argv[4]); 
-		*/
- 
-		srand((unsigned)time(NULL));
-
-        Init();  
-        ReadData();  
-        calculateDistance_BetweenAll();  
-        statisticCoreObject();  
-        //showInformation();  
-        setCoreObject();  
-        //testQueue();  
-        DBSCAN();  
+        const char* Filename = argv[optind];
+        int data_size = argc - optind > 1 ? atoi(argv[optind + 1]) : 0;
+        if( argc - optind > 2 )
+            neighborhood = atof(argv[optind + 2]);  
+        if( argc - optind > 3 )
+            MinPts = atoi(argv[optind + 3]);  
+
+		srand(seed);
+
+        PointCloud cloud;
+        Point* point;
+        dbscan_ctx* ctx;
+        const int* cluster;
+        int cluster_count;
+
+        if( openCloud(&cloud, Filename) == 0 )
+        {
+            //clustered straight from the mapping
+            if( data_size <= 0 || data_size > (int)cloud.header->count )
+                data_size = (int)cloud.header->count;
+            ctx = createCtx(data_size);
+            if( dbscan_ctx_run_cloud(ctx, cloud.xyz, cloud.header->dim, data_size) < 0 )
+            {
+                printf("dbscan_ctx malloc error: %d\n", data_size);
+                exit(0);
+            }
+            closeCloud(&cloud);
+        }
+        else
+        {
+            if( data_size <= 0 )
+            {
+                printf("%s is not a point cloud, give the number of points to read\n", Filename);
+                exit(0);
+            }
+            point = (Point*)malloc(sizeof(struct Point) * data_size);
+            if( !point )
+            {  
+                printf("point malloc error\n");
+                exit(0);  
+            }    
+            if( ReadData(Filename, point, data_size) != 0 )
+                exit(0);  
+            ctx = createCtx(data_size);
+            if( dbscan_ctx_run(ctx, point, data_size) < 0 )
+            {
+                printf("dbscan_ctx malloc error: %d\n", data_size);
+                exit(0);
+            }
+            free(point);
+        }
+        //showInformation(ctx);
+        cluster = dbscan_ctx_results(ctx, &cluster_count);
+        printf("\ncluster_count is %d\n", cluster_count);
+        //the context keeps its own copy of the frame
+        saveCluster(ctx->point + 1, cluster, data_size, cluster_count);
+        saveNoise(ctx->point + 1, cluster, data_size);
+
+        dbscan_ctx_destroy(ctx);
         return 0;  
     }  
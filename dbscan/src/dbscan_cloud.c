@@ -0,0 +1,92 @@
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include"dbscan_cloud.h"
+
+    /*
+     * map the point cloud file @Filename, the points are read in place from the mapping
+     *  return 0 on success, -1 if the file can not be mapped or is not a point cloud
+     * */
+    int openCloud(PointCloud* cloud, const char* Filename)
+    {
+        struct stat st;
+        int fd;
+        const CloudHeader* header;
+
+        cloud->header = NULL;
+        cloud->xyz = NULL;
+        cloud->map = NULL;
+        cloud->mapSize = 0;
+        if( (fd = open(Filename, O_RDONLY)) < 0 )
+        {
+            printf("open file(%s) error!\n", Filename);
+            return -1;
+        }
+        if( fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(CloudHeader) )
+        {
+            close(fd);
+            return -1;
+        }
+        cloud->map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if( cloud->map == MAP_FAILED )
+        {
+            printf("mmap file(%s) error!\n", Filename);
+            cloud->map = NULL;
+            return -1;
+        }
+        cloud->mapSize = (size_t)st.st_size;
+        header = (const CloudHeader*)cloud->map;
+        if( header->magic != CLOUD_MAGIC || header->version != CLOUD_VERSION || (header->dim != 2 && header->dim != 3)
+                || cloud->mapSize < sizeof(CloudHeader) + (size_t)header->count * header->dim * sizeof(float) )
+        {
+            closeCloud(cloud);
+            return -1;
+        }
+        madvise(cloud->map, cloud->mapSize, MADV_SEQUENTIAL);
+        cloud->header = header;
+        cloud->xyz = (const float*)(header + 1);
+        return 0;
+    }
+
+    void closeCloud(PointCloud* cloud)
+    {
+        if( cloud->map )
+            munmap(cloud->map, cloud->mapSize);
+        cloud->header = NULL;
+        cloud->xyz = NULL;
+        cloud->map = NULL;
+        cloud->mapSize = 0;
+    }
+
+    /*
+     * write @count points of @dim float coordinates to the point cloud file @Filename
+     *  return 0 on success, -1 on error
+     * */
+    int writeCloud(const char* Filename, const float* xyz, int dim, int count, uint64_t timestamp)
+    {
+        FILE* fwrite_cloud;
+        CloudHeader header;
+
+        header.magic = CLOUD_MAGIC;
+        header.version = CLOUD_VERSION;
+        header.dim = (uint16_t)dim;
+        header.count = (uint32_t)count;
+        header.reserved = 0;
+        header.timestamp = timestamp;
+        if( NULL == (fwrite_cloud = fopen(Filename, "wb")))
+        {
+            printf("open file(%s) error!\n", Filename);
+            return -1;
+        }
+        if( fwrite(&header, sizeof(header), 1, fwrite_cloud) != 1
+                || fwrite(xyz, sizeof(float) * dim, (size_t)count, fwrite_cloud) != (size_t)count )
+        {
+            printf("write file(%s) error!\n", Filename);
+            fclose(fwrite_cloud);
+            return -1;
+        }
+        fclose(fwrite_cloud);
+        return 0;
+    }
@@ -0,0 +1,206 @@
+#include"dbscan.h"
+
+    /*
+     * allocate every buffer of @ctx for @capacity points
+     *  return 0, or -1 if the memory is not there, releaseCtx frees what was allocated
+     * */
+    static int allocateCtx(dbscan_ctx* ctx, int capacity)
+    {
+        ctx->capacity = capacity;
+        ctx->point = (Point*)malloc(sizeof(struct Point) * (capacity + 1));
+        ctx->coreObject_Collection = (CoreObject*)malloc(sizeof(struct CoreObject) * (capacity + 1));
+        ctx->coreObject = (CoreObject*)malloc(sizeof(struct CoreObject) * (capacity + 1));
+        ctx->cluster = (int*)malloc(sizeof(int) * (capacity + 1));
+        ctx->parent = (int*)malloc(sizeof(int) * (capacity + 1));
+        if( !ctx->point || !ctx->coreObject_Collection || !ctx->coreObject || !ctx->cluster || !ctx->parent )
+            return -1;
+        if( initialGrid(&ctx->grid, capacity) != 0 || initialGraph(&ctx->graph, capacity) != 0
+                || initialRangeImage(&ctx->range, capacity) != 0 )
+            return -1;
+        return 0;
+    }
+
+    static void releaseCtx(dbscan_ctx* ctx)
+    {
+        free(ctx->point);
+        free(ctx->coreObject_Collection);
+        free(ctx->coreObject);
+        free(ctx->cluster);
+        free(ctx->parent);
+        ctx->point = NULL;
+        ctx->coreObject_Collection = NULL;
+        ctx->coreObject = NULL;
+        ctx->cluster = NULL;
+        ctx->parent = NULL;
+        ctx->capacity = 0;
+        destroyGrid(&ctx->grid);
+        destroyGraph(&ctx->graph);
+        destroyRangeImage(&ctx->range);
+    }
+
+    /*
+     * create a context for frames of up to @capacity points
+     *  a larger frame is still accepted by dbscan_ctx_run, the buffers then grow once
+     *  return NULL if the memory is not there
+     * */
+    dbscan_ctx* dbscan_ctx_create(int capacity, double neighborhood, int MinPts)
+    {
+        //zeroed so dbscan_ctx_destroy can free whatever was allocated before a failure
+        dbscan_ctx* ctx = (dbscan_ctx*)calloc(1, sizeof(struct dbscan_ctx));
+        if( !ctx )
+            return NULL;
+        ctx->neighborhood = neighborhood;
+        ctx->dimensions = 2;
+        ctx->neighborhoodZ = 0;
+        ctx->MinPts = MinPts;
+        ctx->seedMode = DBSCAN_SEED_RANDOM;
+        ctx->labelMode = DBSCAN_LABEL_BFS;
+        ctx->clusterMode = DBSCAN_CLUSTER_DENSITY;
+        initialPool(&ctx->pool, 1);
+        if( allocateCtx(ctx, capacity) != 0 || initialQueue(&ctx->workQueue, capacity + 1) != 0 )
+        {
+            dbscan_ctx_destroy(ctx);
+            return NULL;
+        }
+        dbscan_ctx_reset(ctx);
+        return ctx;
+    }
+
+    /*
+     * forget the last frame, the buffers are kept
+     * */
+    void dbscan_ctx_reset(dbscan_ctx* ctx)
+    {
+        ctx->data_size = 0;
+        ctx->size_of_core_object = 0;
+        ctx->cluster_count = 0;
+        ctx->seedCursor = 1;
+    }
+
+    /*
+     * make room for a frame of @data_size points
+     *  return 0, or -1 if the memory is not there, the context then holds no buffers until a frame fits
+     * */
+    static int prepareRun(dbscan_ctx* ctx, int data_size)
+    {
+        dbscan_ctx_reset(ctx);
+        if( data_size > ctx->capacity || !ctx->point )
+        {
+            releaseCtx(ctx);
+            if( allocateCtx(ctx, data_size) != 0 )
+            {
+                releaseCtx(ctx);
+                return -1;
+            }
+        }
+        ctx->data_size = data_size;
+        //every point enters the work queue at most once per cluster
+        return reserveQueue(&ctx->workQueue, data_size + 1);
+    }
+
+    static int clusterRun(dbscan_ctx* ctx)
+    {
+        if( ctx->clusterMode == DBSCAN_CLUSTER_RANGE )
+        {
+            if( rangeImage_DBSCAN(ctx) != 0 )
+                return -1;
+            return ctx->cluster_count;
+        }
+        if( ctx->pool.size > 1 )
+        {
+            if( parallel_calculateDistance_BetweenAll(ctx) != 0 )
+                return -1;
+        }
+        else
+        {
+            if( calculateDistance_BetweenAll(ctx) != 0 )
+                return -1;
+            statisticCoreObject(ctx);
+            setCoreObject(ctx);
+        }
+        if( ctx->labelMode == DBSCAN_LABEL_UNION )
+            unionFind_DBSCAN(ctx);
+        else
+            DBSCAN(ctx);
+        return ctx->cluster_count;
+    }
+
+    /*
+     * cluster @point[0..data_size-1]
+     *  return the number of clusters, the cluster of every point is given by dbscan_ctx_results,
+     *  or -1 if the memory is not there, the frame then has no results
+     * */
+    int dbscan_ctx_run(dbscan_ctx* ctx, const Point* point, int data_size)
+    {
+        if( prepareRun(ctx, data_size) != 0 )
+            return -1;
+        memcpy(ctx->point + 1, point, sizeof(struct Point) * data_size);
+        return clusterRun(ctx);
+    }
+
+    /*
+     * cluster @data_size points of @dim packed float coordinates, like a mapped PointCloud
+     *  the points are converted straight into the context, z is 0 for a 2D cloud
+     *  return like dbscan_ctx_run
+     * */
+    int dbscan_ctx_run_cloud(dbscan_ctx* ctx, const float* xyz, int dim, int data_size)
+    {
+        int i;
+        if( prepareRun(ctx, data_size) != 0 )
+            return -1;
+        for( i = 0; i < data_size; i++ )
+        {
+            ctx->point[i + 1].x = xyz[i * dim];
+            ctx->point[i + 1].y = xyz[i * dim + 1];
+            ctx->point[i + 1].z = dim == 3 ? xyz[i * dim + 2] : 0;
+        }
+        return clusterRun(ctx);
+    }
+
+    /*
+     * results of the last dbscan_ctx_run
+     *  the return value is indexed like the points given to it, 0 for noise, 1..@cluster_count for clusters
+     * */
+    const int* dbscan_ctx_results(const dbscan_ctx* ctx, int* cluster_count)
+    {
+        if( cluster_count )
+            *cluster_count = ctx->cluster_count;
+        return ctx->cluster + 1;
+    }
+
+    /*
+     * search the neighbors of a frame on @threads threads, 1 to go back to the serial search
+     *  the threads are started here and wait for the frames
+     * */
+    void dbscan_ctx_set_threads(dbscan_ctx* ctx, int threads)
+    {
+        destroyPool(&ctx->pool);
+        initialPool(&ctx->pool, threads);
+    }
+
+    /*
+     * cluster on @dimensions coordinates, 2 or 3, from the next frame on
+     *  in 3D two points are neighbors when dx^2 + dy^2 + (dz * neighborhood / @neighborhoodZ)^2 <= neighborhood^2,
+     *  so @neighborhoodZ is the reach along z alone, 0 or less for a sphere of the neighborhood
+     * */
+    void dbscan_ctx_set_dimensions(dbscan_ctx* ctx, int dimensions, double neighborhoodZ)
+    {
+        ctx->dimensions = dimensions == 3 ? 3 : 2;
+        ctx->neighborhoodZ = neighborhoodZ > 0 ? neighborhoodZ : 0;
+    }
+
+    void dbscan_ctx_destroy(dbscan_ctx* ctx)
+    {
+        int worker;
+        if( !ctx )
+            return;
+        destroyPool(&ctx->pool);
+        for( worker = 0; worker < POOL_MAX_THREADS; worker++ )
+        {
+            free(ctx->part[worker].neighbor);
+            free(ctx->part[worker].scratch);
+        }
+        releaseCtx(ctx);
+        destroyQueue(&ctx->workQueue);
+        free(ctx);
+    }
@@ -0,0 +1,68 @@
+#include"dbscan.h"
+#include"dbscan_graph.h"
+
+    /*
+     * allocate the offsets for @capacity points, the neighbor array grows on demand in buildGraph
+     *  return 0, or -1 if the memory is not there
+     * */
+    int initialGraph(NeighborGraph* graph, int capacity)
+    {
+        graph->size = 0;
+        graph->pointCapacity = capacity;
+        graph->edgeCapacity = 0;
+        graph->neighbor = NULL;
+        graph->offset = (int*)malloc(sizeof(int) * (capacity + 2));
+        graph->scratch = (int*)malloc(sizeof(int) * (capacity + 1));
+        if( !graph->offset || !graph->scratch )
+        {
+            destroyGraph(graph);
+            return -1;
+        }
+        return 0;
+    }
+
+    /*
+     * build the graph of point[1..data_size] from a grid built with the same @neighborhood
+     *  first pass counts the neighbors of every point and sets the offsets,
+     *  second pass lets the grid write every list straight into its slot
+     *  return 0, or -1 if the memory for the lists is not there
+     * */
+    int buildGraph(NeighborGraph* graph, const GridIndex* grid, const Point* point, int data_size, double neighborhood)
+    {
+        int i;
+        int edges;
+        graph->size = data_size;
+        graph->offset[1] = 1;
+        for( i = 1; i <= data_size; i++ )
+            graph->offset[i + 1] = graph->offset[i] + countGrid(grid, point, i, neighborhood);
+
+        edges = graph->offset[data_size + 1] - 1;
+        if( edges > graph->edgeCapacity )
+        {
+            free(graph->neighbor);
+            graph->neighbor = (int*)malloc(sizeof(int) * (edges + 1));
+            if( !graph->neighbor )
+            {
+                graph->edgeCapacity = 0;
+                return -1;
+            }
+            graph->edgeCapacity = edges;
+        }
+
+        for( i = 1; i <= data_size; i++ )
+            searchGrid(grid, point, i, neighborhood, graph->neighbor + graph->offset[i], graph->scratch);
+        return 0;
+    }
+
+    void destroyGraph(NeighborGraph* graph)
+    {
+        free(graph->offset);
+        free(graph->neighbor);
+        free(graph->scratch);
+        graph->offset = NULL;
+        graph->neighbor = NULL;
+        graph->scratch = NULL;
+        graph->size = 0;
+        graph->pointCapacity = 0;
+        graph->edgeCapacity = 0;
+    }
@@ -0,0 +1,229 @@
+#include"dbscan.h"
+#include"dbscan_grid.h"
+
+    /*
+     * hash of the cell (x, y, z), @mask is tableSize - 1
+     *  z is 0 in 2D, which leaves the hash of (x, y) as it was
+     * */
+    static int hashCell(int x, int y, int z, int mask)
+    {
+        unsigned int h = (unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u ^ (unsigned int)z * 83492791u;
+        return (int)(h & (unsigned int)mask);
+    }
+
+    /*
+     * sort the ids found by a query, so the lists come out in the same order as the full scan
+     * every bucket is in ascending order, so the ids are @runs ascending runs, run r is ids[run[r]..run[r+1]-1];
+     * they are merged two by two through @scratch, about 5 copies of the list for the 27 runs of 3D
+     * where a sort of the whole list goes quadratic on the long lists of a dense scan
+     * */
+    static void mergeRuns(int* ids, int* scratch, int* run, int runs)
+    {
+        int* from = ids;
+        int* to = scratch;
+        int* swap;
+        int r, i, j, k, mid, end, merged;
+        while( runs > 1 )
+        {
+            merged = 0;
+            for( r = 0; r < runs; r += 2 )
+            {
+                i = k = run[r];
+                mid = j = run[r + 1];
+                end = r + 1 < runs ? run[r + 2] : mid;
+                while( i < mid && j < end )
+                    to[k++] = from[i] < from[j] ? from[i++] : from[j++];
+                while( i < mid )
+                    to[k++] = from[i++];
+                while( j < end )
+                    to[k++] = from[j++];
+                //run[r] is read before run[merged] is written, merged <= r
+                run[merged++] = run[r];
+            }
+            run[merged] = run[runs];
+            runs = merged;
+            swap = from;
+            from = to;
+            to = swap;
+        }
+        if( from != ids )
+            memcpy(ids, from, sizeof(int) * run[1]);
+    }
+
+    /*
+     * test @pointID against the candidates bucketPoints[begin..end-1] of cell (@x, @y, @z), @kernel by chunks
+     * the ids inside the neighborhood are written to @result if it is not NULL, the return value is their number
+     * */
+    static int scanBucket(const GridIndex* grid, const Point* point, int pointID, int x, int y, int z, int begin, int end, double eps2, int* result)
+    {
+        int hit[GRID_SCAN_CHUNK];
+        int k, h, count, i, chunk;
+        int size = 0;
+        for( k = begin; k < end; k += GRID_SCAN_CHUNK )
+        {
+            chunk = end - k < GRID_SCAN_CHUNK ? end - k : GRID_SCAN_CHUNK;
+            if( grid->dimensions == 3 )
+                count = grid->kernel3(grid->sorted.x + k, grid->sorted.y + k, grid->sorted.z + k, chunk,
+                        point[pointID].x, point[pointID].y, point[pointID].z * grid->scaleZ, eps2, hit);
+            else
+                count = grid->kernel(grid->sorted.x + k, grid->sorted.y + k, chunk, point[pointID].x, point[pointID].y, eps2, hit);
+            for( h = 0; h < count; h++ )
+            {
+                i = grid->bucketPoints[k + hit[h]];
+                //different cells may share a bucket, only keep the cell asked for
+                if( i == pointID || grid->cellX[i] != x || grid->cellY[i] != y || grid->cellZ[i] != z )
+                    continue;
+                if( result )
+                    result[size] = i;
+                size++;
+            }
+        }
+        return size;
+    }
+
+    /*
+     * allocate a grid able to hold @capacity points
+     *  return 0, or -1 if the memory is not there
+     * */
+    int initialGrid(GridIndex* grid, int capacity)
+    {
+        grid->pointCapacity = capacity;
+        grid->tableSize = 1;
+        while( grid->tableSize < 2 * capacity )
+            grid->tableSize <<= 1;
+        grid->cellSize = 0;
+        grid->dimensions = 2;
+        grid->scaleZ = 1;
+        grid->cellX = (int*)malloc(sizeof(int) * (capacity + 1));
+        grid->cellY = (int*)malloc(sizeof(int) * (capacity + 1));
+        grid->cellZ = (int*)malloc(sizeof(int) * (capacity + 1));
+        grid->bucketStart = (int*)malloc(sizeof(int) * (grid->tableSize + 1));
+        grid->bucketPoints = (int*)malloc(sizeof(int) * (capacity + 1));
+        //z is always there, a context may switch to 3D between two frames
+        if( initialPointStore(&grid->sorted, capacity, 3) != 0 || !grid->cellX || !grid->cellY || !grid->cellZ
+                || !grid->bucketStart || !grid->bucketPoints )
+        {
+            destroyGrid(grid);
+            return -1;
+        }
+        //a bucket only holds a few points, two lanes lose less on the tail than four
+        grid->kernel = selectRadiusKernel(SIMD_SSE2);
+        grid->kernel3 = selectRadiusKernel3(SIMD_SSE2);
+        return 0;
+    }
+
+    /*
+     * bucket point[1..data_size] by cell, counting sort on the hash of the cell
+     * points are inserted in ascending order so every bucket stays sorted
+     *  @dimensions is 2 or 3, in 3D z is searched within @neighborhoodZ, 0 for the same as @cellSize
+     * */
+    void buildGrid(GridIndex* grid, const Point* point, int data_size, double cellSize, int dimensions, double neighborhoodZ)
+    {
+        int i, bucket;
+        int mask = grid->tableSize - 1;
+        grid->cellSize = cellSize;
+        grid->dimensions = dimensions == 3 ? 3 : 2;
+        grid->scaleZ = grid->dimensions == 3 && neighborhoodZ > 0 ? cellSize / neighborhoodZ : 1;
+        memset(grid->bucketStart, 0, sizeof(int) * (grid->tableSize + 1));
+        for( i = 1; i <= data_size; i++ )
+        {
+            grid->cellX[i] = (int)floor(point[i].x / cellSize);
+            grid->cellY[i] = (int)floor(point[i].y / cellSize);
+            grid->cellZ[i] = grid->dimensions == 3 ? (int)floor(point[i].z * grid->scaleZ / cellSize) : 0;
+            grid->bucketStart[hashCell(grid->cellX[i], grid->cellY[i], grid->cellZ[i], mask) + 1]++;
+        }
+        for( bucket = 0; bucket < grid->tableSize; bucket++ )
+            grid->bucketStart[bucket + 1] += grid->bucketStart[bucket];
+        //bucketStart[b] is used as the fill cursor of bucket b, shifted back afterwards
+        for( i = 1; i <= data_size; i++ )
+        {
+            bucket = hashCell(grid->cellX[i], grid->cellY[i], grid->cellZ[i], mask);
+            grid->sorted.x[grid->bucketStart[bucket]] = point[i].x;
+            grid->sorted.y[grid->bucketStart[bucket]] = point[i].y;
+            if( grid->dimensions == 3 )
+                grid->sorted.z[grid->bucketStart[bucket]] = point[i].z * grid->scaleZ;
+            grid->bucketPoints[grid->bucketStart[bucket]++] = i;
+        }
+        grid->sorted.size = data_size;
+        for( bucket = grid->tableSize; bucket > 0; bucket-- )
+            grid->bucketStart[bucket] = grid->bucketStart[bucket - 1];
+        grid->bucketStart[0] = 0;
+    }
+
+    /*
+     * number of directly_density_reachable of @pointID, same test as searchGrid without storing the ids
+     * */
+    int countGrid(const GridIndex* grid, const Point* point, int pointID, double neighborhood)
+    {
+        int dx, dy, dz;
+        int x, y, z, bucket;
+        int size = 0;
+        int mask = grid->tableSize - 1;
+        int layers = grid->dimensions == 3 ? 1 : 0;
+        for( dx = -1; dx <= 1; dx++ )
+        {
+            for( dy = -1; dy <= 1; dy++ )
+            {
+                for( dz = -layers; dz <= layers; dz++ )
+                {
+                    x = grid->cellX[pointID] + dx;
+                    y = grid->cellY[pointID] + dy;
+                    z = grid->cellZ[pointID] + dz;
+                    bucket = hashCell(x, y, z, mask);
+                    size += scanBucket(grid, point, pointID, x, y, z, grid->bucketStart[bucket], grid->bucketStart[bucket + 1],
+                            neighborhood * neighborhood, NULL);
+                }
+            }
+        }
+        return size;
+    }
+
+    /*
+     * seek the directly_density_reachable of @pointID in the 3x3 cell block around it, 3x3x3 in 3D
+     *  a candidate is inside when its squared distance, z scaled, is at most neighborhood * neighborhood
+     * the ids are written to @result in ascending order, the return value is their number
+     *  @scratch holds as many ids as @result, one per thread since the grid is shared
+     * */
+    int searchGrid(const GridIndex* grid, const Point* point, int pointID, double neighborhood, int* result, int* scratch)
+    {
+        int dx, dy, dz;
+        int x, y, z, bucket, found;
+        int run[28];
+        int runs = 0;
+        int size = 0;
+        int mask = grid->tableSize - 1;
+        int layers = grid->dimensions == 3 ? 1 : 0;
+        for( dx = -1; dx <= 1; dx++ )
+        {
+            for( dy = -1; dy <= 1; dy++ )
+            {
+                for( dz = -layers; dz <= layers; dz++ )
+                {
+                    x = grid->cellX[pointID] + dx;
+                    y = grid->cellY[pointID] + dy;
+                    z = grid->cellZ[pointID] + dz;
+                    bucket = hashCell(x, y, z, mask);
+                    found = scanBucket(grid, point, pointID, x, y, z, grid->bucketStart[bucket], grid->bucketStart[bucket + 1],
+                            neighborhood * neighborhood, result + size);
+                    if( found > 0 )
+                        run[runs++] = size;
+                    size += found;
+                }
+            }
+        }
+        run[runs] = size;
+        mergeRuns(result, scratch, run, runs);
+        return size;
+    }
+
+    void destroyGrid(GridIndex* grid)
+    {
+        free(grid->cellX);
+        free(grid->cellY);
+        free(grid->cellZ);
+        free(grid->bucketStart);
+        free(grid->bucketPoints);
+        destroyPointStore(&grid->sorted);
+        grid->cellX = grid->cellY = grid->cellZ = grid->bucketStart = grid->bucketPoints = NULL;
+        grid->pointCapacity = 0;
+    }
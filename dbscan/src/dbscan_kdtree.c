@@ -0,0 +1,242 @@
+#include"dbscan_kdtree.h"
+
+    static double coordOf(const KdTree* tree, int id, int d)
+    {
+        return tree->coord[id * tree->dim + d];
+    }
+
+    static double squaredDistance(const KdTree* tree, int id, const double* query)
+    {
+        double sum = 0, diff;
+        int d;
+        for( d = 0; d < tree->dim; d++ )
+        {
+            diff = coordOf(tree, id, d) - query[d];
+            sum += diff * diff;
+        }
+        return sum;
+    }
+
+    static int compareId(const void* a, const void* b)
+    {
+        return *(const int*)a - *(const int*)b;
+    }
+
+    /*
+     * reorder index[begin..end-1] so that index[kth] holds the median along @d,
+     * smaller coordinates before it and larger ones after it (quickselect)
+     * */
+    static void selectKth(KdTree* tree, int begin, int end, int kth, int d)
+    {
+        int* index = tree->index;
+        int left, right, i, store, temp;
+        double pivot;
+        left = begin;
+        right = end - 1;
+        while( left < right )
+        {
+            i = left + (right - left) / 2;
+            pivot = coordOf(tree, index[i], d);
+            temp = index[i]; index[i] = index[right]; index[right] = temp;
+            store = left;
+            for( i = left; i < right; i++ )
+            {
+                if( coordOf(tree, index[i], d) < pivot )
+                {
+                    temp = index[i]; index[i] = index[store]; index[store] = temp;
+                    store++;
+                }
+            }
+            temp = index[store]; index[store] = index[right]; index[right] = temp;
+            if( store == kth )
+                return;
+            if( store < kth )
+                left = store + 1;
+            else
+                right = store - 1;
+        }
+    }
+
+    /*
+     * build the node holding index[begin..end-1], split at the median of the widest dimension
+     * the return value is the id of the node
+     * */
+    static int buildNode(KdTree* tree, int begin, int end)
+    {
+        int id = tree->nodeCount++;
+        int d, i, mid;
+        double low[KD_MAX_DIM], high[KD_MAX_DIM], value;
+        KdNode* node = &tree->node[id];
+        node->begin = begin;
+        node->end = end;
+        node->left = node->right = -1;
+        node->splitDim = 0;
+        node->splitValue = 0;
+        if( end - begin <= KD_LEAF_SIZE )
+            return id;
+
+        for( d = 0; d < tree->dim; d++ )
+        {
+            low[d] = high[d] = coordOf(tree, tree->index[begin], d);
+            for( i = begin + 1; i < end; i++ )
+            {
+                value = coordOf(tree, tree->index[i], d);
+                if( value < low[d] ) low[d] = value;
+                if( value > high[d] ) high[d] = value;
+            }
+            if( high[d] - low[d] > high[node->splitDim] - low[node->splitDim] )
+                node->splitDim = d;
+        }
+        mid = begin + (end - begin) / 2;
+        selectKth(tree, begin, end, mid, node->splitDim);
+        node->splitValue = coordOf(tree, tree->index[mid], node->splitDim);
+
+        //tree->node may not move, the array is allocated once for the capacity
+        tree->node[id].left = buildNode(tree, begin, mid);
+        tree->node[id].right = buildNode(tree, mid, end);
+        return id;
+    }
+
+    /*
+     * allocate a tree able to hold @capacity points of @dim dimensions
+     *  return 0, or -1 if @dim is not supported or the memory is not there
+     * */
+    int initialKdTree(KdTree* tree, int capacity, int dim)
+    {
+        tree->index = NULL;
+        tree->node = NULL;
+        if( dim < 1 || dim > KD_MAX_DIM )
+            return -1;
+        tree->dim = dim;
+        tree->pointCapacity = capacity;
+        tree->size = 0;
+        tree->coord = NULL;
+        tree->nodeCount = 0;
+        //every split leaves at least KD_LEAF_SIZE / 2 points on both sides
+        tree->nodeCapacity = 2 * (capacity / (KD_LEAF_SIZE / 2) + 1);
+        tree->index = (int*)malloc(sizeof(int) * (capacity + 1));
+        tree->node = (KdNode*)malloc(sizeof(KdNode) * tree->nodeCapacity);
+        if( !tree->index || !tree->node )
+        {
+            destroyKdTree(tree);
+            return -1;
+        }
+        return 0;
+    }
+
+    /*
+     * build the tree over the points 1..@size of @coord
+     * */
+    void buildKdTree(KdTree* tree, const double* coord, int size)
+    {
+        int i;
+        tree->coord = coord;
+        tree->size = size;
+        tree->nodeCount = 0;
+        for( i = 0; i < size; i++ )
+            tree->index[i] = i + 1;
+        buildNode(tree, 0, size);
+    }
+
+    /*
+     * radius query: the ids of all points within @radius of @query, except @exclude (0 to keep all)
+     * the ids are written to @result in ascending order, the return value is their number
+     * */
+    int searchKdTree(const KdTree* tree, const double* query, double radius, int exclude, int* result)
+    {
+        int stack[KD_STACK_SIZE];
+        int top = 0;
+        int size = 0;
+        int i, id;
+        double r2 = radius * radius;
+        double diff;
+        const KdNode* node;
+        if( tree->size == 0 )
+            return 0;
+        stack[top++] = 0;
+        while( top > 0 )
+        {
+            node = &tree->node[stack[--top]];
+            if( node->left < 0 )
+            {
+                for( i = node->begin; i < node->end; i++ )
+                {
+                    id = tree->index[i];
+                    if( id != exclude && squaredDistance(tree, id, query) <= r2 )
+                        result[size++] = id;
+                }
+                continue;
+            }
+            diff = query[node->splitDim] - node->splitValue;
+            if( diff <= radius )
+                stack[top++] = node->left;
+            if( diff >= -radius )
+                stack[top++] = node->right;
+        }
+        qsort(result, size, sizeof(int), compareId);
+        return size;
+    }
+
+    /*
+     * keep the @k nearest found so far in @result / @distance, sorted by squared distance
+     * */
+    static void nearestNode(const KdTree* tree, int nodeID, const double* query, int k, int exclude,
+                            int* result, double* distance, int* count)
+    {
+        const KdNode* node = &tree->node[nodeID];
+        int i, j, id, nearSide, farSide;
+        double d2, diff;
+        if( node->left < 0 )
+        {
+            for( i = node->begin; i < node->end; i++ )
+            {
+                id = tree->index[i];
+                if( id == exclude )
+                    continue;
+                d2 = squaredDistance(tree, id, query);
+                if( *count == k && d2 >= distance[k - 1] )
+                    continue;
+                j = *count < k ? (*count)++ : k - 1;
+                for( ; j > 0 && distance[j - 1] > d2; j-- )
+                {
+                    distance[j] = distance[j - 1];
+                    result[j] = result[j - 1];
+                }
+                distance[j] = d2;
+                result[j] = id;
+            }
+            return;
+        }
+        diff = query[node->splitDim] - node->splitValue;
+        nearSide = diff < 0 ? node->left : node->right;
+        farSide = diff < 0 ? node->right : node->left;
+        nearestNode(tree, nearSide, query, k, exclude, result, distance, count);
+        if( *count < k || diff * diff < distance[k - 1] )
+            nearestNode(tree, farSide, query, k, exclude, result, distance, count);
+    }
+
+    /*
+     * k-nearest query: the @k points closest to @query, except @exclude (0 to keep all)
+     * @result / @distance receive ids and distances nearest first, the return value is their number
+     * */
+    int nearestKdTree(const KdTree* tree, const double* query, int k, int exclude, int* result, double* distance)
+    {
+        int count = 0;
+        int i;
+        if( tree->size == 0 || k <= 0 )
+            return 0;
+        nearestNode(tree, 0, query, k, exclude, result, distance, &count);
+        for( i = 0; i < count; i++ )
+            distance[i] = sqrt(distance[i]);
+        return count;
+    }
+
+    void destroyKdTree(KdTree* tree)
+    {
+        free(tree->index);
+        free(tree->node);
+        tree->index = NULL;
+        tree->node = NULL;
+        tree->pointCapacity = 0;
+        tree->nodeCount = 0;
+    }
@@ -0,0 +1,141 @@
+#include"dbscan.h"
+
+    /*
+     * first stage, on every worker: the directly_density_reachable of its points into its own buffer,
+     * their number into the offsets, and which of them are core objects
+     *  a worker whose buffers can not grow sets failed and leaves the rest of its range
+     * */
+    static void searchJob(void* arg, int worker)
+    {
+        dbscan_ctx* ctx = (dbscan_ctx*)arg;
+        GraphPart* part = &ctx->part[worker];
+        CoreObject* coreObject_Collection = ctx->coreObject_Collection;
+        int* neighbor;
+        int i, size, capacity;
+
+        part->edges = 0;
+        part->cores = 0;
+        part->failed = 0;
+        if( part->scratchCapacity < ctx->data_size )
+        {
+            free(part->scratch);
+            part->scratch = (int*)malloc(sizeof(int) * ctx->data_size);
+            part->scratchCapacity = part->scratch ? ctx->data_size : 0;
+            if( !part->scratch )
+            {
+                part->failed = 1;
+                return;
+            }
+        }
+        for( i = part->begin; i < part->end; i++ )
+        {
+            //one search writes at most data_size ids
+            if( part->capacity - part->edges < ctx->data_size )
+            {
+                capacity = part->capacity * 2 > part->edges + ctx->data_size ? part->capacity * 2 : part->edges + ctx->data_size;
+                neighbor = (int*)realloc(part->neighbor, sizeof(int) * capacity);
+                if( !neighbor )
+                {
+                    part->failed = 1;
+                    return;
+                }
+                part->neighbor = neighbor;
+                part->capacity = capacity;
+            }
+            size = searchGrid(&ctx->grid, ctx->point, i, ctx->neighborhood, part->neighbor + part->edges, part->scratch);
+            part->edges += size;
+            ctx->graph.offset[i + 1] = size;
+            coreObject_Collection[i].reachableSize = size;
+            if( size >= ctx->MinPts - 1 )           //core object
+            {
+                coreObject_Collection[i].coreObjectID = i;
+                part->cores++;
+            }
+            else
+                coreObject_Collection[i].coreObjectID = 0;
+        }
+    }
+
+    /*
+     * second stage, on every worker: copy its lists into the graph, point the points at them
+     * and write its core objects into their slots of @coreObject
+     * */
+    static void mergeJob(void* arg, int worker)
+    {
+        dbscan_ctx* ctx = (dbscan_ctx*)arg;
+        GraphPart* part = &ctx->part[worker];
+        NeighborGraph* graph = &ctx->graph;
+        CoreObject* coreObject_Collection = ctx->coreObject_Collection;
+        int i;
+        int count = part->coreStart;
+
+        if( part->edges > 0 )
+            memcpy(graph->neighbor + graph->offset[part->begin], part->neighbor, sizeof(int) * part->edges);
+        for( i = part->begin; i < part->end; i++ )
+        {
+            coreObject_Collection[i].directlyDensityReachable = graph->neighbor + graph->offset[i] - 1;
+            if( coreObject_Collection[i].coreObjectID != 0 )
+                ctx->coreObject[count++] = coreObject_Collection[i];
+        }
+    }
+
+    /*
+     * split the points of the frame in one contiguous range per worker of @pool
+     * */
+    void splitParts(dbscan_ctx* ctx)
+    {
+        int worker;
+        for( worker = 0; worker < ctx->pool.size; worker++ )
+        {
+            ctx->part[worker].begin = 1 + (int)((long)ctx->data_size * worker / ctx->pool.size);
+            ctx->part[worker].end = 1 + (int)((long)ctx->data_size * (worker + 1) / ctx->pool.size);
+        }
+    }
+
+    /*
+     * calculateDistance_BetweenAll, statisticCoreObject and setCoreObject on all the threads of @pool
+     *  the grid is built first, then the point ranges are searched in parallel, the offsets and
+     *  core counts are summed up, and every worker merges its range into the graph
+     *  return 0, or -1 if the memory of a worker or of the graph is not there
+     * */
+    int parallel_calculateDistance_BetweenAll(dbscan_ctx* ctx)
+    {
+        NeighborGraph* graph = &ctx->graph;
+        int i, worker, edges;
+        int count = 1;
+
+        buildGrid(&ctx->grid, ctx->point, ctx->data_size, ctx->neighborhood, ctx->dimensions, ctx->neighborhoodZ);
+        splitParts(ctx);
+        runPool(&ctx->pool, searchJob, ctx);
+        for( worker = 0; worker < ctx->pool.size; worker++ )
+        {
+            if( ctx->part[worker].failed )
+                return -1;
+        }
+
+        graph->size = ctx->data_size;
+        graph->offset[1] = 1;
+        for( i = 1; i <= ctx->data_size; i++ )
+            graph->offset[i + 1] += graph->offset[i];
+        edges = graph->offset[ctx->data_size + 1] - 1;
+        if( edges > graph->edgeCapacity )
+        {
+            free(graph->neighbor);
+            graph->neighbor = (int*)malloc(sizeof(int) * (edges + 1));
+            if( !graph->neighbor )
+            {
+                graph->edgeCapacity = 0;
+                return -1;
+            }
+            graph->edgeCapacity = edges;
+        }
+        for( worker = 0; worker < ctx->pool.size; worker++ )
+        {
+            ctx->part[worker].coreStart = count;
+            count += ctx->part[worker].cores;
+        }
+        ctx->size_of_core_object = count - 1;
+
+        runPool(&ctx->pool, mergeJob, ctx);
+        return 0;
+    }
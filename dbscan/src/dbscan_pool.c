@@ -0,0 +1,105 @@
+#include"dbscan_pool.h"
+
+    static void* workerMain(void* arg)
+    {
+        WorkerSlot* slot = (WorkerSlot*)arg;
+        WorkerPool* pool = slot->pool;
+        unsigned int seen = 0;
+        PoolJob job;
+        void* jobArg;
+
+        pthread_mutex_lock(&pool->lock);
+        for( ; ; )
+        {
+            while( pool->generation == seen && !pool->quit )
+                pthread_cond_wait(&pool->start, &pool->lock);
+            if( pool->quit )
+                break;
+            seen = pool->generation;
+            job = pool->job;
+            jobArg = pool->arg;
+            pthread_mutex_unlock(&pool->lock);
+
+            job(jobArg, slot->index);
+
+            pthread_mutex_lock(&pool->lock);
+            if( --pool->pending == 0 )
+                pthread_cond_signal(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+        return NULL;
+    }
+
+    /*
+     * start @threads - 1 workers, the caller is the last one
+     *  a thread that can not be started ends the pool there, @size is the number of workers it has
+     * */
+    void initialPool(WorkerPool* pool, int threads)
+    {
+        int i;
+        if( threads < 1 )
+            threads = 1;
+        if( threads > POOL_MAX_THREADS )
+            threads = POOL_MAX_THREADS;
+        pool->size = threads;
+        pool->generation = 0;
+        pool->pending = 0;
+        pool->quit = 0;
+        pool->job = NULL;
+        pool->arg = NULL;
+        pthread_mutex_init(&pool->lock, NULL);
+        pthread_cond_init(&pool->start, NULL);
+        pthread_cond_init(&pool->done, NULL);
+        for( i = 1; i < threads; i++ )
+        {
+            pool->slot[i].pool = pool;
+            pool->slot[i].index = i;
+            if( pthread_create(&pool->thread[i], NULL, workerMain, &pool->slot[i]) != 0 )
+            {
+                pool->size = i;
+                break;
+            }
+        }
+    }
+
+    /*
+     * run @job(@arg, worker) on every worker and wait until all of them return
+     * */
+    void runPool(WorkerPool* pool, PoolJob job, void* arg)
+    {
+        if( pool->size > 1 )
+        {
+            pthread_mutex_lock(&pool->lock);
+            pool->job = job;
+            pool->arg = arg;
+            pool->pending = pool->size - 1;
+            pool->generation++;
+            pthread_cond_broadcast(&pool->start);
+            pthread_mutex_unlock(&pool->lock);
+        }
+
+        job(arg, 0);
+
+        if( pool->size > 1 )
+        {
+            pthread_mutex_lock(&pool->lock);
+            while( pool->pending > 0 )
+                pthread_cond_wait(&pool->done, &pool->lock);
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+
+    void destroyPool(WorkerPool* pool)
+    {
+        int i;
+        pthread_mutex_lock(&pool->lock);
+        pool->quit = 1;
+        pthread_cond_broadcast(&pool->start);
+        pthread_mutex_unlock(&pool->lock);
+        for( i = 1; i < pool->size; i++ )
+            pthread_join(pool->thread[i], NULL);
+        pthread_mutex_destroy(&pool->lock);
+        pthread_cond_destroy(&pool->start);
+        pthread_cond_destroy(&pool->done);
+        pool->size = 0;
+    }
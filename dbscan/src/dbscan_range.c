@@ -0,0 +1,213 @@
+#include"dbscan.h"
+#include"dbscan_range.h"
+
+    /*
+     * allocate a range image able to hold @capacity points, with the geometry of the LUX
+     *  the geometry fields may be changed before buildRangeImage, the cells follow
+     *  return 0, or -1 if the memory is not there
+     * */
+    int initialRangeImage(RangeImage* range, int capacity)
+    {
+        range->layers = RANGE_LAYERS;
+        range->elevationMin = RANGE_ELEVATION_MIN;
+        range->layerSpacing = RANGE_LAYER_SPACING;
+        range->binWidth = RANGE_BIN_WIDTH;
+        range->gapBins = RANGE_GAP_BINS;
+        range->maxGapBins = RANGE_GAP_MAX_BINS;
+        range->bins = 0;
+        range->pointCapacity = capacity;
+        range->cellCapacity = 0;
+        range->cellStart = NULL;
+        range->cellGap = NULL;
+        range->cell = (int*)malloc(sizeof(int) * (capacity + 1));
+        range->cellPoints = (int*)malloc(sizeof(int) * (capacity + 1));
+        if( !range->cell || !range->cellPoints )
+        {
+            destroyRangeImage(range);
+            return -1;
+        }
+        return 0;
+    }
+
+    /*
+     * bins the neighborhood of @point spans on each side, the angle of the neighborhood seen from the scanner,
+     *  at least gapBins and at most maxGapBins
+     * */
+    static int reachBins(const RangeImage* range, const Point* point, double neighborhood)
+    {
+        double reach = hypot(point->x, point->y);
+        int gap;
+        reach = reach > neighborhood ? asin(neighborhood / reach) : M_PI;
+        gap = (int)ceil(reach / range->binWidth);
+        return gap < range->gapBins ? range->gapBins : gap > range->maxGapBins ? range->maxGapBins : gap;
+    }
+
+    /*
+     * bucket point[1..data_size] by cell, counting sort like buildGrid, and keep the widest window
+     * of @neighborhood of every cell
+     *  the layers out of the fan are folded into the first and the last one
+     *  return 0, or -1 if the memory for the cells is not there
+     * */
+    int buildRangeImage(RangeImage* range, const Point* point, int data_size, double neighborhood)
+    {
+        int i, c, layer, bin, cells, gap;
+        range->bins = (int)ceil(2 * M_PI / range->binWidth);
+        cells = range->layers * range->bins;
+        if( cells > range->cellCapacity )
+        {
+            free(range->cellStart);
+            free(range->cellGap);
+            range->cellStart = (int*)malloc(sizeof(int) * (cells + 1));
+            range->cellGap = (int*)malloc(sizeof(int) * cells);
+            if( !range->cellStart || !range->cellGap )
+            {
+                free(range->cellStart);
+                free(range->cellGap);
+                range->cellStart = NULL;
+                range->cellGap = NULL;
+                range->cellCapacity = 0;
+                return -1;
+            }
+            range->cellCapacity = cells;
+        }
+        memset(range->cellStart, 0, sizeof(int) * (cells + 1));
+        memset(range->cellGap, 0, sizeof(int) * cells);
+        for( i = 1; i <= data_size; i++ )
+        {
+            layer = (int)floor((atan2(point[i].z, hypot(point[i].x, point[i].y)) - range->elevationMin) / range->layerSpacing);
+            layer = layer < 0 ? 0 : layer >= range->layers ? range->layers - 1 : layer;
+            bin = (int)((atan2(point[i].y, point[i].x) + M_PI) / range->binWidth);
+            bin = bin >= range->bins ? range->bins - 1 : bin;
+            range->cell[i] = layer * range->bins + bin;
+            range->cellStart[range->cell[i] + 1]++;
+            gap = reachBins(range, &point[i], neighborhood);
+            if( gap > range->cellGap[range->cell[i]] )
+                range->cellGap[range->cell[i]] = gap;
+        }
+        for( c = 0; c < cells; c++ )
+            range->cellStart[c + 1] += range->cellStart[c];
+        for( i = 1; i <= data_size; i++ )
+            range->cellPoints[range->cellStart[range->cell[i]]++] = i;
+        for( c = cells; c > 0; c-- )
+            range->cellStart[c] = range->cellStart[c - 1];
+        range->cellStart[0] = 0;
+        return 0;
+    }
+
+    void destroyRangeImage(RangeImage* range)
+    {
+        free(range->cell);
+        free(range->cellStart);
+        free(range->cellGap);
+        free(range->cellPoints);
+        range->cell = range->cellStart = range->cellGap = range->cellPoints = NULL;
+        range->pointCapacity = range->cellCapacity = 0;
+    }
+
+    static int findRoot(int* parent, int x)
+    {
+        while( parent[x] != x )
+        {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    //the larger root under the smaller one, so a root is the smallest point of its set
+    static void unite(int* parent, int a, int b)
+    {
+        a = findRoot(parent, a);
+        b = findRoot(parent, b);
+        if( a < b )
+            parent[b] = a;
+        else if( b < a )
+            parent[a] = b;
+    }
+
+    /*
+     * unite @pointID with the points of @cell inside the neighborhood, from cellPoints[@from] on
+     *  the test is the one of the grid, z scaled by @scaleZ in 3D
+     * */
+    static void uniteCell(dbscan_ctx* ctx, int pointID, int cell, int from, double scaleZ, double eps2)
+    {
+        const RangeImage* range = &ctx->range;
+        const Point* point = ctx->point;
+        int k, i;
+        double dx, dy, dz;
+        for( k = from > range->cellStart[cell] ? from : range->cellStart[cell]; k < range->cellStart[cell + 1]; k++ )
+        {
+            i = range->cellPoints[k];
+            dx = point[i].x - point[pointID].x;
+            dy = point[i].y - point[pointID].y;
+            dz = ctx->dimensions == 3 ? point[i].z * scaleZ - point[pointID].z * scaleZ : 0;
+            if( dx * dx + dy * dy + dz * dz <= eps2 )
+                unite(ctx->parent, pointID, i);
+        }
+    }
+
+    /*
+     * segment the frame on its range image instead of searching the neighborhood of every point
+     *  two points are connected when they are within the neighborhood of the context, in the same or the
+     *  next layer, and as many bins apart as the window of either spans; a connected set of at least MinPts points is
+     *  a cluster, numbered in the order of its smallest point, the smaller sets are noise
+     *  unlike DBSCAN there are no core and border points, a chain of close returns is one cluster
+     *  return 0, or -1 if the memory of the range image is not there
+     * */
+    int rangeImage_DBSCAN(dbscan_ctx* ctx)
+    {
+        const RangeImage* range = &ctx->range;
+        int* parent = ctx->parent;
+        int* cluster = ctx->cluster;
+        double scaleZ = ctx->neighborhoodZ > 0 ? ctx->neighborhood / ctx->neighborhoodZ : 1;
+        double eps2 = ctx->neighborhood * ctx->neighborhood;
+        int i, k, d, c, layer, bin, gap, count = 0;
+
+        if( buildRangeImage(&ctx->range, ctx->point, ctx->data_size, ctx->neighborhood) != 0 )
+            return -1;
+        for( i = 1; i <= ctx->data_size; i++ )
+            parent[i] = i;
+        //every pair of cells is visited once, from its left cell along a layer and from the lower layer across,
+        //out to the wider of their two windows
+        for( k = 0; k < ctx->data_size; k++ )
+        {
+            i = range->cellPoints[k];
+            layer = range->cell[i] / range->bins;
+            bin = range->cell[i] % range->bins;
+            gap = range->cellGap[range->cell[i]];
+            uniteCell(ctx, i, range->cell[i], k + 1, scaleZ, eps2);
+            for( d = 1; d <= range->maxGapBins; d++ )
+            {
+                c = layer * range->bins + (bin + d) % range->bins;
+                if( d <= gap || d <= range->cellGap[c] )
+                    uniteCell(ctx, i, c, 0, scaleZ, eps2);
+            }
+            if( layer + 1 < range->layers )
+            {
+                for( d = -range->maxGapBins; d <= range->maxGapBins; d++ )
+                {
+                    c = (layer + 1) * range->bins + (bin + d + range->bins) % range->bins;
+                    if( abs(d) <= gap || abs(d) <= range->cellGap[c] )
+                        uniteCell(ctx, i, c, 0, scaleZ, eps2);
+                }
+            }
+        }
+
+        //size of every set at its root, then the labels in point order, a root comes before its set
+        memset(cluster, 0, sizeof(int) * (ctx->data_size + 1));
+        for( i = 1; i <= ctx->data_size; i++ )
+        {
+            parent[i] = findRoot(parent, i);
+            cluster[parent[i]]++;
+        }
+        for( i = 1; i <= ctx->data_size; i++ )
+        {
+            if( parent[i] == i )
+                cluster[i] = cluster[i] >= ctx->MinPts ? ++count : 0;
+            else
+                cluster[i] = cluster[parent[i]];
+        }
+        ctx->size_of_core_object = 0;
+        ctx->cluster_count = count;
+        return 0;
+    }
@@ -0,0 +1,225 @@
+#include"dbscan_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include<immintrin.h>
+#define SIMD_X86
+#endif
+
+    /*
+     * allocate @capacity points of @dim coordinates, z only for dim 3
+     *  return 0, or -1 if the memory is not there
+     * */
+    int initialPointStore(PointStore* store, int capacity, int dim)
+    {
+        store->size = 0;
+        store->capacity = capacity;
+        store->x = (double*)malloc(sizeof(double) * (capacity + 1));
+        store->y = (double*)malloc(sizeof(double) * (capacity + 1));
+        store->z = dim == 3 ? (double*)malloc(sizeof(double) * (capacity + 1)) : NULL;
+        if( !store->x || !store->y || (dim == 3 && !store->z) )
+        {
+            destroyPointStore(store);
+            return -1;
+        }
+        return 0;
+    }
+
+    void destroyPointStore(PointStore* store)
+    {
+        free(store->x);
+        free(store->y);
+        free(store->z);
+        store->x = store->y = store->z = NULL;
+        store->size = store->capacity = 0;
+    }
+
+    /*
+     * the scalar test of candidates begin..count-1, also the tail of the vector kernels
+     * */
+    static int radiusFrom(const double* x, const double* y, int begin, int count, double qx, double qy, double eps2, int* hit, int size)
+    {
+        int k;
+        double dx, dy;
+        for( k = begin; k < count; k++ )
+        {
+            dx = x[k] - qx;
+            dy = y[k] - qy;
+            if( dx * dx + dy * dy <= eps2 )
+                hit[size++] = k;
+        }
+        return size;
+    }
+
+    static int radiusFrom3(const double* x, const double* y, const double* z, int begin, int count, double qx, double qy, double qz, double eps2, int* hit, int size)
+    {
+        int k;
+        double dx, dy, dz;
+        for( k = begin; k < count; k++ )
+        {
+            dx = x[k] - qx;
+            dy = y[k] - qy;
+            dz = z[k] - qz;
+            if( dx * dx + dy * dy + dz * dz <= eps2 )
+                hit[size++] = k;
+        }
+        return size;
+    }
+
+    static int radiusScalar(const double* x, const double* y, int count, double qx, double qy, double eps2, int* hit)
+    {
+        return radiusFrom(x, y, 0, count, qx, qy, eps2, hit, 0);
+    }
+
+    static int radiusScalar3(const double* x, const double* y, const double* z, int count, double qx, double qy, double qz, double eps2, int* hit)
+    {
+        return radiusFrom3(x, y, z, 0, count, qx, qy, qz, eps2, hit, 0);
+    }
+
+#ifdef SIMD_X86
+    /*
+     * the vector kernels add the squares in the same order as the scalar one and without fma,
+     * so every level finds exactly the same candidates
+     * the positions are stored without a branch, a lane outside just does not move @size
+     * */
+    static int radiusSse2(const double* x, const double* y, int count, double qx, double qy, double eps2, int* hit)
+    {
+        __m128d vqx = _mm_set1_pd(qx);
+        __m128d vqy = _mm_set1_pd(qy);
+        __m128d veps = _mm_set1_pd(eps2);
+        __m128d dx, dy;
+        int k, mask;
+        int size = 0;
+        for( k = 0; k + 2 <= count; k += 2 )
+        {
+            dx = _mm_sub_pd(_mm_loadu_pd(x + k), vqx);
+            dy = _mm_sub_pd(_mm_loadu_pd(y + k), vqy);
+            mask = _mm_movemask_pd(_mm_cmple_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), veps));
+            hit[size] = k;
+            size += mask & 1;
+            hit[size] = k + 1;
+            size += mask >> 1;
+        }
+        return radiusFrom(x, y, k, count, qx, qy, eps2, hit, size);
+    }
+
+    static int radiusSse2_3(const double* x, const double* y, const double* z, int count, double qx, double qy, double qz, double eps2, int* hit)
+    {
+        __m128d vqx = _mm_set1_pd(qx);
+        __m128d vqy = _mm_set1_pd(qy);
+        __m128d vqz = _mm_set1_pd(qz);
+        __m128d veps = _mm_set1_pd(eps2);
+        __m128d dx, dy, dz;
+        int k, mask;
+        int size = 0;
+        for( k = 0; k + 2 <= count; k += 2 )
+        {
+            dx = _mm_sub_pd(_mm_loadu_pd(x + k), vqx);
+            dy = _mm_sub_pd(_mm_loadu_pd(y + k), vqy);
+            dz = _mm_sub_pd(_mm_loadu_pd(z + k), vqz);
+            mask = _mm_movemask_pd(_mm_cmple_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz)), veps));
+            hit[size] = k;
+            size += mask & 1;
+            hit[size] = k + 1;
+            size += mask >> 1;
+        }
+        return radiusFrom3(x, y, z, k, count, qx, qy, qz, eps2, hit, size);
+    }
+
+    __attribute__((target("avx2")))
+    static int radiusAvx2(const double* x, const double* y, int count, double qx, double qy, double eps2, int* hit)
+    {
+        __m256d vqx = _mm256_set1_pd(qx);
+        __m256d vqy = _mm256_set1_pd(qy);
+        __m256d veps = _mm256_set1_pd(eps2);
+        __m256d dx, dy;
+        int k, mask;
+        int size = 0;
+        for( k = 0; k + 4 <= count; k += 4 )
+        {
+            dx = _mm256_sub_pd(_mm256_loadu_pd(x + k), vqx);
+            dy = _mm256_sub_pd(_mm256_loadu_pd(y + k), vqy);
+            mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), veps, _CMP_LE_OQ));
+            hit[size] = k;
+            size += mask & 1;
+            hit[size] = k + 1;
+            size += (mask >> 1) & 1;
+            hit[size] = k + 2;
+            size += (mask >> 2) & 1;
+            hit[size] = k + 3;
+            size += mask >> 3;
+        }
+        return radiusFrom(x, y, k, count, qx, qy, eps2, hit, size);
+    }
+
+    __attribute__((target("avx2")))
+    static int radiusAvx2_3(const double* x, const double* y, const double* z, int count, double qx, double qy, double qz, double eps2, int* hit)
+    {
+        __m256d vqx = _mm256_set1_pd(qx);
+        __m256d vqy = _mm256_set1_pd(qy);
+        __m256d vqz = _mm256_set1_pd(qz);
+        __m256d veps = _mm256_set1_pd(eps2);
+        __m256d dx, dy, dz;
+        int k, mask;
+        int size = 0;
+        for( k = 0; k + 4 <= count; k += 4 )
+        {
+            dx = _mm256_sub_pd(_mm256_loadu_pd(x + k), vqx);
+            dy = _mm256_sub_pd(_mm256_loadu_pd(y + k), vqy);
+            dz = _mm256_sub_pd(_mm256_loadu_pd(z + k), vqz);
+            mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz)), veps, _CMP_LE_OQ));
+            hit[size] = k;
+            size += mask & 1;
+            hit[size] = k + 1;
+            size += (mask >> 1) & 1;
+            hit[size] = k + 2;
+            size += (mask >> 2) & 1;
+            hit[size] = k + 3;
+            size += mask >> 3;
+        }
+        return radiusFrom3(x, y, z, k, count, qx, qy, qz, eps2, hit, size);
+    }
+#endif
+
+    /*
+     * best level the cpu runs, SIMD_SCALAR off x86
+     * */
+    int detectSimd()
+    {
+#ifdef SIMD_X86
+        __builtin_cpu_init();
+        if( __builtin_cpu_supports("avx2") )
+            return SIMD_AVX2;
+        if( __builtin_cpu_supports("sse2") )
+            return SIMD_SSE2;
+#endif
+        return SIMD_SCALAR;
+    }
+
+    /*
+     * kernel of @level, or of the best level below it the cpu runs
+     * */
+    RadiusKernel selectRadiusKernel(int level)
+    {
+        if( level > detectSimd() )
+            level = detectSimd();
+#ifdef SIMD_X86
+        if( level == SIMD_AVX2 )
+            return radiusAvx2;
+        if( level == SIMD_SSE2 )
+            return radiusSse2;
+#endif
+        return radiusScalar;
+    }
+
+    RadiusKernel3 selectRadiusKernel3(int level)
+    {
+        if( level > detectSimd() )
+            level = detectSimd();
+#ifdef SIMD_X86
+        if( level == SIMD_AVX2 )
+            return radiusAvx2_3;
+        if( level == SIMD_SSE2 )
+            return radiusSse2_3;
+#endif
+        return radiusScalar3;
+    }
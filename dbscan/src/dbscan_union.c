@@ -0,0 +1,162 @@
+#include"dbscan.h"
+
+    /*
+     * root of @x, halving the path on the way
+     *  a parent always has a smaller id than its child, so the forest never gets a cycle
+     *  and the root of a set is its smallest core
+     * */
+    static int findRoot(int* parent, int x)
+    {
+        int p, gp;
+        while( (p = __atomic_load_n(&parent[x], __ATOMIC_RELAXED)) != x )
+        {
+            gp = __atomic_load_n(&parent[p], __ATOMIC_RELAXED);
+            if( p != gp )
+                __atomic_compare_exchange_n(&parent[x], &p, gp, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+            x = gp;
+        }
+        return x;
+    }
+
+    /*
+     * merge the sets of @a and @b, lock-free
+     *  the larger root is hung under the smaller one, only if it is still a root
+     * */
+    static void unite(int* parent, int a, int b)
+    {
+        int expected;
+        for( ; ; )
+        {
+            a = findRoot(parent, a);
+            b = findRoot(parent, b);
+            if( a == b )
+                return;
+            if( a < b )
+            {
+                expected = a;
+                a = b;
+                b = expected;
+            }
+            expected = a;
+            if( __atomic_compare_exchange_n(&parent[a], &expected, b, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
+                return;
+        }
+    }
+
+    static void initialJob(void* arg, int worker)
+    {
+        dbscan_ctx* ctx = (dbscan_ctx*)arg;
+        int i;
+        for( i = ctx->part[worker].begin; i < ctx->part[worker].end; i++ )
+            ctx->parent[i] = i;
+    }
+
+    /*
+     * every core of the range with the cores of its directly_density_reachable
+     * */
+    static void unionJob(void* arg, int worker)
+    {
+        dbscan_ctx* ctx = (dbscan_ctx*)arg;
+        const CoreObject* coreObject_Collection = ctx->coreObject_Collection;
+        int i, k, j;
+        for( i = ctx->part[worker].begin; i < ctx->part[worker].end; i++ )
+        {
+            if( coreObject_Collection[i].coreObjectID == 0 )
+                continue;
+            for( k = 1; k <= coreObject_Collection[i].reachableSize; k++ )
+            {
+                j = coreObject_Collection[i].directlyDensityReachable[k];
+                //every pair once, from its smaller core
+                if( j > i && coreObject_Collection[j].coreObjectID != 0 )
+                    unite(ctx->parent, i, j);
+            }
+        }
+    }
+
+    /*
+     * point every core of the range straight at its root and count the roots
+     * */
+    static void rootJob(void* arg, int worker)
+    {
+        dbscan_ctx* ctx = (dbscan_ctx*)arg;
+        GraphPart* part = &ctx->part[worker];
+        int i;
+        part->roots = 0;
+        for( i = part->begin; i < part->end; i++ )
+        {
+            if( ctx->coreObject_Collection[i].coreObjectID == 0 )
+                continue;
+            ctx->parent[i] = findRoot(ctx->parent, i);
+            if( ctx->parent[i] == i )
+                part->roots++;
+        }
+    }
+
+    static void numberJob(void* arg, int worker)
+    {
+        dbscan_ctx* ctx = (dbscan_ctx*)arg;
+        GraphPart* part = &ctx->part[worker];
+        int i;
+        int count = part->rootStart;
+        for( i = part->begin; i < part->end; i++ )
+        {
+            if( ctx->coreObject_Collection[i].coreObjectID != 0 && ctx->parent[i] == i )
+                ctx->cluster[i] = count++;
+        }
+    }
+
+    /*
+     * a core takes the cluster of its root, any other point the one of its first core neighbor
+     * */
+    static void labelJob(void* arg, int worker)
+    {
+        dbscan_ctx* ctx = (dbscan_ctx*)arg;
+        const CoreObject* coreObject_Collection = ctx->coreObject_Collection;
+        int i, k, j;
+        for( i = ctx->part[worker].begin; i < ctx->part[worker].end; i++ )
+        {
+            if( coreObject_Collection[i].coreObjectID != 0 )
+            {
+                if( ctx->parent[i] != i )
+                    ctx->cluster[i] = ctx->cluster[ctx->parent[i]];
+                continue;
+            }
+            ctx->cluster[i] = 0;            //noise unless a core reaches it
+            for( k = 1; k <= coreObject_Collection[i].reachableSize; k++ )
+            {
+                j = coreObject_Collection[i].directlyDensityReachable[k];
+                if( coreObject_Collection[j].coreObjectID != 0 )
+                {
+                    ctx->cluster[i] = ctx->cluster[ctx->parent[j]];
+                    break;
+                }
+            }
+        }
+    }
+
+    /*
+     * DBSCAN without a seed: every core is united with its core neighbors in a disjoint-set
+     * forest on all the threads of @pool, then the border points are attached
+     *  the clusters are numbered in the order of their smallest core, so the cores get the same
+     *  labels as DBSCAN in DBSCAN_SEED_ORDERED mode whatever @seedMode is
+     *  a border point reached by two clusters goes to the one of its smallest core neighbor
+     * */
+    void unionFind_DBSCAN(dbscan_ctx* ctx)
+    {
+        int worker;
+        int count = 1;
+
+        splitParts(ctx);
+        runPool(&ctx->pool, initialJob, ctx);
+        runPool(&ctx->pool, unionJob, ctx);
+        runPool(&ctx->pool, rootJob, ctx);
+        for( worker = 0; worker < ctx->pool.size; worker++ )
+        {
+            ctx->part[worker].rootStart = count;
+            count += ctx->part[worker].roots;
+        }
+        ctx->cluster_count = count - 1;
+        ctx->cluster[0] = 0;
+        runPool(&ctx->pool, numberJob, ctx);
+        runPool(&ctx->pool, labelJob, ctx);
+    }
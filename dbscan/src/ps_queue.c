@@ -3,77 +3,119 @@
   /* 
      * some operation about queue 
      * */  
-    void initialQueue(LinkQueue* LQ)  
+    static int roundCapacity(int capacity)  
     {  
-        LQ->front = (QueueNodePtr)malloc(sizeof(QueueNode));  
-        if( !LQ->front )  
-        {  
-            printf("Queue initial malloc error!");  
-            exit(0);  
-        }  
-        LQ->rear = LQ->front;  
-        LQ->rear->next = NULL;  
+        int size = 16;  
+        while( size < capacity )  
+            size <<= 1;  
+        return size;  
+    }  
+    /* 
+     * move the ids to a buffer of @capacity, the head goes back to index 0 
+     *  return 0, or -1 if the memory is not there, the queue is then left as it was 
+     * */  
+    static int resizeQueue(RingQueue* LQ, int capacity)  
+    {  
+        int* data;  
+        int i;  
+        data = (int*)malloc(sizeof(int) * capacity);  
+        if( !data )  
+            return -1;  
+        for( i = 0; i < LQ->size; i++ )  
+            data[i] = LQ->data[(LQ->front + i) & (LQ->capacity - 1)];  
+        free(LQ->data);  
+        LQ->data = data;  
+        LQ->capacity = capacity;  
+        LQ->front = 0;  
+        return 0;  
     }  
-    void insertQueue(LinkQueue* LQ, int pointID)  
+    /* 
+     * room for @capacity ids, return 0, or -1 if the memory is not there 
+     * */  
+    int initialQueue(RingQueue* LQ, int capacity)  
     {  
-        QueueNode* new;  
-        new = (QueueNodePtr)malloc(sizeof(QueueNode));  
-        if( !new )  
+        LQ->capacity = roundCapacity(capacity);  
+        LQ->front = 0;  
+        LQ->size = 0;  
+        LQ->data = (int*)malloc(sizeof(int) * LQ->capacity);  
+        if( !LQ->data )  
         {  
-            printf("insert queue malloc error %d\n", pointID);  
-            exit(0);  
+            LQ->capacity = 0;  
+            return -1;  
         }  
-        new->data = pointID;  
-        new->next = LQ->rear;  
-        LQ->rear->next = new;  
-        LQ->rear = new;  
+        return 0;  
+    }  
+    /* 
+     * make room for @capacity ids, called once per frame with the number of points 
+     *  return 0, or -1 if the memory is not there 
+     * */  
+    int reserveQueue(RingQueue* LQ, int capacity)  
+    {  
+        if( capacity > LQ->capacity )  
+            return resizeQueue(LQ, roundCapacity(capacity));  
+        return 0;  
+    }  
+    /* 
+     * return 0, or -1 if the queue was full and could not grow, @pointID is then not in it 
+     * */  
+    int insertQueue(RingQueue* LQ, int pointID)  
+    {  
+        //only if the queue was not reserved for the frame  
+        if( LQ->size == LQ->capacity && resizeQueue(LQ, LQ->capacity * 2) != 0 )  
+            return -1;  
+        LQ->data[(LQ->front + LQ->size) & (LQ->capacity - 1)] = pointID;  
+        LQ->size++;  
+        return 0;  
     }  
-    void deleteQueue(LinkQueue* LQ, int* pointID)  
+    void deleteQueue(RingQueue* LQ, int* pointID)  
     {  
-        QueueNode* p = LQ->front->next;  
-        *pointID = p->data;  
-        LQ->front->next = p->next;  
-        if( p == LQ->rear )  
-            LQ->rear = LQ->front;  
-        free(p);  
+        *pointID = LQ->data[LQ->front];  
+        LQ->front = (LQ->front + 1) & (LQ->capacity - 1);  
+        LQ->size--;  
     }  
-    void printQueue(LinkQueue LQ)  
+    void printQueue(const RingQueue* LQ)  
     {  
+        int i;  
         if( 1 == isEmptyQueue(LQ) )  
         {  
             printf("\nqueue is empty\n");  
             return;  
         }  
-        LQ.front = LQ.front->next;  
-        while( LQ.front != LQ.rear )  
-        {  
-            printf("%d ", LQ.front->data);  
-            LQ.front = LQ.front->next;  
-        }  
-        printf("%d\n", LQ.front->data);  
+        for( i = 0; i < LQ->size - 1; i++ )  
+            printf("%d ", LQ->data[(LQ->front + i) & (LQ->capacity - 1)]);  
+        printf("%d\n", LQ->data[(LQ->front + i) & (LQ->capacity - 1)]);  
+    }  
+    void destroyQueue(RingQueue* LQ)  
+    {  
+        free(LQ->data);  
+        LQ->data = NULL;  
+        LQ->capacity = 0;  
+        LQ->front = 0;  
+        LQ->size = 0;  
     }  
-    int isEmptyQueue(LinkQueue LQ)  
+    int isEmptyQueue(const RingQueue* LQ)  
     {  
-        return LQ.front == LQ.rear ? 1 : 0;  
+        return LQ->size == 0 ? 1 : 0;  
     }  
     //test  
     void testQueue()  
     {  
-        LinkQueue L;  
-        initialQueue(&L);  
+        RingQueue L;  
+        initialQueue(&L, 4);  
         insertQueue(&L, 1);  
         insertQueue(&L, 2);  
         insertQueue(&L, 3);  
         insertQueue(&L, 4);  
         insertQueue(&L, 5);  
-        printQueue(L);  
+        printQueue(&L);  
         int test;  
         deleteQueue(&L, &test);  
         deleteQueue(&L, &test);  
         deleteQueue(&L, &test);  
         deleteQueue(&L, &test);  
-        printf("is empty = %d\n", isEmptyQueue(L));  
+        printf("is empty = %d\n", isEmptyQueue(&L));  
         deleteQueue(&L, &test);  
-        printf("is empty = %d\n", isEmptyQueue(L));  
-        printQueue(L);  
+        printf("is empty = %d\n", isEmptyQueue(&L));  
+        printQueue(&L);  
+        destroyQueue(&L);  
     }  
@@ -0,0 +1,685 @@
+#define _GNU_SOURCE
+#include"dbscan.h"
+
+#define TEST_NEIGHBORHOOD   0.3
+#define TEST_OBJECT_POINTS  40
+#define TEST_MINPTS         5
+#define TEST_DENSE_SIZE     4000    //points of the dense frame, long neighbor lists
+#define TEST_DENSE_SIDE     2.0
+#define TEST_THREAD_SIZE    10000
+#define TEST_KERNEL_SIZE    1024
+#define TEST_QUEUE_POINTS   5000
+#define TEST_SIGN_HEIGHT    2.0     //z of the signs stacked over every other object
+#define TEST_NEIGHBORHOOD_Z 0.15
+#define TEST_CLOUD_PATH     "/tmp/dbscan_test_cloud.bin"
+#define TEST_RANGE_SIZE     3000
+#define TEST_RANGE_NEAR     5.0     //meters, the window of the range image is not capped beyond
+
+static const int test_size[] = {500, 2000, 5000};
+static const double test_sweep[] = {0.1, 0.3, 0.8};
+static const int test_threads[] = {2, 4, 8};
+static const char* test_simd_name[] = {"scalar", "sse2", "avx2"};
+
+    static double uniform(double low, double high)
+    {
+        return low + (high - low) * rand() / (double)RAND_MAX;
+    }
+
+    /*
+     * a synthetic scan in front of the car: objects of TEST_OBJECT_POINTS returns
+     * spread over 0.5 m, plus one point in ten of uniform noise, point[1..size]
+     * */
+    static void makeFrame(Point* point, int size)
+    {
+        int i;
+        double cx = 0, cy = 0;
+        for( i = 1; i <= size; i++ )
+        {
+            if( i % 10 == 0 )
+            {
+                point[i].x = uniform(0, 50);
+                point[i].y = uniform(-20, 20);
+            }
+            else
+            {
+                if( i % TEST_OBJECT_POINTS == 1 )
+                {
+                    cx = uniform(0, 50);
+                    cy = uniform(-20, 20);
+                }
+                point[i].x = cx + uniform(-0.5, 0.5);
+                point[i].y = cy + uniform(-0.5, 0.5);
+            }
+            point[i].z = 0;
+        }
+    }
+
+    /*
+     * the frame of makeFrame in 3D: the objects are 0.3 m high on the ground, every other one
+     * has a sign of the same footprint TEST_SIGN_HEIGHT above it, the noise is spread up to 3 m
+     * */
+    static void makeStackedFrame(Point* point, int size)
+    {
+        int i;
+        makeFrame(point, size);
+        for( i = 1; i <= size; i++ )
+        {
+            if( i % 10 == 0 )
+                point[i].z = uniform(0, 3);
+            else
+                point[i].z = uniform(0, 0.3) + ((i - 1) / TEST_OBJECT_POINTS % 2) * TEST_SIGN_HEIGHT;
+        }
+    }
+
+    /*
+     * every point within @eps of point @pointID, z scaled like the grid scales it, in increasing order
+     * */
+    static int searchAll(const Point* point, int size, int pointID, double eps, double scaleZ, int* result)
+    {
+        int i;
+        int count = 0;
+        double dx, dy, dz;
+        for( i = 1; i <= size; i++ )
+        {
+            dx = point[i].x - point[pointID].x;
+            dy = point[i].y - point[pointID].y;
+            dz = point[i].z * scaleZ - point[pointID].z * scaleZ;
+            if( i != pointID && dx * dx + dy * dy + dz * dz <= eps * eps )
+                result[count++] = i;
+        }
+        return count;
+    }
+
+    //@size ids of @a against those of @b
+    static int sameList(const int* a, const int* b, int size)
+    {
+        return size == 0 || memcmp(a, b, sizeof(int) * size) == 0;
+    }
+
+    /*
+     * the grid and the neighbor graph against the full scan, on spread frames and on a dense one
+     * */
+    static int testNeighbor()
+    {
+        int sizes = (int)(sizeof(test_size) / sizeof(test_size[0]));
+        int s, i, expectSize, resultSize, failed = 0;
+        for( s = 0; s <= sizes && !failed; s++ )
+        {
+            int size = s < sizes ? test_size[s] : TEST_DENSE_SIZE;
+            Point* point = (Point*)malloc(sizeof(Point) * (size + 1));
+            int* expect = (int*)malloc(sizeof(int) * (size + 1));
+            int* result = (int*)malloc(sizeof(int) * (size + 1));
+            GridIndex grid;
+            NeighborGraph graph;
+            if( !point || !expect || !result || initialGrid(&grid, size) != 0 || initialGraph(&graph, size) != 0 )
+            {
+                printf("test malloc error!\n");
+                return -1;
+            }
+            makeFrame(point, size);
+            for( i = 1; s == sizes && i <= size; i++ )
+            {
+                point[i].x = uniform(0, TEST_DENSE_SIDE);
+                point[i].y = uniform(0, TEST_DENSE_SIDE);
+            }
+            buildGrid(&grid, point, size, TEST_NEIGHBORHOOD, 2, 0);
+            buildGraph(&graph, &grid, point, size, TEST_NEIGHBORHOOD);
+            for( i = 1; i <= size && !failed; i++ )
+            {
+                expectSize = searchAll(point, size, i, TEST_NEIGHBORHOOD, 0, expect);
+                resultSize = searchGrid(&grid, point, i, TEST_NEIGHBORHOOD, result, graph.scratch);
+                if( expectSize != resultSize || !sameList(expect, result, expectSize)
+                        || expectSize != graph.offset[i + 1] - graph.offset[i]
+                        || !sameList(expect, graph.neighbor + graph.offset[i], expectSize) )
+                {
+                    printf("grid mismatch at point %d of %d\n", i, size);
+                    failed = 1;
+                }
+            }
+            destroyGrid(&grid);
+            destroyGraph(&graph);
+            free(point);
+            free(expect);
+            free(result);
+        }
+        return failed ? -1 : 0;
+    }
+
+    /*
+     * the kd-tree against the grid for every neighborhood of the sweep
+     * */
+    static int testKdTree()
+    {
+        int size = test_size[1];
+        Point* point = (Point*)malloc(sizeof(Point) * (size + 1));
+        int* expect = (int*)malloc(sizeof(int) * (size + 1));
+        int* result = (int*)malloc(sizeof(int) * (size + 1));
+        GridIndex grid;
+        KdTree tree;
+        int s, i, expectSize, resultSize, failed = 0;
+        if( !point || !expect || !result || initialGrid(&grid, size) != 0 || initialKdTree(&tree, size, 3) != 0 )
+        {
+            printf("test malloc error!\n");
+            return -1;
+        }
+        makeFrame(point, size);
+        buildKdTree(&tree, (const double*)point, size);
+        for( s = 0; s < (int)(sizeof(test_sweep) / sizeof(test_sweep[0])) && !failed; s++ )
+        {
+            buildGrid(&grid, point, size, test_sweep[s], 2, 0);
+            for( i = 1; i <= size && !failed; i++ )
+            {
+                expectSize = searchGrid(&grid, point, i, test_sweep[s], expect, result);
+                resultSize = searchKdTree(&tree, (const double*)&point[i], test_sweep[s], i, result);
+                if( expectSize != resultSize || !sameList(expect, result, expectSize) )
+                {
+                    printf("kd-tree mismatch at point %d, eps %.2f\n", i, test_sweep[s]);
+                    failed = 1;
+                }
+            }
+        }
+        destroyGrid(&grid);
+        destroyKdTree(&tree);
+        free(point);
+        free(expect);
+        free(result);
+        return failed ? -1 : 0;
+    }
+
+    /*
+     * the ring queue hands the ids back in the order they went in, through the burst and drain of an expansion
+     * */
+    static int testRingQueue()
+    {
+        RingQueue ring;
+        int i, next = 1, id;
+        if( initialQueue(&ring, TEST_QUEUE_POINTS + 1) != 0 )
+        {
+            printf("test malloc error!\n");
+            return -1;
+        }
+        for( i = 1; i <= 64; i++ )
+            insertQueue(&ring, i);
+        for( i = 65; !isEmptyQueue(&ring); next++ )
+        {
+            deleteQueue(&ring, &id);
+            if( id != next )
+            {
+                printf("queue gives %d instead of %d\n", id, next);
+                destroyQueue(&ring);
+                return -1;
+            }
+            if( i <= TEST_QUEUE_POINTS )
+                insertQueue(&ring, i++);
+        }
+        destroyQueue(&ring);
+        if( next != TEST_QUEUE_POINTS + 1 )
+        {
+            printf("queue gives %d ids instead of %d\n", next - 1, TEST_QUEUE_POINTS);
+            return -1;
+        }
+        return 0;
+    }
+
+    /*
+     * ordered seeds give the same labels when a frame is clustered again
+     * */
+    static int testOrderedSeeds()
+    {
+        int s, clusters, failed = 0;
+        for( s = 0; s < (int)(sizeof(test_size) / sizeof(test_size[0])) && !failed; s++ )
+        {
+            int size = test_size[s];
+            Point* frame = (Point*)malloc(sizeof(Point) * (size + 1));
+            int* first = (int*)malloc(sizeof(int) * size);
+            dbscan_ctx* ctx = dbscan_ctx_create(size, TEST_NEIGHBORHOOD, TEST_MINPTS);
+            if( !frame || !first || !ctx )
+            {
+                printf("test malloc error!\n");
+                return -1;
+            }
+            ctx->seedMode = DBSCAN_SEED_ORDERED;
+            makeFrame(frame, size);
+            clusters = dbscan_ctx_run(ctx, frame + 1, size);
+            memcpy(first, dbscan_ctx_results(ctx, NULL), sizeof(int) * size);
+            if( dbscan_ctx_run(ctx, frame + 1, size) != clusters
+                    || memcmp(first, dbscan_ctx_results(ctx, NULL), sizeof(int) * size) != 0 )
+            {
+                printf("ordered seeds not reproducible at %d points\n", size);
+                failed = 1;
+            }
+            dbscan_ctx_destroy(ctx);
+            free(first);
+            free(frame);
+        }
+        return failed ? -1 : 0;
+    }
+
+    /*
+     * the labels of the parallel neighbor search are those of the serial one
+     * */
+    static int testThreads()
+    {
+        int size = TEST_THREAD_SIZE;
+        Point* frame = (Point*)malloc(sizeof(Point) * (size + 1));
+        int* serial = (int*)malloc(sizeof(int) * size);
+        dbscan_ctx* ctx = dbscan_ctx_create(size, TEST_NEIGHBORHOOD, TEST_MINPTS);
+        int t, failed = 0;
+        if( !frame || !serial || !ctx )
+        {
+            printf("test malloc error!\n");
+            return -1;
+        }
+        ctx->seedMode = DBSCAN_SEED_ORDERED;
+        makeFrame(frame, size);
+        dbscan_ctx_run(ctx, frame + 1, size);
+        memcpy(serial, dbscan_ctx_results(ctx, NULL), sizeof(int) * size);
+        for( t = 0; t < (int)(sizeof(test_threads) / sizeof(test_threads[0])) && !failed; t++ )
+        {
+            dbscan_ctx_set_threads(ctx, test_threads[t]);
+            dbscan_ctx_run(ctx, frame + 1, size);
+            if( memcmp(serial, dbscan_ctx_results(ctx, NULL), sizeof(int) * size) != 0 )
+            {
+                printf("%d threads differ from the serial labels at %d points\n", test_threads[t], size);
+                failed = 1;
+            }
+        }
+        dbscan_ctx_destroy(ctx);
+        free(serial);
+        free(frame);
+        return failed ? -1 : 0;
+    }
+
+    /*
+     * the union-find labels of @ctx against the BFS labels @bfs of the same frame:
+     * every core in the same cluster, every border point in the cluster of one of its cores
+     * */
+    static int sameUpToBorder(const dbscan_ctx* ctx, const int* bfs)
+    {
+        const CoreObject* coreObject_Collection = ctx->coreObject_Collection;
+        const int* cluster = dbscan_ctx_results(ctx, NULL);
+        int i, k, j, found;
+        for( i = 1; i <= ctx->data_size; i++ )
+        {
+            if( coreObject_Collection[i].coreObjectID != 0 || cluster[i - 1] == 0 )
+            {
+                if( cluster[i - 1] != bfs[i - 1] )
+                    return 0;
+                continue;
+            }
+            found = 0;
+            for( k = 1; k <= coreObject_Collection[i].reachableSize; k++ )
+            {
+                j = coreObject_Collection[i].directlyDensityReachable[k];
+                if( coreObject_Collection[j].coreObjectID != 0 && cluster[j - 1] == cluster[i - 1] )
+                    found = 1;
+            }
+            if( !found || bfs[i - 1] == 0 )
+                return 0;
+        }
+        return 1;
+    }
+
+    /*
+     * DBSCAN_LABEL_UNION on 1 to 8 threads against the BFS of the same frame
+     * */
+    static int testUnion()
+    {
+        int size = TEST_THREAD_SIZE;
+        Point* frame = (Point*)malloc(sizeof(Point) * (size + 1));
+        int* bfs = (int*)malloc(sizeof(int) * size);
+        dbscan_ctx* ctx = dbscan_ctx_create(size, TEST_NEIGHBORHOOD, TEST_MINPTS);
+        int t, threads, failed = 0;
+        if( !frame || !bfs || !ctx )
+        {
+            printf("test malloc error!\n");
+            return -1;
+        }
+        ctx->seedMode = DBSCAN_SEED_ORDERED;
+        makeFrame(frame, size);
+        dbscan_ctx_run(ctx, frame + 1, size);
+        memcpy(bfs, dbscan_ctx_results(ctx, NULL), sizeof(int) * size);
+        ctx->labelMode = DBSCAN_LABEL_UNION;
+        for( t = 0; t <= (int)(sizeof(test_threads) / sizeof(test_threads[0])) && !failed; t++ )
+        {
+            threads = t == 0 ? 1 : test_threads[t - 1];
+            dbscan_ctx_set_threads(ctx, threads);
+            dbscan_ctx_run(ctx, frame + 1, size);
+            if( !sameUpToBorder(ctx, bfs) )
+            {
+                printf("union-find labels differ from the BFS at %d points, %d threads\n", size, threads);
+                failed = 1;
+            }
+        }
+        dbscan_ctx_destroy(ctx);
+        free(bfs);
+        free(frame);
+        return failed ? -1 : 0;
+    }
+
+    /*
+     * every distance kernel finds the points of the plain test, and builds the graph of the scalar one
+     * */
+    static int testKernel()
+    {
+        PointStore store;
+        int* hit = (int*)malloc(sizeof(int) * TEST_KERNEL_SIZE);
+        int* expect = (int*)malloc(sizeof(int) * TEST_KERNEL_SIZE);
+        int size = test_size[2];
+        Point* point = (Point*)malloc(sizeof(Point) * (size + 1));
+        int* reference = NULL;
+        int level, k, hits, expectSize = 0, edges = 0, failed = 0;
+        double eps = TEST_NEIGHBORHOOD * 4;
+        GridIndex grid;
+        NeighborGraph graph;
+        if( !hit || !expect || !point || initialPointStore(&store, TEST_KERNEL_SIZE, 2) != 0
+                || initialGrid(&grid, size) != 0 || initialGraph(&graph, size) != 0 )
+        {
+            printf("test malloc error!\n");
+            return -1;
+        }
+        for( k = 0; k < TEST_KERNEL_SIZE; k++ )
+        {
+            store.x[k] = uniform(-2, 2);
+            store.y[k] = uniform(-2, 2);
+            if( store.x[k] * store.x[k] + store.y[k] * store.y[k] <= eps * eps )
+                expect[expectSize++] = k;
+        }
+        makeFrame(point, size);
+        for( level = SIMD_SCALAR; level <= detectSimd() && !failed; level++ )
+        {
+            hits = selectRadiusKernel(level)(store.x, store.y, TEST_KERNEL_SIZE, 0, 0, eps * eps, hit);
+            if( hits != expectSize || !sameList(expect, hit, hits) )
+            {
+                printf("%s kernel finds %d points instead of %d\n", test_simd_name[level], hits, expectSize);
+                failed = 1;
+                break;
+            }
+
+            grid.kernel = selectRadiusKernel(level);
+            buildGrid(&grid, point, size, TEST_NEIGHBORHOOD, 2, 0);
+            buildGraph(&graph, &grid, point, size, TEST_NEIGHBORHOOD);
+            if( level == SIMD_SCALAR )
+            {
+                edges = graph.offset[size + 1];
+                reference = (int*)malloc(sizeof(int) * (edges + size + 2));
+                if( !reference )
+                {
+                    printf("test malloc error!\n");
+                    return -1;
+                }
+                memcpy(reference, graph.offset, sizeof(int) * (size + 2));
+                memcpy(reference + size + 2, graph.neighbor, sizeof(int) * edges);
+            }
+            else if( memcmp(reference + 1, graph.offset + 1, sizeof(int) * (size + 1)) != 0
+                    || memcmp(reference + size + 2 + 1, graph.neighbor + 1, sizeof(int) * (edges - 1)) != 0 )
+            {
+                printf("%s kernel changes the graph at %d points\n", test_simd_name[level], size);
+                failed = 1;
+            }
+        }
+        free(reference);
+        destroyGraph(&graph);
+        destroyGrid(&grid);
+        destroyPointStore(&store);
+        free(point);
+        free(expect);
+        free(hit);
+        return failed ? -1 : 0;
+    }
+
+    /*
+     * a point cloud written and mapped again has the same points and timestamp
+     * */
+    static int testCloud()
+    {
+        float xyz[3 * 100];
+        PointCloud cloud;
+        int i, failed;
+        for( i = 0; i < 3 * 100; i++ )
+            xyz[i] = (float)uniform(-50, 50);
+        if( writeCloud(TEST_CLOUD_PATH, xyz, 3, 100, 1234567) != 0 )
+            return -1;
+        if( openCloud(&cloud, TEST_CLOUD_PATH) != 0 )
+        {
+            printf("%s is not a point cloud\n", TEST_CLOUD_PATH);
+            remove(TEST_CLOUD_PATH);
+            return -1;
+        }
+        failed = cloud.header->count != 100 || cloud.header->dim != 3 || cloud.header->timestamp != 1234567
+                || memcmp(cloud.xyz, xyz, sizeof(xyz)) != 0;
+        if( failed )
+            printf("the point cloud read back differs from the one written\n");
+        closeCloud(&cloud);
+        remove(TEST_CLOUD_PATH);
+        return failed ? -1 : 0;
+    }
+
+    /*
+     * the 3D grid with the anisotropic metric against the full scan, with every 3D kernel
+     * */
+    static int testDimensions()
+    {
+        int size = test_size[2];
+        Point* point = (Point*)malloc(sizeof(Point) * (size + 1));
+        int* expect = (int*)malloc(sizeof(int) * (size + 1));
+        int* result = (int*)malloc(sizeof(int) * (size + 1));
+        int* scratch = (int*)malloc(sizeof(int) * (size + 1));
+        int level, i, expectSize, resultSize, failed = 0;
+        GridIndex grid;
+        if( !point || !expect || !result || !scratch || initialGrid(&grid, size) != 0 )
+        {
+            printf("test malloc error!\n");
+            return -1;
+        }
+        makeStackedFrame(point, size);
+        for( level = SIMD_SCALAR; level <= detectSimd() && !failed; level++ )
+        {
+            grid.kernel3 = selectRadiusKernel3(level);
+            buildGrid(&grid, point, size, TEST_NEIGHBORHOOD, 3, TEST_NEIGHBORHOOD_Z);
+            for( i = 1; i <= size && !failed; i++ )
+            {
+                expectSize = searchAll(point, size, i, TEST_NEIGHBORHOOD, grid.scaleZ, expect);
+                resultSize = searchGrid(&grid, point, i, TEST_NEIGHBORHOOD, result, scratch);
+                if( expectSize != resultSize || !sameList(expect, result, expectSize) )
+                {
+                    printf("3D %s grid mismatch at point %d of %d\n", test_simd_name[level], i, size);
+                    failed = 1;
+                }
+            }
+        }
+        destroyGrid(&grid);
+        free(point);
+        free(expect);
+        free(result);
+        free(scratch);
+        return failed ? -1 : 0;
+    }
+
+    //layer of the range image of @point, as buildRangeImage finds it
+    static int rangeLayer(const RangeImage* range, const Point* point)
+    {
+        int layer = (int)floor((atan2(point->z, hypot(point->x, point->y)) - range->elevationMin) / range->layerSpacing);
+        return layer < 0 ? 0 : layer >= range->layers ? range->layers - 1 : layer;
+    }
+
+    static int rangeRoot(int* parent, int x)
+    {
+        while( parent[x] != x )
+            x = parent[x] = parent[parent[x]];
+        return x;
+    }
+
+    /*
+     * the range image against every pair of a frame: two points of the same or the next layer within the
+     * neighborhood are connected, then the sets of MinPts numbered in the order of their smallest point
+     * */
+    static int compareRangePairs(dbscan_ctx* ctx, const Point* point, int size)
+    {
+        int* parent = (int*)malloc(sizeof(int) * (size + 1));
+        int* expect = (int*)calloc(size + 1, sizeof(int));
+        int* layer = (int*)malloc(sizeof(int) * (size + 1));
+        double eps2 = ctx->neighborhood * ctx->neighborhood, dx, dy, dz;
+        int i, j, a, b, count = 0, clusters, failed = 0;
+        const int* cluster;
+        if( !parent || !expect || !layer )
+        {
+            printf("test malloc error!\n");
+            return -1;
+        }
+        clusters = dbscan_ctx_run(ctx, point + 1, size);
+        cluster = dbscan_ctx_results(ctx, NULL);
+        for( i = 1; i <= size; i++ )
+        {
+            parent[i] = i;
+            layer[i] = rangeLayer(&ctx->range, &point[i]);
+        }
+        for( i = 1; i <= size; i++ )
+        {
+            for( j = i + 1; j <= size; j++ )
+            {
+                dx = point[i].x - point[j].x;
+                dy = point[i].y - point[j].y;
+                dz = point[i].z - point[j].z;
+                if( abs(layer[i] - layer[j]) > 1 || dx * dx + dy * dy + dz * dz > eps2 )
+                    continue;
+                a = rangeRoot(parent, i);
+                b = rangeRoot(parent, j);
+                parent[a > b ? a : b] = a > b ? b : a;
+            }
+        }
+        for( i = 1; i <= size; i++ )
+            expect[rangeRoot(parent, i)]++;
+        for( i = 1; i <= size; i++ )
+        {
+            if( rangeRoot(parent, i) == i )
+                expect[i] = expect[i] >= ctx->MinPts ? ++count : 0;
+            else
+                expect[i] = expect[rangeRoot(parent, i)];
+        }
+        for( i = 1; i <= size && !failed; i++ )
+        {
+            if( expect[i] != cluster[i - 1] )
+            {
+                printf("range image puts point %d of %d in cluster %d instead of %d\n", i, size, cluster[i - 1], expect[i]);
+                failed = 1;
+            }
+        }
+        if( !failed && clusters != count )
+        {
+            printf("range image finds %d clusters instead of %d\n", clusters, count);
+            failed = 1;
+        }
+        free(parent);
+        free(expect);
+        free(layer);
+        return failed ? -1 : 0;
+    }
+
+    /*
+     * a pair @angle apart and 0.2 m apart in range, the near one at TEST_RANGE_NEAR, both on one layer or
+     * the far one on the next, straddling the bins of the pair both ways: near on the left or on the right,
+     * and near first or second in the frame
+     * */
+    static int compareRangePair(dbscan_ctx* ctx, double angle, int nextLayer)
+    {
+        Point pair[3];
+        double range[2] = {TEST_RANGE_NEAR, TEST_RANGE_NEAR + 0.2}, elevation, azimuth;
+        int side, order, k;
+        for( side = -1; side <= 1; side += 2 )
+        {
+            for( order = 0; order < 2; order++ )
+            {
+                for( k = 0; k < 2; k++ )
+                {
+                    azimuth = 0.3 + (k == 1 ? side * angle : 0);
+                    elevation = (k == 1 && nextLayer ? 1.2 : 0.4) * M_PI / 180;
+                    pair[1 + (k ^ order)].x = range[k] * cos(azimuth);
+                    pair[1 + (k ^ order)].y = range[k] * sin(azimuth);
+                    pair[1 + (k ^ order)].z = range[k] * tan(elevation);
+                }
+                if( compareRangePairs(ctx, pair, 2) != 0 )
+                {
+                    printf("near and far point %.2f degrees apart, side %d, order %d, next layer %d\n",
+                            angle * 180 / M_PI, side, order, nextLayer);
+                    return -1;
+                }
+            }
+        }
+        return 0;
+    }
+
+    /*
+     * the range image pairs two points whichever of them its scan starts from:
+     *  near and far points straddling bins, just within and just beyond the neighborhood,
+     *  then a 3D frame beyond TEST_RANGE_NEAR against every pair
+     * */
+    static int testRange()
+    {
+        int size = TEST_RANGE_SIZE;
+        Point* point = (Point*)malloc(sizeof(Point) * (size + 1));
+        dbscan_ctx* ctx = dbscan_ctx_create(size, TEST_NEIGHBORHOOD, 2);
+        int i, failed;
+        if( !point || !ctx )
+        {
+            printf("test malloc error!\n");
+            return -1;
+        }
+        ctx->clusterMode = DBSCAN_CLUSTER_RANGE;
+        dbscan_ctx_set_dimensions(ctx, 3, 0);
+        failed = compareRangePair(ctx, 2.2 * M_PI / 180, 0) != 0 || compareRangePair(ctx, 2.2 * M_PI / 180, 1) != 0
+                || compareRangePair(ctx, 2.6 * M_PI / 180, 0) != 0;
+
+        ctx->MinPts = TEST_MINPTS;
+        makeFrame(point, size);
+        for( i = 1; i <= size; i++ )
+        {
+            point[i].x += TEST_RANGE_NEAR;
+            point[i].z = hypot(point[i].x, point[i].y) * tan(uniform(-1.6, 1.6) * M_PI / 180);
+        }
+        failed = failed || compareRangePairs(ctx, point, size) != 0;
+        dbscan_ctx_destroy(ctx);
+        free(point);
+        return failed ? -1 : 0;
+    }
+
+typedef struct TestCase
+{
+    const char* name;
+    int (*run)(void);
+}TestCase;
+
+static const TestCase test_case[] = {
+    {"neighbor", testNeighbor},
+    {"kdtree", testKdTree},
+    {"queue", testRingQueue},
+    {"seeds", testOrderedSeeds},
+    {"threads", testThreads},
+    {"union", testUnion},
+    {"kernel", testKernel},
+    {"cloud", testCloud},
+    {"dimensions", testDimensions},
+    {"range", testRange},
+};
+
+//every test, or those named on the command line; the exit status is the number that failed
+int main(int argc, char* argv[])
+{
+    int t, a, selected, failed = 0;
+    srand(1);
+    for( t = 0; t < (int)(sizeof(test_case) / sizeof(test_case[0])); t++ )
+    {
+        for( a = 1, selected = argc == 1; a < argc && !selected; a++ )
+            selected = strcmp(argv[a], test_case[t].name) == 0;
+        if( !selected )
+            continue;
+        if( test_case[t].run() != 0 )
+        {
+            printf("%-12s FAILED\n", test_case[t].name);
+            failed++;
+        }
+        else
+            printf("%-12s ok\n", test_case[t].name);
+    }
+    return failed;
+}
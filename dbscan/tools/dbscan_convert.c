@@ -0,0 +1,65 @@
+#include"dbscan.h"
+
+    /*
+     * convert a text file of "x\ty" or "x\ty\tz" lines into a point cloud for dbscan
+     *  the dimension is taken from the first line, every line must have the same
+     * */
+int main(int argc, char* argv[])
+{
+    FILE* fread_text;
+    char line[256];
+    float* xyz = NULL;
+    double value[3];
+    int capacity = 0, count = 0, dim = 0, size;
+    uint64_t timestamp = 0;
+
+    if( argc != 3 && argc != 4 )
+    {
+        printf("usage: %s <text file> <point cloud> [timestamp in us]\n", argv[0]);
+        exit(0);
+    }
+    if( argc == 4 )
+        timestamp = strtoull(argv[3], NULL, 10);
+    if( NULL == (fread_text = fopen(argv[1], "r")))
+    {
+        printf("open file(%s) error!\n", argv[1]);
+        exit(0);
+    }
+    while( fgets(line, sizeof(line), fread_text) )
+    {
+        size = sscanf(line, "%lf %lf %lf", &value[0], &value[1], &value[2]);
+        if( size <= 0 )
+            continue;           //blank line
+        if( dim == 0 )
+            dim = size;
+        if( size < 2 || size != dim )
+        {
+            printf("line %d: %d values instead of %d\n", count + 1, size, dim < 2 ? 2 : dim);
+            exit(0);
+        }
+        if( count == capacity )
+        {
+            capacity = capacity ? capacity * 2 : 1024;
+            xyz = (float*)realloc(xyz, sizeof(float) * dim * capacity);
+            if( !xyz )
+            {
+                printf("xyz realloc error: %d\n", capacity);
+                exit(0);
+            }
+        }
+        for( size = 0; size < dim; size++ )
+            xyz[count * dim + size] = (float)value[size];
+        count++;
+    }
+    fclose(fread_text);
+    if( count == 0 )
+    {
+        printf("no point in %s\n", argv[1]);
+        exit(0);
+    }
+    if( writeCloud(argv[2], xyz, dim, count, timestamp) != 0 )
+        exit(0);
+    printf("%d points of dimension %d written to %s\n", count, dim, argv[2]);
+    free(xyz);
+    return 0;
+}
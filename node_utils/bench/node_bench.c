@@ -0,0 +1,588 @@
+#define _GNU_SOURCE
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<math.h>
+#include<time.h>
+#include<unistd.h>
+#include<pthread.h>
+#include<sched.h>
+#include<errno.h>
+#include<arpa/inet.h>
+#include<sys/socket.h>
+#include"ps_wire.h"
+#include"ps_log.h"
+#include"ps_track.h"
+#include"ps_brake.h"
+#include"ps_rt.h"
+#include"ps_lane.h"
+#include"ps_latency.h"
+
+#define BENCH_OBJECT_POINTS 40      //points of a record on the wire
+#define BENCH_WIRE_FRAMES   2000
+#define BENCH_LOG_FRAMES    20
+#define BENCH_LOG_PATH      "/tmp/node_bench.log"
+#define BENCH_TRACK_MESSAGES 2000
+#define BENCH_TRACK_PATH    2.0     //width of the path of the car, as CAR_WIDTH of the nodes
+#define BENCH_TRACK_CHURN   0.05    //share of the objects replaced by a new id every message
+#define BENCH_BRAKE_EGO     15.0    //speed of the car, meters per second
+#define BENCH_PERIOD_NS     1000000 //period of the deadline loop
+#define BENCH_PERIOD_CYCLES 2000
+#define BENCH_PERIOD_LOADS  64      //spinning threads at most, one per cpu
+#define BENCH_LANE_FRAMES   2000
+#define BENCH_LANE_WIDTH    3.5     //of the track between the cones
+#define BENCH_LANE_NOISE    0.03    //of the cone positions, meters
+#define BENCH_LANE_KNOCKED  0.1     //share of the cones moved off the boundary, 0.5 to 1.5 meters
+
+static const int bench_wire_records[] = {10, 100, 500};
+static const char* bench_wire_mode[] = {"sendmmsg", "sendto"};
+static const int bench_log_records[] = {10, 100, 1000, 4000};
+static const int bench_track_objects[] = {16, 64, 256};
+static const int bench_brake_objects[] = {16, 128, 256};
+static const int bench_brake_path[] = {BRAKE_PATH_OBJECTS, TRACK_OBJECTS};
+static const int bench_lane_cones[] = {20, 60, 200, 1000};
+
+    /*
+     * monotonic time in milliseconds
+     * */
+    static double nowMs()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+    }
+
+    static double uniform(double low, double high)
+    {
+        return low + (high - low) * rand() / (double)RAND_MAX;
+    }
+
+    //read everything waiting on @fd, return the number of datagrams
+    static long drainSocket(int fd, unsigned char* datagram)
+    {
+        long count = 0;
+
+        while( recv(fd, datagram, WIRE_DATAGRAM_SIZE, MSG_DONTWAIT) >= 0 )
+            count++;
+        return count;
+    }
+
+    static void benchWire()
+    {
+        unsigned char datagram[WIRE_DATAGRAM_SIZE];
+        WireRecord* record = (WireRecord*)calloc(500, sizeof(WireRecord));
+        struct sockaddr_in address;
+        socklen_t length = sizeof(address);
+        int receiver, rcvbuf = 1 << 22;
+        double ms[2], start;
+        unsigned long calls[2];
+        long received[2];
+        WireSender sender;
+        WireFrame frame;
+        int s, m, f, i;
+
+        //a receiver on the loopback, drained after every frame so nothing is dropped
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if( !record || (receiver = socket(AF_INET, SOCK_DGRAM, 0)) < 0
+                || bind(receiver, (struct sockaddr*)&address, sizeof(address)) != 0
+                || getsockname(receiver, (struct sockaddr*)&address, &length) != 0 )
+        {
+            printf("bench socket error!\n");
+            exit(0);
+        }
+        setsockopt(receiver, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        for( i = 0; i < 500; i++ )
+        {
+            record[i].id = (uint64_t)i + 1;
+            record[i].points = BENCH_OBJECT_POINTS;
+            record[i].centroid[0] = (float)i;
+            record[i].max[0] = (float)i + 1;
+        }
+
+        printf("\nUDP loopback, %d frames, time to encode and send a frame\n", BENCH_WIRE_FRAMES);
+        printf("%8s %10s | %10s %12s | %10s %12s | %9s\n", "records", "datagrams", "sendmmsg", "calls/frame",
+                "sendto", "calls/frame", "speedup");
+        for( s = 0; s < (int)(sizeof(bench_wire_records) / sizeof(bench_wire_records[0])); s++ )
+        {
+            for( m = 0; m < 2; m++ )
+            {
+                if( openWireSender(&sender, "127.0.0.1", ntohs(address.sin_port), 1) != 0 )
+                    exit(0);
+                sender.mode = m == 0 ? WIRE_SEND_BATCH : WIRE_SEND_SINGLE;
+                frame.kind = WIRE_KIND_CLUSTERS;
+                frame.timestamp = 0;
+                frame.record = record;
+                frame.count = bench_wire_records[s];
+                ms[m] = 0;
+                received[m] = 0;
+                for( f = 0; f < BENCH_WIRE_FRAMES; f++ )
+                {
+                    frame.sequence = (uint32_t)f;
+                    start = nowMs();
+                    if( sendWireFrame(&sender, &frame) != 0 )
+                    {
+                        printf("bench send error!\n");
+                        exit(0);
+                    }
+                    ms[m] += nowMs() - start;
+                    received[m] += drainSocket(receiver, datagram);
+                }
+                calls[m] = sender.stats.calls;
+                if( sender.mode != (m == 0 ? WIRE_SEND_BATCH : WIRE_SEND_SINGLE) )
+                    printf("sendmmsg is not available, both rows are sendto\n");
+                closeWireSender(&sender);
+            }
+            printf("%8d %10d | %8.2fus %12.1f | %8.2fus %12.1f | %8.2fx\n", bench_wire_records[s],
+                    wireFragments(bench_wire_records[s]), ms[0] * 1000 / BENCH_WIRE_FRAMES,
+                    (double)calls[0] / BENCH_WIRE_FRAMES, ms[1] * 1000 / BENCH_WIRE_FRAMES,
+                    (double)calls[1] / BENCH_WIRE_FRAMES, ms[1] / ms[0]);
+            for( m = 0; m < 2; m++ )
+                if( received[m] != (long)BENCH_WIRE_FRAMES * wireFragments(bench_wire_records[s]) )
+                    printf("%ld datagrams received with %s\n", received[m], bench_wire_mode[m]);
+        }
+        close(receiver);
+        free(record);
+    }
+
+    //one line per object as the nodes log them, the same arguments both ways
+    #define BENCH_LOG_FORMAT "id 0x%016llX position %f %f %f size %f %f %f velocity %f %f %f course %f class %s quality %llu"
+    #define BENCH_LOG_ARGS(i) (unsigned long long)(i), (i) * 0.1, 1.5, 0.2, 4.5, 1.8, 1.5, -2.0, 0.0, 0.0, 0.01, "5: car", 80ULL
+
+    static void benchLog()
+    {
+        FILE* file;
+        Logger logger;
+        double ms[2], start;
+        unsigned long dropped = 0;
+        int s, f, i;
+
+        printf("\nlog of a frame of objects, %d frames, time spent in the callback\n", BENCH_LOG_FRAMES);
+        printf("%8s | %12s %10s | %12s %10s | %9s\n", "records", "fprintf", "/record", "async", "/record", "speedup");
+        for( s = 0; s < (int)(sizeof(bench_log_records) / sizeof(bench_log_records[0])); s++ )
+        {
+            //synchronous, as the nodes did with printf, to a file so the terminal does not count
+            if( (file = fopen(BENCH_LOG_PATH, "w")) == NULL )
+            {
+                printf("bench log open error!\n");
+                exit(0);
+            }
+            ms[0] = 0;
+            for( f = 0; f < BENCH_LOG_FRAMES; f++ )
+            {
+                start = nowMs();
+                for( i = 0; i < bench_log_records[s]; i++ )
+                    fprintf(file, BENCH_LOG_FORMAT "\n", BENCH_LOG_ARGS(i));
+                fflush(file);
+                ms[0] += nowMs() - start;
+            }
+            fclose(file);
+
+            //queued, the writer thread catches up between the frames
+            if( openLogger(&logger, BENCH_LOG_PATH, LOGGER_RECORDS) != 0 )
+                exit(0);
+            setLoggerLevel(&logger, LOGGER_DEBUG);
+            setLoggerCategories(&logger, LOGGER_ALL);
+            ms[1] = 0;
+            for( f = 0; f < BENCH_LOG_FRAMES; f++ )
+            {
+                start = nowMs();
+                for( i = 0; i < bench_log_records[s]; i++ )
+                    LOG_AT(&logger, LOGGER_DEBUG, LOGGER_OBJECTS, BENCH_LOG_FORMAT, BENCH_LOG_ARGS(i));
+                ms[1] += nowMs() - start;
+                while( __atomic_load_n(&logger.tail, __ATOMIC_RELAXED) != __atomic_load_n(&logger.head, __ATOMIC_ACQUIRE) )
+                    usleep(1000);
+            }
+            dropped += logger.dropped;
+            closeLogger(&logger);
+
+            printf("%8d | %10.1fus %8.2fus | %10.1fus %8.2fus | %8.2fx\n", bench_log_records[s],
+                    ms[0] * 1000 / BENCH_LOG_FRAMES, ms[0] * 1000 / BENCH_LOG_FRAMES / bench_log_records[s],
+                    ms[1] * 1000 / BENCH_LOG_FRAMES, ms[1] * 1000 / BENCH_LOG_FRAMES / bench_log_records[s], ms[0] / ms[1]);
+        }
+        if( dropped > 0 )
+            printf("%lu records dropped, the ring was full\n", dropped);
+        unlink(BENCH_LOG_PATH);
+    }
+
+    //objects of a message of the LUX, x y length width vx vy
+    typedef struct BenchObject
+    {
+        uint64_t id;
+        double position[2];
+        double size[2];
+        double velocity[2];
+    }BenchObject;
+
+    static void makeObject(BenchObject* object, uint64_t id)
+    {
+        object->id = id;
+        object->position[0] = uniform(-10, 80);
+        object->position[1] = uniform(-15, 15);
+        object->size[0] = uniform(0.5, 5);
+        object->size[1] = uniform(0.5, 2);
+        object->velocity[0] = uniform(-15, 5);
+        object->velocity[1] = uniform(-1, 1);
+    }
+
+    //the closest object in the path the way the handlers found it, a scan of the message
+    static int scanClosest(const BenchObject* object, int count, double* best)
+    {
+        int i, closest = -1;
+        double gap;
+        for( i = 0; i < count; i++ )
+        {
+            if( object[i].position[0] + object[i].size[0] / 2 <= 0 || fabs(object[i].position[1]) - object[i].size[1] / 2 >= BENCH_TRACK_PATH / 2 )
+                continue;
+            gap = object[i].position[0] - object[i].size[0] / 2;
+            gap = gap > 0 ? gap : 0;
+            if( closest < 0 || gap < *best )
+            {
+                closest = i;
+                *best = gap;
+            }
+        }
+        return closest;
+    }
+
+    /*
+     * closest object in the path: a scan of every message against the objects table
+     *  the scan runs once the message is complete, the table is updated object by object as the
+     *  message is read and answers in O(1)
+     * */
+    static void benchTrack()
+    {
+        BenchObject* object = (BenchObject*)malloc(sizeof(BenchObject) * bench_track_objects[2]);
+        ObjectTable table;
+        double ms[3], start, best = 0;
+        const void* volatile answer;    //kept so the scan and the lookup are not optimized out
+        uint64_t next;
+        int s, m, i;
+
+        if( !object || initialObjectTable(&table, TRACK_OBJECTS, BENCH_TRACK_PATH) != 0 )
+        {
+            printf("bench track malloc error!\n");
+            exit(0);
+        }
+        printf("\nclosest object in the path, %d messages, %.0f%% new ids per message\n", BENCH_TRACK_MESSAGES, BENCH_TRACK_CHURN * 100);
+        printf("%8s | %10s | %10s %10s %10s\n", "objects", "scan", "update", "/object", "decision");
+        for( s = 0; s < (int)(sizeof(bench_track_objects) / sizeof(bench_track_objects[0])); s++ )
+        {
+            next = 1;
+            for( i = 0; i < bench_track_objects[s]; i++ )
+                makeObject(&object[i], next++);
+            ms[0] = ms[1] = ms[2] = 0;
+            for( m = 0; m < BENCH_TRACK_MESSAGES; m++ )
+            {
+                //a period of 80ms, some objects leave and others come in
+                for( i = 0; i < bench_track_objects[s]; i++ )
+                {
+                    if( uniform(0, 1) < BENCH_TRACK_CHURN )
+                        makeObject(&object[i], next++);
+                    object[i].position[0] += object[i].velocity[0] * 0.08;
+                    object[i].position[1] += object[i].velocity[1] * 0.08;
+                }
+
+                start = nowMs();
+                answer = object + scanClosest(object, bench_track_objects[s], &best);
+                ms[0] += nowMs() - start;
+
+                start = nowMs();
+                beginObjectFrame(&table);
+                for( i = 0; i < bench_track_objects[s]; i++ )
+                    (void)updateObject(&table, object[i].id, object[i].position, object[i].size, object[i].velocity);
+                endObjectFrame(&table);
+                ms[1] += nowMs() - start;
+
+                start = nowMs();
+                answer = closestObject(&table);
+                ms[2] += nowMs() - start;
+            }
+            printf("%8d | %8.2fus | %8.2fus %8.3fus %8.3fus\n", bench_track_objects[s],
+                    ms[0] * 1000 / BENCH_TRACK_MESSAGES, ms[1] * 1000 / BENCH_TRACK_MESSAGES,
+                    ms[1] * 1000 / BENCH_TRACK_MESSAGES / bench_track_objects[s], ms[2] * 1000 / BENCH_TRACK_MESSAGES);
+        }
+        (void)answer;
+        if( table.dropped > 0 )
+            printf("%lu updates dropped, the table was full\n", table.dropped);
+        destroyObjectTable(&table);
+        free(object);
+    }
+
+    /*
+     * braking demand of a message with every object across the width of the path, the worst case of evaluateBrake
+     *  the default cap of the path against the whole table, and the messages that went over BRAKE_BUDGET_NS
+     * */
+    static void benchBrake()
+    {
+        BenchObject* object = (BenchObject*)malloc(sizeof(BenchObject) * bench_brake_objects[2]);
+        ObjectTable table;
+        BrakeEnvelope envelope;
+        BrakeDemand demand;
+        uint64_t sum, max;
+        long evaluated, path;
+        int s, b, m, i, truncated, over;
+
+        initialLatencyClock();
+        initialBrakeEnvelope(&envelope);
+        if( !object || initialObjectTable(&table, TRACK_OBJECTS, BENCH_TRACK_PATH) != 0 )
+        {
+            printf("bench brake malloc error!\n");
+            exit(0);
+        }
+        printf("\nbraking demand, every object across the path, %d messages at %.0f m/s, over the budget of %.1fus\n", BENCH_TRACK_MESSAGES, BENCH_BRAKE_EGO, BRAKE_BUDGET_NS / 1000.0);
+        printf("%8s %8s | %10s %10s %8s | %8s %9s %9s\n", "objects", "cap", "mean", "max", "over", "in path", "evaluated", "truncated");
+        for( s = 0; s < (int)(sizeof(bench_brake_objects) / sizeof(bench_brake_objects[0])); s++ )
+        {
+            for( b = 0; b < (int)(sizeof(bench_brake_path) / sizeof(bench_brake_path[0])); b++ )
+            {
+                envelope.pathObjects = bench_brake_path[b];
+                sum = max = 0;
+                evaluated = path = truncated = over = 0;
+                for( m = 0; m < BENCH_TRACK_MESSAGES; m++ )
+                {
+                    beginObjectFrame(&table);
+                    for( i = 0; i < bench_brake_objects[s]; i++ )
+                    {
+                        makeObject(&object[i], i + 1);
+                        object[i].position[1] = uniform(-BENCH_TRACK_PATH / 2, BENCH_TRACK_PATH / 2);
+                        (void)updateObject(&table, object[i].id, object[i].position, object[i].size, object[i].velocity);
+                    }
+                    endObjectFrame(&table);
+
+                    evaluateBrake(&envelope, &table, BENCH_BRAKE_EGO, &demand);
+                    sum += demand.elapsed;
+                    max = demand.elapsed > max ? demand.elapsed : max;
+                    evaluated += demand.evaluated;
+                    path += table.pathCount;
+                    truncated += demand.truncated;
+                    over += demand.overBudget;
+                }
+                printf("%8d %8d | %8.2fus %8.2fus %8d | %8.1f %9.1f %9d\n", bench_brake_objects[s], bench_brake_path[b],
+                        sum / 1000.0 / BENCH_TRACK_MESSAGES, max / 1000.0, over, (double)path / BENCH_TRACK_MESSAGES,
+                        (double)evaluated / BENCH_TRACK_MESSAGES, truncated);
+            }
+        }
+        destroyObjectTable(&table);
+        free(object);
+    }
+
+    /*
+     * boundaries of a track of cones on both sides, a drive where the heading and the middle drift
+     *  between messages; the fit of every level of the pass, then the error of the fitted offsets
+     *  without and with knocked cones, against the least squares of all the cones of a side
+     * */
+    static void benchLane()
+    {
+        double* x = (double*)malloc(sizeof(double) * bench_lane_cones[3]);
+        double* y = (double*)malloc(sizeof(double) * bench_lane_cones[3]);
+        double truth[LANE_SIDES], ms[3], error[2], worst, slope, middle, start, dx, d;
+        LaneEstimator lane;
+        LaneGate gate;
+        LaneSums sums[LANE_SIDES];
+        int s, k, f, i, side, level, levels = detectSimd() + 1, knocked;
+        unsigned long robust = 0, robusts;
+        unsigned int seed;
+
+        if( !x || !y || initialLaneEstimator(&lane, bench_lane_cones[0]) != 0 )
+        {
+            printf("bench lane malloc error!\n");
+            exit(0);
+        }
+        printf("\ntrack boundaries, %d messages, %.0f%% of the cones knocked in the last rows\n", BENCH_LANE_FRAMES, BENCH_LANE_KNOCKED * 100);
+        printf("%8s %7s | %10s %10s %10s | %8s | %10s %10s %10s\n", "cones", "knocked", "scalar", "sse2", "avx2",
+                "robust", "lsq err", "fit err", "fit max");
+        for( knocked = 0; knocked < 2; knocked++ )
+        {
+            for( s = 0; s < (int)(sizeof(bench_lane_cones) / sizeof(bench_lane_cones[0])); s++ )
+            {
+                ms[0] = ms[1] = ms[2] = 0;
+                error[0] = error[1] = worst = 0;
+                robusts = 0;
+                slope = middle = 0;
+                memset(&lane.gate, 0, sizeof(lane.gate));
+                lane.gate.range = LANE_RANGE;
+                lane.gate.lateral = LANE_LATERAL;
+                for( f = 0; f < BENCH_LANE_FRAMES; f++ )
+                {
+                    slope = fmin(0.1, fmax(-0.1, slope + uniform(-0.01, 0.01)));
+                    middle = fmin(0.5, fmax(-0.5, middle + uniform(-0.05, 0.05)));
+                    truth[LANE_LEFT] = middle + BENCH_LANE_WIDTH / 2;
+                    truth[LANE_RIGHT] = middle - BENCH_LANE_WIDTH / 2;
+                    for( i = 0; i < bench_lane_cones[s]; i++ )
+                    {
+                        side = i & 1;
+                        x[i] = 2 + (LANE_RANGE - 2) * (i / 2) / (bench_lane_cones[s] / 2);
+                        y[i] = slope * x[i] + truth[side] + uniform(-BENCH_LANE_NOISE, BENCH_LANE_NOISE);
+                        if( knocked && uniform(0, 1) < BENCH_LANE_KNOCKED )
+                            y[i] += (uniform(0, 1) < 0.5 ? -1 : 1) * uniform(0.5, 1.5);
+                    }
+
+                    //every level from the same gate and seed, the scalar one goes last and is kept
+                    gate = lane.gate;
+                    seed = lane.seed;
+                    for( level = levels - 1; level >= 0; level-- )
+                    {
+                        lane.gate = gate;
+                        lane.seed = seed;
+                        robust = lane.robust;
+                        lane.kernel = selectLaneKernel(level);
+                        start = nowMs();
+                        if( beginLane(&lane, bench_lane_cones[s]) != 0 )
+                        {
+                            printf("bench lane malloc error!\n");
+                            exit(0);
+                        }
+                        for( i = 0; i < bench_lane_cones[s]; i++ )
+                            addLaneCone(&lane, x[i], y[i]);
+                        fitLane(&lane);
+                        ms[level] += nowMs() - start;
+                    }
+                    robusts += lane.robust - robust;
+
+                    //the plain least squares of every cone of a side, what a knocked cone does to it
+                    for( side = 0; side < LANE_SIDES; side++ )
+                    {
+                        memset(&sums[side], 0, sizeof(sums[side]));
+                        for( i = side; i < bench_lane_cones[s]; i += 2 )
+                        {
+                            sums[side].n += 1;
+                            sums[side].x += x[i];
+                            sums[side].xx += x[i] * x[i];
+                            sums[side].y += y[i];
+                            sums[side].xy += x[i] * y[i];
+                        }
+                        dx = sums[side].n * sums[side].xx - sums[side].x * sums[side].x;
+                        d = (sums[side].n * sums[side].xy - sums[side].x * sums[side].y) / dx;
+                        error[0] += fabs((sums[side].y - d * sums[side].x) / sums[side].n - truth[side]);
+                        d = lane.line[side].valid ? fabs(lane.line[side].offset - truth[side]) : 1;
+                        error[1] += d;
+                        worst = d > worst ? d : worst;
+                    }
+                }
+                printf("%8d %6.0f%% |", bench_lane_cones[s], knocked ? BENCH_LANE_KNOCKED * 100 : 0);
+                for( k = 0; k < 3; k++ )
+                {
+                    if( k < levels )
+                        printf(" %8.2fus", ms[k] * 1000 / BENCH_LANE_FRAMES);
+                    else
+                        printf(" %10s", "-");
+                }
+                printf(" | %8lu | %8.2fcm %8.2fcm %8.2fcm\n", robusts,
+                        error[0] * 100 / BENCH_LANE_FRAMES / LANE_SIDES, error[1] * 100 / BENCH_LANE_FRAMES / LANE_SIDES, worst * 100);
+            }
+        }
+        destroyLaneEstimator(&lane);
+        free(x);
+        free(y);
+    }
+
+    static int period_load_quit;
+
+    //a thread spinning at the default priority on any cpu, whatever its creator was
+    static void* spinPeriodLoad(void* arg)
+    {
+        struct sched_param param;
+        cpu_set_t cpus;
+        volatile double x = 1;
+        int c;
+
+        (void)arg;
+        memset(&param, 0, sizeof(param));
+        (void)pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+        CPU_ZERO(&cpus);
+        for( c = 0; c < CPU_SETSIZE; c++ )
+            CPU_SET(c, &cpus);
+        (void)pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        while( !__atomic_load_n(&period_load_quit, __ATOMIC_ACQUIRE) )
+            x = x * 1.0000001 + 1e-9;
+        return NULL;
+    }
+
+    /*
+     * wakeup jitter of a deadline loop of waitRtPeriod, idle and with a spinning thread on every cpu
+     *  at the default priority, then SCHED_FIFO on cpu 0 as PS_RT=0 runs the control of the nodes,
+     *  when the limits allow it; the loop does no work, what is left is the scheduler
+     * */
+    static void benchPeriod()
+    {
+        pthread_t load[BENCH_PERIOD_LOADS];
+        RtConfig config = {1, 0, RT_PRIORITY};
+        RtPeriod period;
+        LatencySummary jitter;
+        struct sched_param param;
+        cpu_set_t cpus;
+        int loads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        int fifo, loaded, i, started;
+
+        loads = loads < 1 ? 1 : loads > BENCH_PERIOD_LOADS ? BENCH_PERIOD_LOADS : loads;
+        (void)sched_getaffinity(0, sizeof(cpus), &cpus);
+        initialLatencyClock();
+        printf("\ndeadline loop of %.1fms, %d periods, %d spinning threads under load\n", BENCH_PERIOD_NS / 1e6, BENCH_PERIOD_CYCLES, loads);
+        printf("%8s %8s | %10s %10s %10s %10s | %8s\n", "policy", "load", "mean", "p50", "p99", "max", "overruns");
+        for( fifo = 0; fifo < 2; fifo++ )
+        {
+            if( fifo && rtEnterThread(&config) != 0 )
+            {
+                printf("%8s | not permitted, %s\n", "fifo", strerror(errno));
+                break;
+            }
+            for( loaded = 0; loaded < 2; loaded++ )
+            {
+                started = 0;
+                __atomic_store_n(&period_load_quit, 0, __ATOMIC_RELEASE);
+                for( i = 0; loaded && i < loads; i++ )
+                    if( pthread_create(&load[started], NULL, spinPeriodLoad, NULL) == 0 )
+                        started++;
+
+                initialRtPeriod(&period, "bench period", BENCH_PERIOD_NS);
+                for( i = 0; i < BENCH_PERIOD_CYCLES; i++ )
+                    waitRtPeriod(&period);
+
+                __atomic_store_n(&period_load_quit, 1, __ATOMIC_RELEASE);
+                for( i = 0; i < started; i++ )
+                    (void)pthread_join(load[i], NULL);
+                summarizeLatency(&period.latency.stage[RT_JITTER], &jitter);
+                printf("%8s %8s | %8.1fus %8.1fus %8.1fus %8.1fus | %8lu\n", fifo ? "fifo" : "default", loaded ? "spin" : "idle",
+                        jitter.mean / 1000.0, jitter.p50 / 1000.0, jitter.p99 / 1000.0, jitter.max / 1000.0, period.overruns);
+            }
+        }
+
+        //back to the default priority on every cpu for what comes next
+        memset(&param, 0, sizeof(param));
+        (void)pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+        (void)sched_setaffinity(0, sizeof(cpus), &cpus);
+    }
+
+typedef struct BenchSection
+{
+    const char* name;
+    void (*run)(void);
+}BenchSection;
+
+static const BenchSection bench_section[] = {
+    {"wire", benchWire},
+    {"log", benchLog},
+    {"track", benchTrack},
+    {"brake", benchBrake},
+    {"lane", benchLane},
+    {"period", benchPeriod},
+};
+
+//every section, or those named on the command line
+int main(int argc, char* argv[])
+{
+    int b, a, selected;
+    for( b = 0; b < (int)(sizeof(bench_section) / sizeof(bench_section[0])); b++ )
+    {
+        for( a = 1, selected = argc == 1; a < argc && !selected; a++ )
+            selected = strcmp(argv[a], bench_section[b].name) == 0;
+        if( !selected )
+            continue;
+        //every section on the same numbers, whichever ran before
+        srand(1);
+        bench_section[b].run();
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+#ifndef PS_BRAKE_H_
+#define PS_BRAKE_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include"ps_track.h"
+
+//braking demand of the AEB from the objects in the path of the car, every message
+//
+//an object closing in at v with a gap d needs the car to shed v before d is gone, less a margin and
+//what the reaction time eats: a = v * v / (2 * room); with the speed of the car known, an oncoming
+//object only leaves the car its share of the gap to stop in, and a car standing still can not brake
+//away from anything. The worst object of the path sets the demand, evaluated soonest first then
+//closest first, then at most pathObjects others so the work of a message is bounded by a count and
+//not by the clock; budgetNs is what the evaluation is expected to take, not a limit, a message
+//over it is only flagged for the node to count
+#define BRAKE_DECEL_MAX         9.0         //meters per second^2 at a demand of 1
+#define BRAKE_DECEL_PARTIAL     3.0         //required deceleration that starts braking
+#define BRAKE_DECEL_FULL        6.0         //required deceleration braked at the full demand
+#define BRAKE_REACTION          0.3         //seconds before the brakes bite
+#define BRAKE_MARGIN            1.0         //meters kept to the object
+#define BRAKE_TTC_WARN          2.6         //seconds, a warning below
+#define BRAKE_PATH_OBJECTS      64          //objects of the path evaluated after the soonest and the closest
+#define BRAKE_BUDGET_NS         20000       //expected time of one evaluation, flagged when over
+
+#define BRAKE_EGO_TIMEOUT_US    200000      //four frames of the CAN, an older speed is unknown
+#define BRAKE_EGO_UNKNOWN       (-1.0)      //speed of the car when there is none, or when reversing
+
+enum
+{
+	BRAKE_NONE,
+	BRAKE_WARN,
+	BRAKE_PARTIAL,
+	BRAKE_FULL
+};
+
+typedef struct BrakeEnvelope
+{
+	double decelMax;
+	double decelPartial;
+	double decelFull;
+	double reaction;
+	double margin;
+	double ttcWarn;
+	int pathObjects;
+	uint64_t budgetNs;
+}BrakeEnvelope;
+
+typedef struct BrakeDemand
+{
+	int level;              //BRAKE_*
+	double demand;          //of decelMax, 0 to 1
+	double decel;           //required by the worst object, meters per second^2
+	double ttc;             //smallest of the path, TRACK_TTC_NONE when nothing closes in
+	uint64_t id;            //worst object, 0 when the path is clear
+	int evaluated;          //objects of the path evaluated
+	int truncated;          //the path had more than pathObjects others
+	uint64_t elapsed;       //nanoseconds
+	int overBudget;         //elapsed is over budgetNs
+}BrakeDemand;
+
+//speed of the car and the timestamp of its CAN frame, written by the CAN listener and read by the
+//control, a seqlock: @sequence is odd while the writer is in, a reader that saw it odd or changed reads again
+typedef struct EgoSpeed
+{
+	unsigned int sequence;
+	double speed;
+	uint64_t stamp;         //microseconds, 0 before the first frame
+}EgoSpeed;
+
+extern const char* const BRAKE_LEVEL_NAME[];
+
+void initialBrakeEnvelope(BrakeEnvelope*);
+double requiredDeceleration(const BrakeEnvelope*, const TrackedObject*, double);
+void evaluateBrake(const BrakeEnvelope*, const ObjectTable*, double, BrakeDemand*);
+int egoSpeedFromCan(const unsigned char*, unsigned long, double, double*);
+void initialEgoSpeed(EgoSpeed*);
+void publishEgoSpeed(EgoSpeed*, double, uint64_t);
+double egoSpeedAt(EgoSpeed*, uint64_t);
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef PS_LANE_H_
+#define PS_LANE_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+#include"dbscan_simd.h"
+
+//boundaries of the track from the cones of a message, a line y = slope * x + offset on each side
+//
+//the frame is the one of the objects, x ahead and y to the left. A cone is of the left boundary when
+//it is left of the middle of the last fit, of the right one otherwise, and of none when it is behind,
+//beyond LANE_RANGE or further than LANE_LATERAL off that middle; the first message splits on y = 0.
+//One pass over the cones sorts them and sums n, x, y, xx, xy and yy of both sides, without a branch
+//in the SSE2 and AVX2 kernels, and the least squares of a side come out of its sums. A side whose
+//residual is over LANE_FIT_RMS has a cone out of line, a knocked cone or another object, and is
+//fitted again by RANSAC: the line of two of its cones the others are closest to, within LANE_INLIER,
+//refitted by least squares on those
+#define LANE_RANGE          30.0    //meters ahead, further cones are not fitted
+#define LANE_LATERAL        5.0     //meters off the middle of the track, further is not a boundary
+#define LANE_MIN_CONES      3       //of a side for a line
+#define LANE_MIN_SPREAD     1.0     //variance of x of the cones of a side, meters^2, a line needs them along the track
+#define LANE_FIT_RMS        0.1     //meters, a least squares residual above is fitted again robustly
+#define LANE_INLIER         0.25    //meters off the robust line a cone is still of the boundary
+#define LANE_RANSAC_ROUNDS  32
+#define LANE_RANSAC_SPAN    1.0     //meters along x between the two cones of a candidate line
+#define LANE_SEED           12345u
+
+enum
+{
+	LANE_LEFT,
+	LANE_RIGHT,
+	LANE_SIDES
+};
+
+//which cones are fitted and on which side, the middle of the track and how far from it
+typedef struct LaneGate
+{
+	double slope;
+	double offset;
+	double range;
+	double lateral;
+}LaneGate;
+
+//sums of the least squares of a side
+typedef struct LaneSums
+{
+	double n;
+	double x;
+	double y;
+	double xx;
+	double xy;
+	double yy;
+}LaneSums;
+
+typedef struct LaneLine
+{
+	int valid;
+	double slope;
+	double offset;
+	double rms;             //residual of the cones the line is fitted on, meters
+	int cones;              //of the side
+	int inliers;            //the line is fitted on, the cones less the outliers
+	int robust;             //fitted again by RANSAC
+}LaneLine;
+
+//sort the cones 0..count-1 by the gate and add them to the sums of their side
+typedef void (*LaneKernel)(const double*, const double*, int, const LaneGate*, LaneSums*);
+
+typedef struct LaneEstimator
+{
+	int size;               //cones of the message
+	int capacity;           //grown by beginLane for a larger message, kept after
+	double* x;
+	double* y;
+	int* pick;              //cones of a side for RANSAC
+	LaneKernel kernel;
+	LaneGate gate;
+	LaneLine line[LANE_SIDES];
+	unsigned int seed;
+	unsigned long fits;     //messages fitted
+	unsigned long robust;   //sides fitted by RANSAC
+}LaneEstimator;
+
+extern const char* const LANE_SIDE_NAME[];
+
+int initialLaneEstimator(LaneEstimator*, int);
+void destroyLaneEstimator(LaneEstimator*);
+int beginLane(LaneEstimator*, int);
+void fitLane(LaneEstimator*);
+LaneKernel selectLaneKernel(int);
+
+//a cone of the message, at most the count of beginLane
+static inline void addLaneCone(LaneEstimator* lane, double x, double y)
+{
+	lane->x[lane->size] = x;
+	lane->y[lane->size] = y;
+	lane->size++;
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef PS_LATENCY_H_
+#define PS_LATENCY_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+
+//latency histograms of the processing stages of a node, in nanoseconds
+//
+//every thread owns a LatencyRecorder and is the only one writing it, so recording is a few plain
+//stores with no lock and no shared cache line; another thread may read it at any time for a report
+//
+//the LATENCY_* macros compile to nothing unless PS_LATENCY is defined; the clock is CLOCK_MONOTONIC,
+//the one under psync_get_monotonic_timestamp, or the TSC of the core with PS_LATENCY_RDTSC on x86
+#define LATENCY_MAX_STAGES  8
+#define LATENCY_SUB_BITS    4                       //16 buckets per power of two, 6% resolution
+#define LATENCY_SUB         (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_BITS    40                      //2^40 ns, about 18 minutes, larger goes in the last bucket
+#define LATENCY_BUCKETS     (LATENCY_SUB * (LATENCY_MAX_BITS - LATENCY_SUB_BITS + 1))
+
+//sensor stamps further than this from the clock of the host are from another clock, e.g. a replayed recording
+#define LATENCY_MAX_AGE_US  10000000ULL
+
+//time between two periodic reports of a node
+#define LATENCY_REPORT_NS   10000000000ULL
+
+typedef struct LatencyHistogram
+{
+	const char* name;
+	unsigned long count;
+	unsigned long skipped;  //sensor stamps not comparable to the clock of the host
+	uint64_t sum;
+	uint64_t max;
+	unsigned long bucket[LATENCY_BUCKETS];
+}LatencyHistogram;
+
+typedef struct LatencyRecorder
+{
+	const char* name;       //thread
+	int stages;
+	LatencyHistogram stage[LATENCY_MAX_STAGES];
+}LatencyRecorder;
+
+//percentiles of a histogram at the time of the report, in nanoseconds
+typedef struct LatencySummary
+{
+	unsigned long count;
+	unsigned long skipped;
+	uint64_t mean;
+	uint64_t p50;
+	uint64_t p99;
+	uint64_t max;
+}LatencySummary;
+
+void initialLatencyClock();
+uint64_t latencyNow();
+uint64_t latencyUtcUs();
+void initialLatency(LatencyRecorder*, const char*, const char* const*, int);
+void recordLatency(LatencyRecorder*, int, uint64_t);
+void recordSensorAge(LatencyRecorder*, int, uint64_t);
+void summarizeLatency(const LatencyHistogram*, LatencySummary*);
+int formatLatency(char*, size_t, const LatencyHistogram*);
+
+#ifdef PS_LATENCY
+#define LATENCY_CLOCK(t)                uint64_t t = 0
+#define LATENCY_START(t)                ((t) = latencyNow())
+#define LATENCY_LAP(r, stage, t)        do { uint64_t lap_ = latencyNow(); recordLatency((r), (stage), lap_ - (t)); (t) = lap_; } while( 0 )
+#define LATENCY_SINCE(r, stage, t)      recordLatency((r), (stage), latencyNow() - (t))
+#define LATENCY_KEEP(dst, t)            ((dst) = (t))
+#define LATENCY_SENSOR_AGE(r, stage, stamp)     recordSensorAge((r), (stage), (stamp))
+#else
+#define LATENCY_CLOCK(t)
+#define LATENCY_START(t)                ((void)0)
+#define LATENCY_LAP(r, stage, t)        ((void)0)
+#define LATENCY_SINCE(r, stage, t)      ((void)0)
+#define LATENCY_KEEP(dst, t)            ((void)0)
+#define LATENCY_SENSOR_AGE(r, stage, stamp)     ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef PS_LOG_H_
+#define PS_LOG_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include<time.h>
+#include<pthread.h>
+
+//asynchronous log of the nodes, so a message callback never formats nor writes
+//
+//logRecord only copies the printf format, which must be a string literal, and its arguments into a
+//fixed-size record of a lock-free ring; a background thread formats the records and writes them to
+//a file rotated every LOGGER_FILE_BYTES. A %s argument is kept as a pointer, so it must outlive the
+//record, e.g. a literal or a static table; %n and long double are not supported.
+//
+//the level and the categories are read from PS_LOG when the logger opens, "debug:objects,serial" or
+//"info", and again whenever the file named by PS_LOG_CONTROL changes, so they switch at runtime
+#define LOGGER_ENV          "PS_LOG"
+#define LOGGER_FILE_ENV     "PS_LOG_FILE"
+#define LOGGER_CONTROL_ENV  "PS_LOG_CONTROL"
+
+#define LOGGER_OFF      0
+#define LOGGER_ERROR    1
+#define LOGGER_WARN     2
+#define LOGGER_INFO     3
+#define LOGGER_DEBUG    4
+#define LOGGER_TRACE    5
+
+#define LOGGER_NODE     0x01u       //state of the node
+#define LOGGER_POINTS   0x02u       //lidar points
+#define LOGGER_OBJECTS  0x04u       //objects and clusters
+#define LOGGER_SERIAL   0x08u       //bytes to the serial device
+#define LOGGER_CONTROL  0x10u       //AEB control
+#define LOGGER_ALL      0x1fu
+
+#define LOGGER_MAX_ARGS     13          //a record is 128 bytes
+#define LOGGER_RECORDS      8192        //records the ring holds, a power of two
+#define LOGGER_FILE_BYTES   (16L << 20)
+#define LOGGER_FILES        4           //rotated files kept besides the current one
+#define LOGGER_IDLE_US      2000        //sleep of the writer when the ring is empty
+#define LOGGER_LINE_SIZE    1024
+
+typedef union LoggerArg
+{
+	long long i;
+	unsigned long long u;
+	double f;
+	const void* p;
+}LoggerArg;
+
+typedef struct LoggerRecord
+{
+	uint64_t time;          //nanoseconds since the epoch
+	const char* format;
+	uint8_t level;
+	uint8_t category;
+	uint8_t count;          //arguments
+	LoggerArg arg[LOGGER_MAX_ARGS];
+}LoggerRecord;
+
+//a record and the turn it belongs to, bounded multi-producer queue of Vyukov
+typedef struct LoggerSlot
+{
+	size_t sequence;
+	LoggerRecord record;
+}LoggerSlot;
+
+typedef struct Logger
+{
+	int level;              //LOGGER_*, changed at runtime, read relaxed
+	unsigned int categories;
+	LoggerSlot* slot;
+	size_t capacity;        //power of two
+	size_t tail __attribute__((aligned(64)));   //producers
+	unsigned long dropped;  //records lost because the ring was full
+	size_t head __attribute__((aligned(64)));   //writer thread only
+	unsigned long written;
+	FILE* file;
+	char path[256];         //"-" for stderr, never rotated
+	long bytes;
+	char control[256];
+	time_t controlTime;
+	pthread_t thread;
+	int running;
+	int quit;
+}Logger;
+
+int openLogger(Logger*, const char*, size_t);
+void closeLogger(Logger*);
+int parseLoggerConfig(Logger*, const char*);
+void setLoggerLevel(Logger*, int);
+void setLoggerCategories(Logger*, unsigned int);
+void logRecord(Logger*, int, unsigned int, const char*, ...) __attribute__((format(printf, 4, 5)));
+int formatLoggerRecord(char*, size_t, const LoggerRecord*);
+
+//the arguments are not even evaluated when the level or the category is off
+static inline int loggerEnabled(const Logger* logger, int level, unsigned int category)
+{
+	return logger != NULL && level <= __atomic_load_n(&logger->level, __ATOMIC_RELAXED)
+			&& (category & __atomic_load_n(&logger->categories, __ATOMIC_RELAXED)) != 0;
+}
+
+#define LOG_AT(logger, level, category, ...) \
+	do { if( loggerEnabled((logger), (level), (category)) ) logRecord((logger), (level), (category), __VA_ARGS__); } while( 0 )
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef PS_RT_H_
+#define PS_RT_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include"ps_latency.h"
+#include"ps_log.h"
+
+//real-time mode of the nodes, opt-in with PS_RT="cpu[:priority]", e.g. "3" or "3:80"
+//
+//the memory of the process is locked and prefaulted once, the thread doing the control is pinned to
+//the cpu and scheduled SCHED_FIFO, and it runs on a grid of deadlines instead of sleeping between
+//polls: waitRtPeriod sleeps to the next deadline of CLOCK_MONOTONIC and records how late it woke up
+//and how long the cycle before took, so the report shows whether the period holds under load.
+//The listeners hand their last message to that thread through an RtMailbox, which never blocks
+//nor allocates; a message the thread did not take in time is replaced by the next one, and one with
+//more items than a slot holds is cut to it and counted, the slot is sized once before the memory is locked
+#define RT_ENV              "PS_RT"
+#define RT_PRIORITY         80              //SCHED_FIFO priority when PS_RT does not give one
+#define RT_STACK_PREFAULT   (256 * 1024)    //stack touched once so no page fault is left on it
+#define RT_HEAP_PREFAULT    (8L << 20)      //heap touched once and kept by malloc
+
+typedef struct RtConfig
+{
+	int enabled;
+	int cpu;
+	int priority;
+}RtConfig;
+
+//stages of the report of an RtPeriod
+enum
+{
+	RT_JITTER,              //wakeup after the deadline
+	RT_CYCLE,               //wakeup to the next wait, the work of a period
+	RT_STAGES
+};
+
+typedef struct RtPeriod
+{
+	uint64_t periodNs;
+	uint64_t next;          //deadline of the next wakeup, CLOCK_MONOTONIC nanoseconds
+	uint64_t woke;          //wakeup of the current cycle
+	unsigned long cycles;
+	unsigned long overruns; //cycles whose work ran past the next deadline
+	unsigned long missed;   //deadlines skipped because of the overruns
+	LatencyRecorder latency;
+}RtPeriod;
+
+//triple buffer of the last message, one writer and one reader
+typedef struct RtMailbox
+{
+	void* slot[3];
+	size_t size;
+	int back;               //slot of the writer
+	int front;              //slot of the reader
+	int middle;             //slot exchanged, RT_MAILBOX_FRESH when the writer posted it since the last take
+	unsigned long posted;
+	unsigned long replaced; //posted before the reader took the one before
+	unsigned long truncated;//filled with more items than the slot holds, the others left out
+}RtMailbox;
+
+#define RT_MAILBOX_FRESH    4
+
+int rtConfigFromEnv(RtConfig*);
+int rtLockMemory();
+int rtEnterThread(const RtConfig*);
+void initialRtPeriod(RtPeriod*, const char*, uint64_t);
+void waitRtPeriod(RtPeriod*);
+int initialRtMailbox(RtMailbox*, size_t);
+void destroyRtMailbox(RtMailbox*);
+void postRtMailbox(RtMailbox*);
+void* takeRtMailbox(RtMailbox*);
+unsigned long fillRtMailbox(RtMailbox*, size_t, const void*, unsigned long, size_t);
+void logRtLockMemory(Logger*);
+void logRtEnterThread(Logger*, const RtConfig*);
+void logRtPeriod(Logger*, const RtPeriod*, const RtMailbox*);
+
+//slot the writer fills before postRtMailbox
+static inline void* rtMailboxBack(RtMailbox* mailbox)
+{
+	return mailbox->slot[mailbox->back];
+}
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef PS_TRACK_H_
+#define PS_TRACK_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+
+//objects of the sensor kept from one message to the next, keyed by their id
+//
+//a message is applied with beginObjectFrame, one updateObject per object and endObjectFrame, which
+//forgets the objects the message did not carry; every update moves its object in or out of the set
+//in the path of the car and keeps the closest and the soonest to collide of that set, so the AEB
+//reads its answer in O(1) whatever the number of objects
+#define TRACK_OBJECTS       256         //objects of a message, a larger one may drop new ids
+#define TRACK_TTC_NONE      1e9         //time to collision of an object that does not close in, seconds
+
+typedef struct TrackedObject
+{
+	uint64_t id;
+	uint32_t frame;         //frame of its last update
+	double x;               //center, meters, x ahead of the car
+	double y;
+	double length;          //size along x and y
+	double width;
+	double vx;              //velocity relative to the car, meters per second
+	double vy;
+	double gap;             //from the car to its near side, 0 once they touch
+	double ttc;             //@gap over the closing speed, TRACK_TTC_NONE if it does not close in
+	int live;               //index in @live
+	int path;               //index in @path, -1 when out of the path
+}TrackedObject;
+
+typedef struct ObjectTable
+{
+	double halfPath;        //half of the width of the path, the car plus its margin
+	uint32_t frame;
+	int capacity;           //objects of the pool, those of two messages
+	int mask;               //buckets - 1, twice as many buckets as objects
+	int* bucket;            //1 + pool index of the object hashed there, 0 when empty
+	TrackedObject* object;  //pool, an object keeps its index while it is tracked
+	int* live;              //pool indices of the tracked objects, @count of them
+	int count;
+	int* spare;             //pool indices free, @spares of them
+	int spares;
+	int* path;              //pool indices of the objects in the path, @pathCount of them
+	int pathCount;
+	int closest;            //pool index of the smallest @gap in the path, -1 when the path is clear
+	int soonest;            //pool index of the smallest @ttc in the path, -1 when the path is clear
+	unsigned long dropped;  //updates lost because the pool was full
+}ObjectTable;
+
+int initialObjectTable(ObjectTable*, int, double);
+void destroyObjectTable(ObjectTable*);
+void beginObjectFrame(ObjectTable*);
+const TrackedObject* updateObject(ObjectTable*, uint64_t, const double*, const double*, const double*);
+void endObjectFrame(ObjectTable*);
+
+//the answers of the AEB, NULL when the path is clear
+static inline const TrackedObject* closestObject(const ObjectTable* table)
+{
+	return table->closest < 0 ? NULL : &table->object[table->closest];
+}
+
+static inline const TrackedObject* soonestObject(const ObjectTable* table)
+{
+	return table->soonest < 0 ? NULL : &table->object[table->soonest];
+}
+
+#endif
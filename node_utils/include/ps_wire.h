@@ -0,0 +1,102 @@
+#ifndef PS_WIRE_H_
+#define PS_WIRE_H_
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include<netinet/in.h>
+
+//wire format of the clusters and objects the socket writers send over UDP, little-endian whatever the host
+//
+//a frame is sent as one or more datagrams, each one a header followed by up to WIRE_RECORDS_PER_DATAGRAM
+//records, so the receiver puts a frame back together from @sequence, @fragment and @fragments;
+//a frame without any record is still sent as one datagram so the receiver knows the road is clear
+#define WIRE_MAGIC          0x52575350u     //"PSWR" read as a little-endian word
+#define WIRE_VERSION        1
+
+#define WIRE_KIND_CLUSTERS  1
+#define WIRE_KIND_OBJECTS   2
+
+#define WIRE_HEADER_SIZE    32
+#define WIRE_RECORD_SIZE    64
+#define WIRE_DATAGRAM_SIZE  1472            //1500 byte ethernet MTU less the IPv4 and UDP headers
+#define WIRE_RECORDS_PER_DATAGRAM   ((WIRE_DATAGRAM_SIZE - WIRE_HEADER_SIZE) / WIRE_RECORD_SIZE)
+
+//header of a datagram, at byte 0
+typedef struct WireHeader
+{
+	uint32_t magic;         //0
+	uint16_t version;       //4
+	uint16_t kind;          //6, WIRE_KIND_*
+	uint32_t sequence;      //8, frame number of the sender, wraps around
+	uint16_t fragment;      //12, datagram of the frame, 0..fragments-1
+	uint16_t fragments;     //14, datagrams of the frame
+	uint64_t timestamp;     //16, microseconds, time of the scan
+	uint16_t records;       //24, records in this datagram
+	uint16_t recordSize;    //26, bytes of a record, later versions may only append fields
+	uint32_t total;         //28, records in the frame
+}WireHeader;
+
+//one cluster or object, record i of a datagram starts at byte WIRE_HEADER_SIZE + i * recordSize
+typedef struct WireRecord
+{
+	uint64_t id;            //0
+	uint32_t points;        //8, points of a cluster, 0 if unknown
+	uint32_t classification;    //12, 0 for a cluster
+	float centroid[3];      //16, meters
+	float min[3];           //28, bounding box
+	float max[3];           //40
+	float velocity[3];      //52, meters per second, 0 for a cluster
+}WireRecord;
+
+//a frame to send, @record may be NULL when the records are encoded one by one with encodeWireRecord
+typedef struct WireFrame
+{
+	uint16_t kind;
+	uint32_t sequence;
+	uint64_t timestamp;
+	const WireRecord* record;
+	int count;
+}WireFrame;
+
+#define WIRE_SEND_BATCH     0               //all the datagrams of a frame in one sendmmsg
+#define WIRE_SEND_SINGLE    1               //one sendto per datagram
+
+typedef struct WireSenderStats
+{
+	unsigned long frames;
+	unsigned long datagrams;
+	unsigned long calls;        //system calls that sent datagrams
+	unsigned long errors;
+}WireSenderStats;
+
+//UDP output of the frames with a pool of datagram buffers and the iovec/mmsghdr batch describing them,
+//grown to the largest frame and then reused, so sending a frame neither allocates nor copies
+typedef struct WireSender
+{
+	int fd;
+	int mode;               //WIRE_SEND_*, falls back to single when sendmmsg is not there
+	struct sockaddr_in address;
+	int capacity;           //datagrams in the pool
+	unsigned char* buffer;  //datagram i at buffer + i * WIRE_DATAGRAM_SIZE
+	struct iovec* iov;
+	struct mmsghdr* msg;
+	WireSenderStats stats;
+}WireSender;
+
+int wireFragments(int);
+int wireFragmentRecords(const WireFrame*, int);
+size_t encodeWireHeader(unsigned char*, const WireFrame*, int);
+void encodeWireRecord(unsigned char*, const WireRecord*);
+size_t encodeWire(unsigned char*, const WireFrame*, int);
+int decodeWireHeader(WireHeader*, const unsigned char*, size_t);
+void decodeWireRecord(WireRecord*, const unsigned char*);
+int openWireSender(WireSender*, const char*, int, int);
+void closeWireSender(WireSender*);
+int reserveWireSender(WireSender*, int);
+unsigned char* wireDatagram(WireSender*, int);
+int sendWireDatagrams(WireSender*, int);
+int encodeWireFrame(WireSender*, const WireFrame*);
+int sendWireFrame(WireSender*, const WireFrame*);
+
+#endif
@@ -0,0 +1,163 @@
+#include<string.h>
+#include<math.h>
+#include"ps_brake.h"
+#include"ps_latency.h"
+
+const char* const BRAKE_LEVEL_NAME[] = {"none", "warn", "partial", "full"};
+
+    void initialBrakeEnvelope(BrakeEnvelope* envelope)
+    {
+        envelope->decelMax = BRAKE_DECEL_MAX;
+        envelope->decelPartial = BRAKE_DECEL_PARTIAL;
+        envelope->decelFull = BRAKE_DECEL_FULL;
+        envelope->reaction = BRAKE_REACTION;
+        envelope->margin = BRAKE_MARGIN;
+        envelope->ttcWarn = BRAKE_TTC_WARN;
+        envelope->pathObjects = BRAKE_PATH_OBJECTS;
+        envelope->budgetNs = BRAKE_BUDGET_NS;
+    }
+
+    /*
+     * deceleration the car needs not to reach @object, @egoSpeed is BRAKE_EGO_UNKNOWN without the CAN
+     *  the object is taken at a constant velocity; HUGE_VAL once the room is gone
+     *  an object ahead, still or leading, needs the closing speed shed: closing * closing / (2 * room)
+     *  an oncoming one keeps coming at closing - v while the car stops from v, the car covers
+     *  v * v / (2 * a) and the object (closing - v) * v / a: v * (2 * closing - v) / (2 * room)
+     * */
+    double requiredDeceleration(const BrakeEnvelope* envelope, const TrackedObject* object, double egoSpeed)
+    {
+        double closing = -object->vx;
+        int oncoming = egoSpeed >= 0 && egoSpeed < closing;
+        double room;
+
+        if( closing <= 0 )
+            return 0;
+        //a car standing still can not brake away from an object coming at it
+        if( oncoming && egoSpeed <= 0 )
+            return 0;
+        room = object->gap - envelope->margin - closing * envelope->reaction;
+        if( room <= 0 )
+            return HUGE_VAL;
+        if( oncoming )
+            return egoSpeed * (2 * closing - egoSpeed) / (2 * room);
+        return closing * closing / (2 * room);
+    }
+
+    static void weighObject(const BrakeEnvelope* envelope, const TrackedObject* object, double egoSpeed, BrakeDemand* demand)
+    {
+        double decel = requiredDeceleration(envelope, object, egoSpeed);
+
+        if( decel > demand->decel )
+        {
+            demand->decel = decel;
+            demand->id = object->id;
+        }
+        demand->evaluated++;
+    }
+
+    /*
+     * braking demand of the objects in the path of @table at @egoSpeed
+     *  the soonest and the closest object are always evaluated, then the path in order up to pathObjects
+     *  others, the same objects whatever the load of the cpu; the time taken is measured, not enforced
+     * */
+    void evaluateBrake(const BrakeEnvelope* envelope, const ObjectTable* table, double egoSpeed, BrakeDemand* demand)
+    {
+        uint64_t start = latencyNow();
+        const TrackedObject* soonest = soonestObject(table);
+        const TrackedObject* closest = closestObject(table);
+        const TrackedObject* object;
+        int k, others = 0;
+
+        memset(demand, 0, sizeof(*demand));
+        demand->ttc = soonest ? soonest->ttc : TRACK_TTC_NONE;
+        if( soonest )
+            weighObject(envelope, soonest, egoSpeed, demand);
+        if( closest && closest != soonest )
+            weighObject(envelope, closest, egoSpeed, demand);
+        for( k = 0; k < table->pathCount; k++ )
+        {
+            object = &table->object[table->path[k]];
+            if( object == soonest || object == closest )
+                continue;
+            if( others++ == envelope->pathObjects )
+            {
+                demand->truncated = 1;
+                break;
+            }
+            weighObject(envelope, object, egoSpeed, demand);
+        }
+
+        if( demand->decel >= envelope->decelFull )
+            demand->level = BRAKE_FULL;
+        else if( demand->decel >= envelope->decelPartial )
+            demand->level = BRAKE_PARTIAL;
+        else if( demand->ttc < envelope->ttcWarn )
+            demand->level = BRAKE_WARN;
+        if( demand->level == BRAKE_FULL )
+            demand->demand = 1;
+        else if( demand->level == BRAKE_PARTIAL )
+            demand->demand = demand->decel < envelope->decelMax ? demand->decel / envelope->decelMax : 1;
+        demand->elapsed = latencyNow() - start;
+        demand->overBudget = demand->elapsed > envelope->budgetNs;
+    }
+
+    /*
+     * the speed of the car from the velocity frame of the motion CAN, in meters per second
+     *  signed 16 bits little endian in the first two bytes, @scale meters per second a bit, the id and
+     *  the scale are the ones of the driver of the lidar, the node passes them in
+     *  return 0, or -1 if the frame is too short
+     * */
+    int egoSpeedFromCan(const unsigned char* data, unsigned long length, double scale, double* speed)
+    {
+        int16_t raw;
+
+        if( length < 2 )
+            return -1;
+        raw = (int16_t)(data[0] | data[1] << 8);
+        *speed = raw * scale;
+        return 0;
+    }
+
+    void initialEgoSpeed(EgoSpeed* ego)
+    {
+        ego->sequence = 0;
+        ego->speed = BRAKE_EGO_UNKNOWN;
+        ego->stamp = 0;
+    }
+
+    /*
+     * @speed of the car from the CAN frame of @stamp, one writer only
+     * */
+    void publishEgoSpeed(EgoSpeed* ego, double speed, uint64_t stamp)
+    {
+        unsigned int sequence = ego->sequence;
+
+        __atomic_store_n(&ego->sequence, sequence + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        __atomic_store(&ego->speed, &speed, __ATOMIC_RELAXED);
+        __atomic_store_n(&ego->stamp, stamp, __ATOMIC_RELAXED);
+        __atomic_store_n(&ego->sequence, sequence + 2, __ATOMIC_RELEASE);
+    }
+
+    /*
+     * the speed of the car for a message of @stamp, both read from the same CAN frame
+     *  return BRAKE_EGO_UNKNOWN before the first frame, or when it is BRAKE_EGO_TIMEOUT_US away from @stamp
+     * */
+    double egoSpeedAt(EgoSpeed* ego, uint64_t stamp)
+    {
+        unsigned int sequence;
+        double speed;
+        uint64_t egoStamp;
+
+        do
+        {
+            sequence = __atomic_load_n(&ego->sequence, __ATOMIC_ACQUIRE);
+            __atomic_load(&ego->speed, &speed, __ATOMIC_RELAXED);
+            egoStamp = __atomic_load_n(&ego->stamp, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        }while( (sequence & 1) || sequence != __atomic_load_n(&ego->sequence, __ATOMIC_RELAXED) );
+
+        if( egoStamp == 0 || (egoStamp > stamp ? egoStamp - stamp : stamp - egoStamp) >= BRAKE_EGO_TIMEOUT_US )
+            return BRAKE_EGO_UNKNOWN;
+        return speed;
+    }
@@ -0,0 +1,351 @@
+#include<string.h>
+#include<math.h>
+#include"ps_lane.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include<immintrin.h>
+#define LANE_X86
+#endif
+
+const char* const LANE_SIDE_NAME[] = {"left", "right"};
+
+    /*
+     * side of the cone at @x, @y, or -1 if the gate leaves it out
+     * */
+    static inline int laneSide(const LaneGate* gate, double x, double y)
+    {
+        double d = y - (gate->slope * x + gate->offset);
+
+        if( !(x >= 0 && x <= gate->range && fabs(d) <= gate->lateral) )
+            return -1;
+        return d > 0 ? LANE_LEFT : LANE_RIGHT;
+    }
+
+    static inline void addLaneSums(LaneSums* sums, double x, double y)
+    {
+        sums->n += 1;
+        sums->x += x;
+        sums->y += y;
+        sums->xx += x * x;
+        sums->xy += x * y;
+        sums->yy += y * y;
+    }
+
+    /*
+     * the scalar pass over cones begin..count-1, also the tail of the vector kernels
+     * */
+    static void laneFrom(const double* x, const double* y, int begin, int count, const LaneGate* gate, LaneSums* sums)
+    {
+        int k, side;
+
+        for( k = begin; k < count; k++ )
+        {
+            if( (side = laneSide(gate, x[k], y[k])) >= 0 )
+                addLaneSums(&sums[side], x[k], y[k]);
+        }
+    }
+
+    static void laneScalar(const double* x, const double* y, int count, const LaneGate* gate, LaneSums* sums)
+    {
+        laneFrom(x, y, 0, count, gate, sums);
+    }
+
+#ifdef LANE_X86
+    /*
+     * every lane adds its cone to both sides, masked to zero on the side it is not of
+     * the lanes are summed at the end, so the sums differ from the scalar ones in the last bits
+     * */
+    static void laneSse2(const double* x, const double* y, int count, const LaneGate* gate, LaneSums* sums)
+    {
+        __m128d slope = _mm_set1_pd(gate->slope);
+        __m128d offset = _mm_set1_pd(gate->offset);
+        __m128d range = _mm_set1_pd(gate->range);
+        __m128d lateral = _mm_set1_pd(gate->lateral);
+        __m128d zero = _mm_setzero_pd();
+        __m128d one = _mm_set1_pd(1.0);
+        __m128d sign = _mm_set1_pd(-0.0);
+        __m128d acc[LANE_SIDES][6];
+        __m128d vx, vy, xx, xy, yy, d, in, left, mask;
+        double lane[2];
+        int k, s, i;
+
+        for( s = 0; s < LANE_SIDES; s++ )
+            for( i = 0; i < 6; i++ )
+                acc[s][i] = zero;
+        for( k = 0; k + 2 <= count; k += 2 )
+        {
+            vx = _mm_loadu_pd(x + k);
+            vy = _mm_loadu_pd(y + k);
+            d = _mm_sub_pd(vy, _mm_add_pd(_mm_mul_pd(slope, vx), offset));
+            in = _mm_and_pd(_mm_cmpge_pd(vx, zero), _mm_cmple_pd(vx, range));
+            in = _mm_and_pd(in, _mm_cmple_pd(_mm_andnot_pd(sign, d), lateral));
+            left = _mm_cmpgt_pd(d, zero);
+            xx = _mm_mul_pd(vx, vx);
+            xy = _mm_mul_pd(vx, vy);
+            yy = _mm_mul_pd(vy, vy);
+            for( s = 0; s < LANE_SIDES; s++ )
+            {
+                mask = s == LANE_LEFT ? _mm_and_pd(in, left) : _mm_andnot_pd(left, in);
+                acc[s][0] = _mm_add_pd(acc[s][0], _mm_and_pd(mask, one));
+                acc[s][1] = _mm_add_pd(acc[s][1], _mm_and_pd(mask, vx));
+                acc[s][2] = _mm_add_pd(acc[s][2], _mm_and_pd(mask, vy));
+                acc[s][3] = _mm_add_pd(acc[s][3], _mm_and_pd(mask, xx));
+                acc[s][4] = _mm_add_pd(acc[s][4], _mm_and_pd(mask, xy));
+                acc[s][5] = _mm_add_pd(acc[s][5], _mm_and_pd(mask, yy));
+            }
+        }
+        for( s = 0; s < LANE_SIDES; s++ )
+        {
+            double* sum = &sums[s].n;
+            for( i = 0; i < 6; i++ )
+            {
+                _mm_storeu_pd(lane, acc[s][i]);
+                sum[i] += lane[0] + lane[1];
+            }
+        }
+        laneFrom(x, y, k, count, gate, sums);
+    }
+
+    __attribute__((target("avx2")))
+    static void laneAvx2(const double* x, const double* y, int count, const LaneGate* gate, LaneSums* sums)
+    {
+        __m256d slope = _mm256_set1_pd(gate->slope);
+        __m256d offset = _mm256_set1_pd(gate->offset);
+        __m256d range = _mm256_set1_pd(gate->range);
+        __m256d lateral = _mm256_set1_pd(gate->lateral);
+        __m256d zero = _mm256_setzero_pd();
+        __m256d one = _mm256_set1_pd(1.0);
+        __m256d sign = _mm256_set1_pd(-0.0);
+        __m256d acc[LANE_SIDES][6];
+        __m256d vx, vy, xx, xy, yy, d, in, left, mask;
+        double lane[4];
+        int k, s, i;
+
+        for( s = 0; s < LANE_SIDES; s++ )
+            for( i = 0; i < 6; i++ )
+                acc[s][i] = zero;
+        for( k = 0; k + 4 <= count; k += 4 )
+        {
+            vx = _mm256_loadu_pd(x + k);
+            vy = _mm256_loadu_pd(y + k);
+            d = _mm256_sub_pd(vy, _mm256_add_pd(_mm256_mul_pd(slope, vx), offset));
+            in = _mm256_and_pd(_mm256_cmp_pd(vx, zero, _CMP_GE_OQ), _mm256_cmp_pd(vx, range, _CMP_LE_OQ));
+            in = _mm256_and_pd(in, _mm256_cmp_pd(_mm256_andnot_pd(sign, d), lateral, _CMP_LE_OQ));
+            left = _mm256_cmp_pd(d, zero, _CMP_GT_OQ);
+            xx = _mm256_mul_pd(vx, vx);
+            xy = _mm256_mul_pd(vx, vy);
+            yy = _mm256_mul_pd(vy, vy);
+            for( s = 0; s < LANE_SIDES; s++ )
+            {
+                mask = s == LANE_LEFT ? _mm256_and_pd(in, left) : _mm256_andnot_pd(left, in);
+                acc[s][0] = _mm256_add_pd(acc[s][0], _mm256_and_pd(mask, one));
+                acc[s][1] = _mm256_add_pd(acc[s][1], _mm256_and_pd(mask, vx));
+                acc[s][2] = _mm256_add_pd(acc[s][2], _mm256_and_pd(mask, vy));
+                acc[s][3] = _mm256_add_pd(acc[s][3], _mm256_and_pd(mask, xx));
+                acc[s][4] = _mm256_add_pd(acc[s][4], _mm256_and_pd(mask, xy));
+                acc[s][5] = _mm256_add_pd(acc[s][5], _mm256_and_pd(mask, yy));
+            }
+        }
+        for( s = 0; s < LANE_SIDES; s++ )
+        {
+            double* sum = &sums[s].n;
+            for( i = 0; i < 6; i++ )
+            {
+                _mm256_storeu_pd(lane, acc[s][i]);
+                sum[i] += (lane[0] + lane[1]) + (lane[2] + lane[3]);
+            }
+        }
+        laneFrom(x, y, k, count, gate, sums);
+    }
+#endif
+
+    /*
+     * kernel of @level, or of the best level below it the cpu runs
+     * */
+    LaneKernel selectLaneKernel(int level)
+    {
+        if( level > detectSimd() )
+            level = detectSimd();
+#ifdef LANE_X86
+        if( level == SIMD_AVX2 )
+            return laneAvx2;
+        if( level == SIMD_SSE2 )
+            return laneSse2;
+#endif
+        return laneScalar;
+    }
+
+    /*
+     * cones for messages of @capacity objects, a larger message grows it once
+     *  return 0, or -1 if the memory is not there
+     * */
+    int initialLaneEstimator(LaneEstimator* lane, int capacity)
+    {
+        memset(lane, 0, sizeof(*lane));
+        lane->x = (double*)malloc(sizeof(double) * capacity);
+        lane->y = (double*)malloc(sizeof(double) * capacity);
+        lane->pick = (int*)malloc(sizeof(int) * capacity);
+        if( !lane->x || !lane->y || !lane->pick )
+        {
+            destroyLaneEstimator(lane);
+            return -1;
+        }
+        lane->capacity = capacity;
+        lane->kernel = selectLaneKernel(detectSimd());
+        lane->gate.range = LANE_RANGE;
+        lane->gate.lateral = LANE_LATERAL;
+        lane->seed = LANE_SEED;
+        return 0;
+    }
+
+    void destroyLaneEstimator(LaneEstimator* lane)
+    {
+        free(lane->x);
+        free(lane->y);
+        free(lane->pick);
+        lane->x = lane->y = NULL;
+        lane->pick = NULL;
+        lane->size = lane->capacity = 0;
+    }
+
+    /*
+     * empty the cones for a message of @count objects
+     *  return 0, or -1 if it can not grow to them, the cones of the message are then not fitted
+     * */
+    int beginLane(LaneEstimator* lane, int count)
+    {
+        double *x, *y;
+        int* pick;
+
+        lane->size = 0;
+        if( count <= lane->capacity )
+            return 0;
+        x = (double*)realloc(lane->x, sizeof(double) * count);
+        if( x )
+            lane->x = x;
+        y = (double*)realloc(lane->y, sizeof(double) * count);
+        if( y )
+            lane->y = y;
+        pick = (int*)realloc(lane->pick, sizeof(int) * count);
+        if( pick )
+            lane->pick = pick;
+        if( !x || !y || !pick )
+            return -1;
+        lane->capacity = count;
+        return 0;
+    }
+
+    /*
+     * least squares of @sums into @line
+     *  return 0, or -1 with too few cones or all of them across the track
+     * */
+    static int solveLane(const LaneSums* sums, LaneLine* line)
+    {
+        double det = sums->n * sums->xx - sums->x * sums->x;
+        double rss;
+
+        if( sums->n < LANE_MIN_CONES || det < LANE_MIN_SPREAD * sums->n * sums->n )
+            return -1;
+        line->slope = (sums->n * sums->xy - sums->x * sums->y) / det;
+        line->offset = (sums->y - line->slope * sums->x) / sums->n;
+        rss = sums->yy - 2 * line->slope * sums->xy - 2 * line->offset * sums->y + line->slope * line->slope * sums->xx
+                + 2 * line->slope * line->offset * sums->x + sums->n * line->offset * line->offset;
+        line->rms = rss > 0 ? sqrt(rss / sums->n) : 0;
+        line->inliers = (int)sums->n;
+        line->valid = 1;
+        return 0;
+    }
+
+    static inline unsigned int nextLaneRandom(LaneEstimator* lane)
+    {
+        lane->seed = lane->seed * 1103515245u + 12345u;
+        return lane->seed >> 16;
+    }
+
+    /*
+     * @side fitted again on the line of two of its cones closest to the others, each cone adding its
+     *  squared residual up to LANE_INLIER, so of two lines with as many cones close the tighter wins
+     *  the least squares line is kept if no pair is far enough apart along the track
+     * */
+    static void robustLane(LaneEstimator* lane, int side, LaneLine* line)
+    {
+        const double* x = lane->x;
+        const double* y = lane->y;
+        double slope, offset, r2, cost, best = HUGE_VAL, bestSlope = 0, bestOffset = 0;
+        LaneSums sums;
+        int m = 0, r, i, j, k;
+
+        for( k = 0; k < lane->size; k++ )
+        {
+            if( laneSide(&lane->gate, x[k], y[k]) == side )
+                lane->pick[m++] = k;
+        }
+        for( r = 0; r < LANE_RANSAC_ROUNDS; r++ )
+        {
+            i = lane->pick[nextLaneRandom(lane) % m];
+            j = lane->pick[nextLaneRandom(lane) % m];
+            if( fabs(x[j] - x[i]) < LANE_RANSAC_SPAN )
+                continue;
+            slope = (y[j] - y[i]) / (x[j] - x[i]);
+            offset = y[i] - slope * x[i];
+            cost = 0;
+            for( k = 0; k < m; k++ )
+            {
+                r2 = y[lane->pick[k]] - (slope * x[lane->pick[k]] + offset);
+                r2 *= r2;
+                cost += r2 < LANE_INLIER * LANE_INLIER ? r2 : LANE_INLIER * LANE_INLIER;
+            }
+            if( cost < best )
+            {
+                best = cost;
+                bestSlope = slope;
+                bestOffset = offset;
+            }
+        }
+        if( best == HUGE_VAL )
+            return;
+
+        memset(&sums, 0, sizeof(sums));
+        for( k = 0; k < m; k++ )
+        {
+            i = lane->pick[k];
+            if( fabs(y[i] - (bestSlope * x[i] + bestOffset)) <= LANE_INLIER )
+                addLaneSums(&sums, x[i], y[i]);
+        }
+        if( solveLane(&sums, line) == 0 )
+        {
+            line->robust = 1;
+            lane->robust++;
+        }
+    }
+
+    /*
+     * boundaries of the cones added since beginLane, in line[]
+     *  the middle of two boundaries sorts the cones of the next message, none starts over from y = 0
+     * */
+    void fitLane(LaneEstimator* lane)
+    {
+        LaneSums sums[LANE_SIDES];
+        LaneLine* line;
+        int s;
+
+        memset(sums, 0, sizeof(sums));
+        lane->kernel(lane->x, lane->y, lane->size, &lane->gate, sums);
+        for( s = 0; s < LANE_SIDES; s++ )
+        {
+            line = &lane->line[s];
+            memset(line, 0, sizeof(*line));
+            line->cones = (int)sums[s].n;
+            if( solveLane(&sums[s], line) == 0 && line->rms > LANE_FIT_RMS )
+                robustLane(lane, s, line);
+        }
+
+        if( lane->line[LANE_LEFT].valid && lane->line[LANE_RIGHT].valid )
+        {
+            lane->gate.slope = (lane->line[LANE_LEFT].slope + lane->line[LANE_RIGHT].slope) / 2;
+            lane->gate.offset = (lane->line[LANE_LEFT].offset + lane->line[LANE_RIGHT].offset) / 2;
+        }
+        else if( !lane->line[LANE_LEFT].valid && !lane->line[LANE_RIGHT].valid )
+            lane->gate.slope = lane->gate.offset = 0;
+        lane->fits++;
+    }
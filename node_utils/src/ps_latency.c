@@ -0,0 +1,191 @@
+#include<string.h>
+#include<time.h>
+#include"ps_latency.h"
+
+#if defined(PS_LATENCY_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+#include<x86intrin.h>
+#define LATENCY_TSC 1
+#endif
+
+#ifdef LATENCY_TSC
+    static uint64_t tscBase;
+    static double tscNs = 0;    //nanoseconds per tick, 0 until calibrated
+#endif
+
+    static uint64_t monotonicNs()
+    {
+        struct timespec now;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+    }
+
+    /*
+     * calibrate the TSC against CLOCK_MONOTONIC, about 10 ms, before any thread records;
+     *  nothing to do with the monotonic clock
+     * */
+    void initialLatencyClock()
+    {
+#ifdef LATENCY_TSC
+        struct timespec pause = {0, 10000000};
+        uint64_t ns = monotonicNs();
+        uint64_t tsc = __rdtsc();
+
+        nanosleep(&pause, NULL);
+        tscNs = (double)(monotonicNs() - ns) / (double)(__rdtsc() - tsc);
+        tscBase = tsc;
+#endif
+    }
+
+    /*
+     * nanoseconds of a clock only good for differences
+     * */
+    uint64_t latencyNow()
+    {
+#ifdef LATENCY_TSC
+        if( tscNs > 0 )
+            return (uint64_t)((double)(__rdtsc() - tscBase) * tscNs);
+#endif
+        return monotonicNs();
+    }
+
+    /*
+     * microseconds since the epoch, the clock of the timestamps of the messages
+     * */
+    uint64_t latencyUtcUs()
+    {
+        struct timespec now;
+
+        clock_gettime(CLOCK_REALTIME, &now);
+        return (uint64_t)now.tv_sec * 1000000ULL + (uint64_t)now.tv_nsec / 1000;
+    }
+
+    /*
+     * empty recorder of the thread @name with the stages @stage[0..@stages-1]
+     * */
+    void initialLatency(LatencyRecorder* recorder, const char* name, const char* const* stage, int stages)
+    {
+        int i;
+
+        memset(recorder, 0, sizeof(*recorder));
+        recorder->name = name;
+        recorder->stages = stages < LATENCY_MAX_STAGES ? stages : LATENCY_MAX_STAGES;
+        for( i = 0; i < recorder->stages; i++ )
+            recorder->stage[i].name = stage[i];
+    }
+
+    //log-linear: exact below LATENCY_SUB, then LATENCY_SUB buckets per power of two
+    static int bucketIndex(uint64_t ns)
+    {
+        int e;
+
+        if( ns < LATENCY_SUB )
+            return (int)ns;
+        e = 63 - __builtin_clzll(ns);
+        if( e >= LATENCY_MAX_BITS )
+            return LATENCY_BUCKETS - 1;
+        return LATENCY_SUB * (e - LATENCY_SUB_BITS + 1) + (int)((ns >> (e - LATENCY_SUB_BITS)) & (LATENCY_SUB - 1));
+    }
+
+    //middle of the bucket @index
+    static uint64_t bucketValue(int index)
+    {
+        int e;
+        uint64_t low;
+
+        if( index < LATENCY_SUB )
+            return (uint64_t)index;
+        e = index / LATENCY_SUB + LATENCY_SUB_BITS - 1;
+        low = (uint64_t)(LATENCY_SUB + index % LATENCY_SUB) << (e - LATENCY_SUB_BITS);
+        return low + ((1ULL << (e - LATENCY_SUB_BITS)) >> 1);
+    }
+
+    //only the owner thread writes, so a relaxed load and store is enough for the readers to see whole values
+    static void bump(unsigned long* counter, unsigned long add)
+    {
+        __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + add, __ATOMIC_RELAXED);
+    }
+
+    /*
+     * add @ns nanoseconds to the stage @stage, from the thread owning @recorder only
+     * */
+    void recordLatency(LatencyRecorder* recorder, int stage, uint64_t ns)
+    {
+        LatencyHistogram* histogram = &recorder->stage[stage];
+
+        bump(&histogram->bucket[bucketIndex(ns)], 1);
+        __atomic_store_n(&histogram->sum, histogram->sum + ns, __ATOMIC_RELAXED);
+        if( ns > histogram->max )
+            __atomic_store_n(&histogram->max, ns, __ATOMIC_RELAXED);
+        bump(&histogram->count, 1);
+    }
+
+    /*
+     * add the age of a message stamped @timestamp, microseconds since the epoch, to the stage @stage;
+     * a stamp in the future or older than LATENCY_MAX_AGE_US is from another clock and only counted as skipped
+     * */
+    void recordSensorAge(LatencyRecorder* recorder, int stage, uint64_t timestamp)
+    {
+        uint64_t now = latencyUtcUs();
+
+        if( timestamp > now || now - timestamp > LATENCY_MAX_AGE_US )
+        {
+            bump(&recorder->stage[stage].skipped, 1);
+            return;
+        }
+        recordLatency(recorder, stage, (now - timestamp) * 1000);
+    }
+
+    /*
+     * percentiles of @histogram, to the resolution of a bucket, while its thread may still be recording
+     * */
+    void summarizeLatency(const LatencyHistogram* histogram, LatencySummary* summary)
+    {
+        unsigned long seen = 0, count = 0, p50, p99;
+        int i;
+
+        memset(summary, 0, sizeof(*summary));
+        summary->skipped = __atomic_load_n(&histogram->skipped, __ATOMIC_RELAXED);
+        summary->max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+
+        //the buckets rather than the count, so the ranks stay inside what is summed
+        for( i = 0; i < LATENCY_BUCKETS; i++ )
+            count += __atomic_load_n(&histogram->bucket[i], __ATOMIC_RELAXED);
+        if( count == 0 )
+            return;
+
+        summary->count = count;
+        summary->mean = __atomic_load_n(&histogram->sum, __ATOMIC_RELAXED) / count;
+        p50 = (count + 1) / 2;
+        p99 = count - count / 100;
+        for( i = 0; i < LATENCY_BUCKETS && seen < p99; i++ )
+        {
+            unsigned long n = __atomic_load_n(&histogram->bucket[i], __ATOMIC_RELAXED);
+
+            if( seen < p50 && seen + n >= p50 )
+                summary->p50 = bucketValue(i);
+            seen += n;
+            if( seen >= p99 )
+                summary->p99 = bucketValue(i);
+        }
+
+        //the middle of a bucket may be above the largest value
+        summary->p50 = summary->p50 < summary->max ? summary->p50 : summary->max;
+        summary->p99 = summary->p99 < summary->max ? summary->p99 : summary->max;
+    }
+
+    /*
+     * one line for the report of @histogram, in microseconds, at most @size bytes with the terminating 0
+     *  return the length snprintf returns
+     * */
+    int formatLatency(char* text, size_t size, const LatencyHistogram* histogram)
+    {
+        LatencySummary summary;
+
+        summarizeLatency(histogram, &summary);
+        if( summary.count == 0 )
+            return snprintf(text, size, "%s: no sample, %lu skipped", histogram->name, summary.skipped);
+        return snprintf(text, size, "%s: %lu samples, mean %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us, %lu skipped",
+                histogram->name, summary.count, summary.mean / 1000.0, summary.p50 / 1000.0,
+                summary.p99 / 1000.0, summary.max / 1000.0, summary.skipped);
+    }
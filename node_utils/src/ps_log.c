@@ -0,0 +1,462 @@
+#include<string.h>
+#include<stdarg.h>
+#include<ctype.h>
+#include<unistd.h>
+#include<sys/stat.h>
+#include"ps_log.h"
+
+static const char* loggerLevelName[] = {"off", "error", "warn", "info", "debug", "trace"};
+static const char* loggerCategoryName[] = {"node", "points", "objects", "serial", "control"};
+
+    static uint64_t realtimeNs()
+    {
+        struct timespec now;
+
+        clock_gettime(CLOCK_REALTIME, &now);
+        return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+    }
+
+    /*
+     * one conversion of a printf format starting at the '%' @p: its length in @*size, and its kind,
+     *  'i' signed, 'u' unsigned, 'f' double, 's' string, 'p' pointer, '%' no argument, 0 unsupported;
+     * @*length is 2 for ll/j, 1 for l/z/t, 0 otherwise
+     * */
+    static char conversion(const char* p, int* size, int* length)
+    {
+        const char* q = p + 1;
+
+        *length = 0;
+        while( *q && strchr("-+ #0", *q) )
+            q++;
+        while( isdigit((unsigned char)*q) || *q == '.' )
+            q++;
+        if( q[0] == 'h' )
+            q += q[1] == 'h' ? 2 : 1;
+        else if( q[0] == 'l' && q[1] == 'l' )
+        {
+            *length = 2;
+            q += 2;
+        }
+        else if( *q == 'j' )
+        {
+            *length = 2;
+            q++;
+        }
+        else if( *q == 'l' || *q == 'z' || *q == 't' )
+        {
+            *length = 1;
+            q++;
+        }
+        *size = (int)(q - p) + (*q != 0);
+        switch( *q )
+        {
+            case 'd': case 'i': case 'c':
+                return 'i';
+            case 'u': case 'x': case 'X': case 'o':
+                return 'u';
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                return 'f';
+            case 's':
+                return 's';
+            case 'p':
+                return 'p';
+            case '%':
+                return '%';
+        }
+        return 0;
+    }
+
+    //the arguments of @format in @record, read with the types the conversions give them
+    static void collectArgs(LoggerRecord* record, const char* format, va_list ap)
+    {
+        const char* p = format;
+        int size, length;
+        char kind;
+
+        record->count = 0;
+        while( (p = strchr(p, '%')) != NULL && record->count < LOGGER_MAX_ARGS )
+        {
+            kind = conversion(p, &size, &length);
+            if( kind == 0 )
+                break;
+            if( kind == 'i' )
+                record->arg[record->count++].i = length == 2 ? va_arg(ap, long long) : length == 1 ? va_arg(ap, long) : va_arg(ap, int);
+            else if( kind == 'u' )
+                record->arg[record->count++].u = length == 2 ? va_arg(ap, unsigned long long) : length == 1 ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int);
+            else if( kind == 'f' )
+                record->arg[record->count++].f = va_arg(ap, double);
+            else if( kind == 's' || kind == 'p' )
+                record->arg[record->count++].p = va_arg(ap, const void*);
+            p += size;
+        }
+    }
+
+    /*
+     * queue a record of @level and @category, never blocks: the record is dropped if the ring is full;
+     * call it through LOG_AT so nothing is done when the level or the category is off
+     * */
+    void logRecord(Logger* logger, int level, unsigned int category, const char* format, ...)
+    {
+        size_t position = __atomic_load_n(&logger->tail, __ATOMIC_RELAXED);
+        LoggerSlot* slot;
+        intptr_t turn;
+        va_list ap;
+
+        for( ; ; )
+        {
+            slot = &logger->slot[position & (logger->capacity - 1)];
+            turn = (intptr_t)__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - (intptr_t)position;
+            if( turn == 0 && __atomic_compare_exchange_n(&logger->tail, &position, position + 1, 1,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
+                break;
+            if( turn < 0 )
+            {
+                __atomic_fetch_add(&logger->dropped, 1, __ATOMIC_RELAXED);
+                return;
+            }
+            if( turn > 0 )
+                position = __atomic_load_n(&logger->tail, __ATOMIC_RELAXED);
+        }
+
+        slot->record.time = realtimeNs();
+        slot->record.format = format;
+        slot->record.level = (uint8_t)level;
+        slot->record.category = (uint8_t)category;
+        va_start(ap, format);
+        collectArgs(&slot->record, format, ap);
+        va_end(ap);
+        __atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+    }
+
+    static const char* categoryName(unsigned int category)
+    {
+        int i;
+
+        for( i = 0; i < (int)(sizeof(loggerCategoryName) / sizeof(loggerCategoryName[0])); i++ )
+            if( category & (1u << i) )
+                return loggerCategoryName[i];
+        return "-";
+    }
+
+    /*
+     * the line of @record, time, level, category and message, with a newline, at most @size bytes
+     *  return its length
+     * */
+    int formatLoggerRecord(char* line, size_t size, const LoggerRecord* record)
+    {
+        const char* p = record->format;
+        time_t seconds = (time_t)(record->time / 1000000000ULL);
+        char spec[32];
+        struct tm local;
+        size_t n = 0;
+        int count = 0, length, width;
+        char kind;
+
+        localtime_r(&seconds, &local);
+        n = strftime(line, size, "%H:%M:%S", &local);
+        n += (size_t)snprintf(line + n, size - n, ".%06lu %-5s %-7s ", (unsigned long)(record->time % 1000000000ULL / 1000),
+                loggerLevelName[record->level <= LOGGER_TRACE ? record->level : LOGGER_TRACE], categoryName(record->category));
+
+        while( *p && n + 1 < size )
+        {
+            if( *p != '%' )
+            {
+                line[n++] = *p++;
+                continue;
+            }
+            kind = conversion(p, &width, &length);
+            if( kind == 0 || width >= (int)sizeof(spec) - 2 )
+                break;
+            if( kind == '%' )
+            {
+                line[n++] = '%';
+                p += width;
+                continue;
+            }
+
+            //the flags, width and precision of the format, the length of the stored value
+            memcpy(spec, p, (size_t)width - 1);
+            spec[width - 1] = 0;
+            while( strchr("hljzt", spec[strlen(spec) - 1]) )
+                spec[strlen(spec) - 1] = 0;
+            if( kind == 'i' || kind == 'u' )
+                strcat(spec, p[width - 1] == 'c' ? "" : "ll");
+            spec[strlen(spec) + 1] = 0;
+            spec[strlen(spec)] = p[width - 1];
+
+            if( count >= record->count )
+                n += (size_t)snprintf(line + n, size - n, "?");
+            else if( kind == 'i' )
+                n += (size_t)(p[width - 1] == 'c' ? snprintf(line + n, size - n, spec, (int)record->arg[count].i)
+                        : snprintf(line + n, size - n, spec, record->arg[count].i));
+            else if( kind == 'u' )
+                n += (size_t)snprintf(line + n, size - n, spec, record->arg[count].u);
+            else if( kind == 'f' )
+                n += (size_t)snprintf(line + n, size - n, spec, record->arg[count].f);
+            else if( kind == 's' )
+                n += (size_t)snprintf(line + n, size - n, spec, record->arg[count].p ? (const char*)record->arg[count].p : "(null)");
+            else
+                n += (size_t)snprintf(line + n, size - n, spec, record->arg[count].p);
+            count++;
+            p += width;
+            if( n >= size )
+                n = size - 1;
+        }
+
+        //one record, one line
+        while( n > 0 && line[n - 1] == '\n' )
+            n--;
+        if( n + 1 >= size )
+            n = size - 2;
+        line[n++] = '\n';
+        line[n] = 0;
+        return (int)n;
+    }
+
+    void setLoggerLevel(Logger* logger, int level)
+    {
+        __atomic_store_n(&logger->level, level, __ATOMIC_RELAXED);
+    }
+
+    void setLoggerCategories(Logger* logger, unsigned int categories)
+    {
+        __atomic_store_n(&logger->categories, categories, __ATOMIC_RELAXED);
+    }
+
+    /*
+     * apply "level[:category,category...]", a category list of "all" or nothing keeps them all
+     *  return 0 on success, -1 if a name is unknown and nothing changed
+     * */
+    int parseLoggerConfig(Logger* logger, const char* text)
+    {
+        char word[32];
+        unsigned int categories = 0;
+        int level = -1, i, n;
+
+        while( isspace((unsigned char)*text) )
+            text++;
+        for( n = 0; text[n] && text[n] != ':' && !isspace((unsigned char)text[n]) && n < (int)sizeof(word) - 1; n++ )
+            word[n] = (char)tolower((unsigned char)text[n]);
+        word[n] = 0;
+        for( i = 0; i <= LOGGER_TRACE; i++ )
+            if( strcmp(word, loggerLevelName[i]) == 0 )
+                level = i;
+        if( level < 0 )
+            return -1;
+
+        text += n;
+        while( *text == ':' || *text == ',' )
+        {
+            text++;
+            for( n = 0; text[n] && text[n] != ',' && !isspace((unsigned char)text[n]) && n < (int)sizeof(word) - 1; n++ )
+                word[n] = (char)tolower((unsigned char)text[n]);
+            word[n] = 0;
+            text += n;
+            if( strcmp(word, "all") == 0 )
+            {
+                categories |= LOGGER_ALL;
+                continue;
+            }
+            for( i = 0; i < (int)(sizeof(loggerCategoryName) / sizeof(loggerCategoryName[0])); i++ )
+                if( strcmp(word, loggerCategoryName[i]) == 0 )
+                    break;
+            if( i == (int)(sizeof(loggerCategoryName) / sizeof(loggerCategoryName[0])) )
+                return -1;
+            categories |= 1u << i;
+        }
+
+        setLoggerLevel(logger, level);
+        setLoggerCategories(logger, categories ? categories : LOGGER_ALL);
+        return 0;
+    }
+
+    //the file of the log, the older ones shifted to path.1 .. path.LOGGER_FILES
+    static void rotateLogger(Logger* logger)
+    {
+        char from[280], to[280];
+        int i;
+
+        fclose(logger->file);
+        for( i = LOGGER_FILES; i > 0; i-- )
+        {
+            if( i == 1 )
+                snprintf(from, sizeof(from), "%s", logger->path);
+            else
+                snprintf(from, sizeof(from), "%s.%d", logger->path, i - 1);
+            snprintf(to, sizeof(to), "%s.%d", logger->path, i);
+            rename(from, to);
+        }
+        logger->file = fopen(logger->path, "w");
+        logger->bytes = 0;
+    }
+
+    static void writeLine(Logger* logger, const char* line, int length)
+    {
+        if( logger->file == NULL )
+            return;
+        if( logger->file != stderr && logger->bytes + length > LOGGER_FILE_BYTES )
+        {
+            rotateLogger(logger);
+            if( logger->file == NULL )
+                return;
+        }
+        fwrite(line, 1, (size_t)length, logger->file);
+        logger->bytes += length;
+    }
+
+    //the level and categories of the control file, when it changed since the last look
+    static void readControl(Logger* logger)
+    {
+        struct stat status;
+        char text[128];
+        FILE* file;
+
+        if( logger->control[0] == 0 || stat(logger->control, &status) != 0 || status.st_mtime == logger->controlTime )
+            return;
+        logger->controlTime = status.st_mtime;
+        if( (file = fopen(logger->control, "r")) == NULL )
+            return;
+        if( fgets(text, sizeof(text), file) != NULL && parseLoggerConfig(logger, text) != 0 )
+            fprintf(stderr, "invalid %s(%s)!\n", logger->control, text);
+        fclose(file);
+    }
+
+    //format and write the records of the ring
+    static int drainLogger(Logger* logger)
+    {
+        char line[LOGGER_LINE_SIZE];
+        LoggerSlot* slot;
+        int count = 0;
+
+        for( ; ; )
+        {
+            slot = &logger->slot[logger->head & (logger->capacity - 1)];
+            if( __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != logger->head + 1 )
+                break;
+            writeLine(logger, line, formatLoggerRecord(line, sizeof(line), &slot->record));
+            __atomic_store_n(&slot->sequence, logger->head + logger->capacity, __ATOMIC_RELEASE);
+            logger->head++;
+            count++;
+        }
+        logger->written += (unsigned long)count;
+        return count;
+    }
+
+    static void* writerMain(void* arg)
+    {
+        Logger* logger = (Logger*)arg;
+        struct timespec idle = {0, LOGGER_IDLE_US * 1000L};
+        unsigned long reported = 0, dropped;
+        char line[128];
+        int ticks = 0;
+
+        while( !__atomic_load_n(&logger->quit, __ATOMIC_ACQUIRE) )
+        {
+            if( drainLogger(logger) > 0 )
+                continue;
+
+            //idle: flush, say what was lost, look at the control file about once a second
+            dropped = __atomic_load_n(&logger->dropped, __ATOMIC_RELAXED);
+            if( dropped != reported )
+            {
+                writeLine(logger, line, snprintf(line, sizeof(line), "log: %lu records dropped, the ring was full\n", dropped - reported));
+                reported = dropped;
+            }
+            if( logger->file != NULL )
+                fflush(logger->file);
+            if( ++ticks * LOGGER_IDLE_US >= 1000000 )
+            {
+                readControl(logger);
+                ticks = 0;
+            }
+            nanosleep(&idle, NULL);
+        }
+
+        //what was queued before closeLogger
+        drainLogger(logger);
+        dropped = __atomic_load_n(&logger->dropped, __ATOMIC_RELAXED);
+        if( dropped != reported )
+            writeLine(logger, line, snprintf(line, sizeof(line), "log: %lu records dropped, the ring was full\n", dropped - reported));
+        return NULL;
+    }
+
+    /*
+     * open the log @path, or the one of PS_LOG_FILE, "-" for stderr, with a ring of @capacity records
+     * rounded to a power of two, and start its writer thread; the level is info for every category
+     * unless PS_LOG says otherwise
+     *  return 0 on success, -1 on error
+     * */
+    int openLogger(Logger* logger, const char* path, size_t capacity)
+    {
+        const char* env;
+        size_t i;
+
+        memset(logger, 0, sizeof(*logger));
+        logger->level = LOGGER_INFO;
+        logger->categories = LOGGER_ALL;
+        if( (env = getenv(LOGGER_ENV)) != NULL && parseLoggerConfig(logger, env) != 0 )
+            printf("invalid %s(%s)!\n", LOGGER_ENV, env);
+        if( (env = getenv(LOGGER_CONTROL_ENV)) != NULL )
+            snprintf(logger->control, sizeof(logger->control), "%s", env);
+        if( (env = getenv(LOGGER_FILE_ENV)) != NULL )
+            path = env;
+        snprintf(logger->path, sizeof(logger->path), "%s", path);
+
+        for( logger->capacity = 16; logger->capacity < capacity; logger->capacity <<= 1 )
+            ;
+        if( (logger->slot = (LoggerSlot*)malloc(sizeof(LoggerSlot) * logger->capacity)) == NULL )
+        {
+            printf("log malloc error %lu!\n", (unsigned long)logger->capacity);
+            logger->level = LOGGER_OFF;
+            return -1;
+        }
+        for( i = 0; i < logger->capacity; i++ )
+            logger->slot[i].sequence = i;
+
+        if( strcmp(logger->path, "-") == 0 )
+            logger->file = stderr;
+        else if( (logger->file = fopen(logger->path, "a")) == NULL )
+        {
+            printf("open log(%s) error!\n", logger->path);
+            free(logger->slot);
+            logger->slot = NULL;
+            logger->level = LOGGER_OFF;
+            return -1;
+        }
+        else
+        {
+            fseek(logger->file, 0, SEEK_END);
+            logger->bytes = ftell(logger->file);
+        }
+
+        if( pthread_create(&logger->thread, NULL, writerMain, logger) != 0 )
+        {
+            printf("log thread error!\n");
+            closeLogger(logger);
+            return -1;
+        }
+        logger->running = 1;
+        return 0;
+    }
+
+    /*
+     * write what is queued and stop the writer, nothing may be logged anymore
+     * */
+    void closeLogger(Logger* logger)
+    {
+        if( logger->running )
+        {
+            __atomic_store_n(&logger->quit, 1, __ATOMIC_RELEASE);
+            pthread_join(logger->thread, NULL);
+            logger->running = 0;
+        }
+        if( logger->file != NULL && logger->file != stderr )
+            fclose(logger->file);
+        else if( logger->file == stderr )
+            fflush(stderr);
+        free(logger->slot);
+        logger->file = NULL;
+        logger->slot = NULL;
+        logger->capacity = 0;
+        logger->level = LOGGER_OFF;
+    }
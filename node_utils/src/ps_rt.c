@@ -0,0 +1,260 @@
+#define _GNU_SOURCE
+#include<string.h>
+#include<errno.h>
+#include<time.h>
+#include<unistd.h>
+#include<malloc.h>
+#include<pthread.h>
+#include<sched.h>
+#include<sys/mman.h>
+#include"ps_rt.h"
+
+static const char* const RT_STAGE_NAME[] = {"wakeup jitter", "cycle"};
+
+    static uint64_t monotonicNs()
+    {
+        struct timespec now;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+    }
+
+    /*
+     * read PS_RT, "cpu[:priority]", unset, empty or "off" leaves the mode off
+     *  return 0, or -1 if the value does not parse, the mode is then off
+     * */
+    int rtConfigFromEnv(RtConfig* config)
+    {
+        const char* env = getenv(RT_ENV);
+        char* end;
+        long cpu, priority = RT_PRIORITY;
+
+        memset(config, 0, sizeof(*config));
+        if( env == NULL || *env == '\0' || strcmp(env, "off") == 0 )
+            return 0;
+        cpu = strtol(env, &end, 10);
+        if( end == env || cpu < 0 || cpu >= CPU_SETSIZE )
+            return -1;
+        if( *end == ':' )
+        {
+            env = end + 1;
+            priority = strtol(env, &end, 10);
+            if( end == env || priority < sched_get_priority_min(SCHED_FIFO) || priority > sched_get_priority_max(SCHED_FIFO) )
+                return -1;
+        }
+        if( *end != '\0' )
+            return -1;
+        config->enabled = 1;
+        config->cpu = (int)cpu;
+        config->priority = (int)priority;
+        return 0;
+    }
+
+    /*
+     * lock the memory of the process, now and to come, and fault in a stack and a heap reserve
+     *  malloc keeps what it gets from then on, no trim and no mmap, so a free never gives pages back
+     *  return 0, or -1 with errno if the memory can not be locked, RLIMIT_MEMLOCK or CAP_IPC_LOCK
+     * */
+    int rtLockMemory()
+    {
+        volatile char stack[RT_STACK_PREFAULT];
+        char* heap;
+        long page = sysconf(_SC_PAGESIZE);
+        long i;
+
+        mallopt(M_TRIM_THRESHOLD, -1);
+        mallopt(M_MMAP_MAX, 0);
+        if( mlockall(MCL_CURRENT | MCL_FUTURE) != 0 )
+            return -1;
+        for( i = 0; i < RT_STACK_PREFAULT; i += page )
+            stack[i] = 0;
+        (void)stack[0];
+        if( (heap = (char*)malloc(RT_HEAP_PREFAULT)) != NULL )
+        {
+            for( i = 0; i < RT_HEAP_PREFAULT; i += page )
+                heap[i] = 0;
+            free(heap);
+        }
+        return 0;
+    }
+
+    /*
+     * pin the calling thread to the cpu of @config and schedule it SCHED_FIFO at its priority
+     *  the threads it creates afterwards inherit both
+     *  return 0, or -1 with errno, EPERM without CAP_SYS_NICE or an RLIMIT_RTPRIO
+     * */
+    int rtEnterThread(const RtConfig* config)
+    {
+        struct sched_param param;
+        cpu_set_t cpus;
+        int ret;
+
+        CPU_ZERO(&cpus);
+        CPU_SET(config->cpu, &cpus);
+        if( (ret = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus)) != 0 )
+        {
+            errno = ret;
+            return -1;
+        }
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = config->priority;
+        if( (ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)) != 0 )
+        {
+            errno = ret;
+            return -1;
+        }
+        return 0;
+    }
+
+    /*
+     * a grid of deadlines @periodNs apart, it starts at the first waitRtPeriod
+     * */
+    void initialRtPeriod(RtPeriod* period, const char* name, uint64_t periodNs)
+    {
+        memset(period, 0, sizeof(*period));
+        period->periodNs = periodNs;
+        initialLatency(&period->latency, name, RT_STAGE_NAME, RT_STAGES);
+    }
+
+    /*
+     * end the cycle of the caller and sleep to the next deadline
+     *  a cycle that ran past it skips the deadlines gone by, the grid is kept rather than shifted
+     * */
+    void waitRtPeriod(RtPeriod* period)
+    {
+        uint64_t now = monotonicNs();
+        struct timespec deadline;
+
+        if( period->cycles == 0 )
+            period->next = now + period->periodNs;
+        else
+        {
+            recordLatency(&period->latency, RT_CYCLE, now - period->woke);
+            if( now > period->next )
+            {
+                period->overruns++;
+                while( period->next <= now )
+                {
+                    period->next += period->periodNs;
+                    period->missed++;
+                }
+            }
+        }
+
+        deadline.tv_sec = (time_t)(period->next / 1000000000ULL);
+        deadline.tv_nsec = (long)(period->next % 1000000000ULL);
+        while( clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR )
+            ;
+
+        period->woke = monotonicNs();
+        recordLatency(&period->latency, RT_JITTER, period->woke > period->next ? period->woke - period->next : 0);
+        period->next += period->periodNs;
+        period->cycles++;
+    }
+
+    /*
+     * three slots of @size bytes, zeroed
+     *  return 0, or -1 if the memory is not there
+     * */
+    int initialRtMailbox(RtMailbox* mailbox, size_t size)
+    {
+        int i;
+
+        memset(mailbox, 0, sizeof(*mailbox));
+        mailbox->size = size;
+        for( i = 0; i < 3; i++ )
+        {
+            if( (mailbox->slot[i] = calloc(1, size)) == NULL )
+            {
+                destroyRtMailbox(mailbox);
+                return -1;
+            }
+        }
+        mailbox->back = 0;
+        mailbox->middle = 1;
+        mailbox->front = 2;
+        return 0;
+    }
+
+    void destroyRtMailbox(RtMailbox* mailbox)
+    {
+        int i;
+
+        for( i = 0; i < 3; i++ )
+            free(mailbox->slot[i]);
+        memset(mailbox, 0, sizeof(*mailbox));
+    }
+
+    /*
+     * publish the back slot, the writer gets the middle one to fill next
+     * */
+    void postRtMailbox(RtMailbox* mailbox)
+    {
+        int old = __atomic_exchange_n(&mailbox->middle, mailbox->back | RT_MAILBOX_FRESH, __ATOMIC_ACQ_REL);
+
+        mailbox->back = old & ~RT_MAILBOX_FRESH;
+        mailbox->posted++;
+        if( old & RT_MAILBOX_FRESH )
+            mailbox->replaced++;
+    }
+
+    /*
+     * the last slot posted, or NULL if there is none since the last take
+     *  it is the reader's until its next take
+     * */
+    void* takeRtMailbox(RtMailbox* mailbox)
+    {
+        if( !(__atomic_load_n(&mailbox->middle, __ATOMIC_ACQUIRE) & RT_MAILBOX_FRESH) )
+            return NULL;
+        mailbox->front = __atomic_exchange_n(&mailbox->middle, mailbox->front, __ATOMIC_ACQ_REL) & ~RT_MAILBOX_FRESH;
+        return mailbox->slot[mailbox->front];
+    }
+
+    /*
+     * copy @count items of @itemSize to @offset of the back slot, as many as fit between it and the end
+     *  return the items copied, fewer than @count when the message is counted in truncated
+     * */
+    unsigned long fillRtMailbox(RtMailbox* mailbox, size_t offset, const void* items, unsigned long count, size_t itemSize)
+    {
+        unsigned long capacity = (unsigned long)((mailbox->size - offset) / itemSize);
+
+        if( count > capacity )
+        {
+            count = capacity;
+            mailbox->truncated++;
+        }
+        memcpy((char*)mailbox->slot[mailbox->back] + offset, items, count * itemSize);
+        return count;
+    }
+
+    /*
+     * rtLockMemory, a warning in @logger if the limits do not allow it
+     * */
+    void logRtLockMemory(Logger* logger)
+    {
+        if( rtLockMemory() != 0 )
+            LOG_AT(logger, LOGGER_WARN, LOGGER_NODE, "mlockall failed, errno %d, the memory is not locked", errno);
+    }
+
+    /*
+     * rtEnterThread for the calling thread, it keeps its period without the priority
+     * */
+    void logRtEnterThread(Logger* logger, const RtConfig* config)
+    {
+        if( rtEnterThread(config) != 0 )
+            LOG_AT(logger, LOGGER_WARN, LOGGER_NODE, "SCHED_FIFO %d on cpu %d failed, errno %d, the control runs at the default priority",
+                    config->priority, config->cpu, errno);
+        else
+            LOG_AT(logger, LOGGER_INFO, LOGGER_NODE, "control thread SCHED_FIFO %d on cpu %d", config->priority, config->cpu);
+    }
+
+    /*
+     * jitter report of @period and what its mailbox replaced or cut, a warning when a message was cut
+     * */
+    void logRtPeriod(Logger* logger, const RtPeriod* period, const RtMailbox* mailbox)
+    {
+        LOG_AT(logger, mailbox->truncated ? LOGGER_WARN : LOGGER_INFO, LOGGER_NODE,
+                "%lu periods of %llu us, %lu overruns, %lu deadlines missed, %lu of %lu messages replaced before the control took them, %lu truncated to the slot",
+                period->cycles, (unsigned long long)(period->periodNs / 1000), period->overruns, period->missed,
+                mailbox->replaced, mailbox->posted, mailbox->truncated);
+    }
@@ -0,0 +1,215 @@
+#include<string.h>
+#include<math.h>
+#include"ps_track.h"
+
+    //home bucket of @id, Fibonacci hashing, the ids of the sensor are small and consecutive
+    static int homeBucket(const ObjectTable* table, uint64_t id)
+    {
+        return (int)((id * 0x9E3779B97F4A7C15ull) >> 32) & table->mask;
+    }
+
+    //bucket holding @id, or the empty bucket where it would go
+    static int findBucket(const ObjectTable* table, uint64_t id)
+    {
+        int b = homeBucket(table, id);
+
+        while( table->bucket[b] != 0 && table->object[table->bucket[b] - 1].id != id )
+            b = (b + 1) & table->mask;
+        return b;
+    }
+
+    //smallest gap and smallest ttc of the path, after the one holding them changed
+    static void rescanPath(ObjectTable* table)
+    {
+        const TrackedObject* object = table->object;
+        int k, i;
+
+        table->closest = table->soonest = -1;
+        for( k = 0; k < table->pathCount; k++ )
+        {
+            i = table->path[k];
+            if( table->closest < 0 || object[i].gap < object[table->closest].gap )
+                table->closest = i;
+            if( table->soonest < 0 || object[i].ttc < object[table->soonest].ttc )
+                table->soonest = i;
+        }
+    }
+
+    static void leavePath(ObjectTable* table, int i)
+    {
+        TrackedObject* object = table->object;
+        int last = table->path[--table->pathCount];
+
+        table->path[object[i].path] = last;
+        object[last].path = object[i].path;
+        object[i].path = -1;
+    }
+
+    //the bucket, the live entry and the path entry of pool index @i, linear probing without tombstones
+    static void removeObject(ObjectTable* table, int i)
+    {
+        TrackedObject* object = table->object;
+        int b = findBucket(table, object[i].id);
+        int next = b;
+        int home, last;
+
+        if( object[i].path >= 0 )
+            leavePath(table, i);
+
+        //the entries after @b that can not be found anymore are shifted back into it
+        for( ; ; )
+        {
+            next = (next + 1) & table->mask;
+            if( table->bucket[next] == 0 )
+                break;
+            home = homeBucket(table, object[table->bucket[next] - 1].id);
+            if( ((next - home) & table->mask) >= ((next - b) & table->mask) )
+            {
+                table->bucket[b] = table->bucket[next];
+                b = next;
+            }
+        }
+        table->bucket[b] = 0;
+
+        last = table->live[--table->count];
+        table->live[object[i].live] = last;
+        object[last].live = object[i].live;
+        table->spare[table->spares++] = i;
+    }
+
+    /*
+     * allocate a table for messages of up to @capacity objects, the path is @pathWidth wide and centered on the car
+     *  the objects gone are only freed by endObjectFrame, so the pool holds two messages
+     *  return 0, or -1 if the memory is not there
+     * */
+    int initialObjectTable(ObjectTable* table, int capacity, double pathWidth)
+    {
+        int buckets = 1;
+        int i;
+
+        memset(table, 0, sizeof(*table));
+        capacity *= 2;
+        while( buckets < 2 * capacity )
+            buckets <<= 1;
+        table->halfPath = pathWidth / 2;
+        table->capacity = capacity;
+        table->mask = buckets - 1;
+        table->bucket = (int*)calloc(buckets, sizeof(int));
+        table->object = (TrackedObject*)calloc(capacity, sizeof(TrackedObject));
+        table->live = (int*)malloc(sizeof(int) * capacity);
+        table->spare = (int*)malloc(sizeof(int) * capacity);
+        table->path = (int*)malloc(sizeof(int) * capacity);
+        if( !table->bucket || !table->object || !table->live || !table->spare || !table->path )
+        {
+            destroyObjectTable(table);
+            return -1;
+        }
+        //the lowest indices are taken first
+        for( i = 0; i < capacity; i++ )
+            table->spare[i] = capacity - 1 - i;
+        table->spares = capacity;
+        table->closest = table->soonest = -1;
+        return 0;
+    }
+
+    void destroyObjectTable(ObjectTable* table)
+    {
+        free(table->bucket);
+        free(table->object);
+        free(table->live);
+        free(table->spare);
+        free(table->path);
+        memset(table, 0, sizeof(*table));
+        table->closest = table->soonest = -1;
+    }
+
+    /*
+     * start a message, the objects it does not update are forgotten by endObjectFrame
+     * */
+    void beginObjectFrame(ObjectTable* table)
+    {
+        table->frame++;
+    }
+
+    /*
+     * the object @id of the message at @position of @size, moving at @velocity relative to the car
+     *  it is added if it is new, then moved in or out of the path and the answers of the AEB follow
+     *  return the tracked object, NULL if it is new and the table is full
+     * */
+    const TrackedObject* updateObject(ObjectTable* table, uint64_t id, const double* position, const double* size, const double* velocity)
+    {
+        TrackedObject* object = NULL;
+        int b = findBucket(table, id);
+        int i, inPath;
+        double closing;
+
+        if( table->bucket[b] == 0 )
+        {
+            if( table->spares == 0 )
+            {
+                table->dropped++;
+                return NULL;
+            }
+            i = table->spare[--table->spares];
+            table->bucket[b] = i + 1;
+            table->object[i].id = id;
+            table->object[i].path = -1;
+            table->object[i].live = table->count;
+            table->live[table->count++] = i;
+        }
+        i = table->bucket[b] - 1;
+        object = &table->object[i];
+
+        object->frame = table->frame;
+        object->x = position[0];
+        object->y = position[1];
+        object->length = size[0];
+        object->width = size[1];
+        object->vx = velocity[0];
+        object->vy = velocity[1];
+        object->gap = object->x - object->length / 2 > 0 ? object->x - object->length / 2 : 0;
+        closing = -object->vx;
+        object->ttc = closing > 0 ? object->gap / closing : TRACK_TTC_NONE;
+
+        //ahead of the car and overlapping the path
+        inPath = object->x + object->length / 2 > 0 && fabs(object->y) - object->width / 2 < table->halfPath;
+        if( inPath && object->path < 0 )
+        {
+            object->path = table->pathCount;
+            table->path[table->pathCount++] = i;
+        }
+        else if( !inPath && object->path >= 0 )
+            leavePath(table, i);
+
+        //only a change of the object holding an answer needs the path again
+        if( table->closest == i || table->soonest == i )
+            rescanPath(table);
+        else if( inPath )
+        {
+            if( table->closest < 0 || object->gap < table->object[table->closest].gap )
+                table->closest = i;
+            if( table->soonest < 0 || object->ttc < table->object[table->soonest].ttc )
+                table->soonest = i;
+        }
+        return object;
+    }
+
+    /*
+     * end a message: the objects it did not carry are no longer tracked
+     * */
+    void endObjectFrame(ObjectTable* table)
+    {
+        int k, i;
+        int rescan = 0;
+
+        for( k = table->count - 1; k >= 0; k-- )
+        {
+            i = table->live[k];
+            if( table->object[i].frame == table->frame )
+                continue;
+            rescan |= table->closest == i || table->soonest == i;
+            removeObject(table, i);
+        }
+        if( rescan )
+            rescanPath(table);
+    }
@@ -0,0 +1,353 @@
+#define _GNU_SOURCE
+#include<string.h>
+#include<errno.h>
+#include<unistd.h>
+#include<arpa/inet.h>
+#include<sys/socket.h>
+#include<sys/uio.h>
+#include"ps_wire.h"
+
+    //byte by byte, so the layout does not depend on the endianness or the padding of the host
+    static void putU16(unsigned char* p, uint16_t v)
+    {
+        p[0] = (unsigned char)v;
+        p[1] = (unsigned char)(v >> 8);
+    }
+
+    static void putU32(unsigned char* p, uint32_t v)
+    {
+        p[0] = (unsigned char)v;
+        p[1] = (unsigned char)(v >> 8);
+        p[2] = (unsigned char)(v >> 16);
+        p[3] = (unsigned char)(v >> 24);
+    }
+
+    static void putU64(unsigned char* p, uint64_t v)
+    {
+        putU32(p, (uint32_t)v);
+        putU32(p + 4, (uint32_t)(v >> 32));
+    }
+
+    static void putFloat(unsigned char* p, float v)
+    {
+        uint32_t bits;
+
+        memcpy(&bits, &v, sizeof(bits));
+        putU32(p, bits);
+    }
+
+    static uint16_t getU16(const unsigned char* p)
+    {
+        return (uint16_t)(p[0] | p[1] << 8);
+    }
+
+    static uint32_t getU32(const unsigned char* p)
+    {
+        return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    }
+
+    static uint64_t getU64(const unsigned char* p)
+    {
+        return (uint64_t)getU32(p) | (uint64_t)getU32(p + 4) << 32;
+    }
+
+    static float getFloat(const unsigned char* p)
+    {
+        uint32_t bits = getU32(p);
+        float v;
+
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    /*
+     * datagrams needed to send @count records, at least one
+     * */
+    int wireFragments(int count)
+    {
+        if( count <= 0 )
+            return 1;
+        return (count + WIRE_RECORDS_PER_DATAGRAM - 1) / WIRE_RECORDS_PER_DATAGRAM;
+    }
+
+    /*
+     * records of the frame @frame sent in datagram @fragment
+     * */
+    int wireFragmentRecords(const WireFrame* frame, int fragment)
+    {
+        int left = frame->count - fragment * WIRE_RECORDS_PER_DATAGRAM;
+
+        if( left <= 0 )
+            return 0;
+        return left < WIRE_RECORDS_PER_DATAGRAM ? left : WIRE_RECORDS_PER_DATAGRAM;
+    }
+
+    /*
+     * write the header of datagram @fragment of the frame @frame at @datagram
+     *  return the size of the whole datagram once its records are written after the header
+     * */
+    size_t encodeWireHeader(unsigned char* datagram, const WireFrame* frame, int fragment)
+    {
+        int records = wireFragmentRecords(frame, fragment);
+
+        putU32(datagram, WIRE_MAGIC);
+        putU16(datagram + 4, WIRE_VERSION);
+        putU16(datagram + 6, frame->kind);
+        putU32(datagram + 8, frame->sequence);
+        putU16(datagram + 12, (uint16_t)fragment);
+        putU16(datagram + 14, (uint16_t)wireFragments(frame->count));
+        putU64(datagram + 16, frame->timestamp);
+        putU16(datagram + 24, (uint16_t)records);
+        putU16(datagram + 26, WIRE_RECORD_SIZE);
+        putU32(datagram + 28, (uint32_t)(frame->count > 0 ? frame->count : 0));
+        return WIRE_HEADER_SIZE + (size_t)records * WIRE_RECORD_SIZE;
+    }
+
+    /*
+     * write the record @record at @p, WIRE_RECORD_SIZE bytes
+     * */
+    void encodeWireRecord(unsigned char* p, const WireRecord* record)
+    {
+        int k;
+
+        putU64(p, record->id);
+        putU32(p + 8, record->points);
+        putU32(p + 12, record->classification);
+        for( k = 0; k < 3; k++ )
+        {
+            putFloat(p + 16 + 4 * k, record->centroid[k]);
+            putFloat(p + 28 + 4 * k, record->min[k]);
+            putFloat(p + 40 + 4 * k, record->max[k]);
+            putFloat(p + 52 + 4 * k, record->velocity[k]);
+        }
+    }
+
+    /*
+     * write datagram @fragment of the frame @frame, header and records, at @datagram
+     *  of at least WIRE_DATAGRAM_SIZE bytes, return its size
+     * */
+    size_t encodeWire(unsigned char* datagram, const WireFrame* frame, int fragment)
+    {
+        const WireRecord* record = frame->record + fragment * WIRE_RECORDS_PER_DATAGRAM;
+        size_t size = encodeWireHeader(datagram, frame, fragment);
+        int records = wireFragmentRecords(frame, fragment);
+        int i;
+
+        for( i = 0; i < records; i++ )
+            encodeWireRecord(datagram + WIRE_HEADER_SIZE + i * WIRE_RECORD_SIZE, &record[i]);
+        return size;
+    }
+
+    /*
+     * read the header of the datagram @datagram of @size bytes
+     *  return 0 if it is a datagram of this version holding all its records, -1 otherwise
+     * */
+    int decodeWireHeader(WireHeader* header, const unsigned char* datagram, size_t size)
+    {
+        if( size < WIRE_HEADER_SIZE )
+            return -1;
+        header->magic = getU32(datagram);
+        header->version = getU16(datagram + 4);
+        header->kind = getU16(datagram + 6);
+        header->sequence = getU32(datagram + 8);
+        header->fragment = getU16(datagram + 12);
+        header->fragments = getU16(datagram + 14);
+        header->timestamp = getU64(datagram + 16);
+        header->records = getU16(datagram + 24);
+        header->recordSize = getU16(datagram + 26);
+        header->total = getU32(datagram + 28);
+        if( header->magic != WIRE_MAGIC || header->version != WIRE_VERSION
+                || header->recordSize < WIRE_RECORD_SIZE || header->fragment >= header->fragments
+                || size < WIRE_HEADER_SIZE + (size_t)header->records * header->recordSize )
+            return -1;
+        return 0;
+    }
+
+    /*
+     * read the record at @p, the fields appended by later versions are ignored
+     * */
+    void decodeWireRecord(WireRecord* record, const unsigned char* p)
+    {
+        int k;
+
+        record->id = getU64(p);
+        record->points = getU32(p + 8);
+        record->classification = getU32(p + 12);
+        for( k = 0; k < 3; k++ )
+        {
+            record->centroid[k] = getFloat(p + 16 + 4 * k);
+            record->min[k] = getFloat(p + 28 + 4 * k);
+            record->max[k] = getFloat(p + 40 + 4 * k);
+            record->velocity[k] = getFloat(p + 52 + 4 * k);
+        }
+    }
+
+    /*
+     * open a UDP socket sending to @address:@port, with a pool of @capacity datagrams
+     *  return 0 on success, -1 on error
+     * */
+    int openWireSender(WireSender* sender, const char* address, int port, int capacity)
+    {
+        memset(sender, 0, sizeof(*sender));
+        sender->fd = -1;
+        sender->mode = WIRE_SEND_BATCH;
+        sender->address.sin_family = AF_INET;
+        sender->address.sin_port = htons((uint16_t)port);
+        if( inet_pton(AF_INET, address, &sender->address.sin_addr) != 1 )
+        {
+            printf("invalid address(%s)!\n", address);
+            return -1;
+        }
+        if( (sender->fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0 )
+        {
+            printf("socket error!\n");
+            return -1;
+        }
+        if( reserveWireSender(sender, capacity > 0 ? capacity : 1) != 0 )
+        {
+            closeWireSender(sender);
+            return -1;
+        }
+        return 0;
+    }
+
+    void closeWireSender(WireSender* sender)
+    {
+        if( sender->fd >= 0 )
+            close(sender->fd);
+        free(sender->buffer);
+        free(sender->iov);
+        free(sender->msg);
+        sender->fd = -1;
+        sender->capacity = 0;
+        sender->buffer = NULL;
+        sender->iov = NULL;
+        sender->msg = NULL;
+    }
+
+    /*
+     * grow the pool to at least @count datagrams, only a frame larger than all the previous ones allocates
+     *  return 0 on success, -1 if it can not grow
+     * */
+    int reserveWireSender(WireSender* sender, int count)
+    {
+        unsigned char* buffer;
+        struct iovec* iov;
+        struct mmsghdr* msg;
+
+        if( count <= sender->capacity )
+            return 0;
+        if( (buffer = (unsigned char*)realloc(sender->buffer, (size_t)count * WIRE_DATAGRAM_SIZE)) == NULL )
+            return -1;
+        sender->buffer = buffer;
+        if( (iov = (struct iovec*)realloc(sender->iov, sizeof(*iov) * count)) == NULL )
+            return -1;
+        sender->iov = iov;
+        if( (msg = (struct mmsghdr*)realloc(sender->msg, sizeof(*msg) * count)) == NULL )
+            return -1;
+        sender->msg = msg;
+        memset(msg, 0, sizeof(*msg) * count);
+        sender->capacity = count;
+        return 0;
+    }
+
+    /*
+     * buffer of datagram @index of the pool, WIRE_DATAGRAM_SIZE bytes
+     * */
+    unsigned char* wireDatagram(WireSender* sender, int index)
+    {
+        return sender->buffer + (size_t)index * WIRE_DATAGRAM_SIZE;
+    }
+
+    /*
+     * send the first @count datagrams of the pool, reserved with reserveWireSender and each one sized by the
+     * records count of its header
+     *  return 0 if all were sent, -1 otherwise
+     * */
+    int sendWireDatagrams(WireSender* sender, int count)
+    {
+        int sent = 0, r, i;
+
+        //one message per datagram, no copy, the pool is sent in place
+        for( i = 0; i < count; i++ )
+        {
+            unsigned char* datagram = wireDatagram(sender, i);
+
+            sender->iov[i].iov_base = datagram;
+            sender->iov[i].iov_len = WIRE_HEADER_SIZE + (size_t)(datagram[24] | datagram[25] << 8) * WIRE_RECORD_SIZE;
+            sender->msg[i].msg_hdr.msg_name = &sender->address;
+            sender->msg[i].msg_hdr.msg_namelen = sizeof(sender->address);
+            sender->msg[i].msg_hdr.msg_iov = &sender->iov[i];
+            sender->msg[i].msg_hdr.msg_iovlen = 1;
+        }
+        sender->stats.frames++;
+
+        //a lone datagram is cheaper with sendto
+        while( sent < count && count > 1 && sender->mode == WIRE_SEND_BATCH )
+        {
+            r = sendmmsg(sender->fd, sender->msg + sent, (unsigned int)(count - sent), 0);
+            if( r < 0 && errno == EINTR )
+                continue;
+            if( r < 0 && errno == ENOSYS )
+            {
+                sender->mode = WIRE_SEND_SINGLE;
+                break;
+            }
+            if( r < 0 )
+            {
+                sender->stats.errors++;
+                return -1;
+            }
+            sent += r;
+            sender->stats.calls++;
+            sender->stats.datagrams += (unsigned long)r;
+        }
+
+        while( sent < count )
+        {
+            if( sendto(sender->fd, sender->iov[sent].iov_base, sender->iov[sent].iov_len, 0,
+                    (const struct sockaddr*)&sender->address, sizeof(sender->address)) < 0 )
+            {
+                if( errno == EINTR )
+                    continue;
+                sender->stats.errors++;
+                return -1;
+            }
+            sent++;
+            sender->stats.calls++;
+            sender->stats.datagrams++;
+        }
+        return 0;
+    }
+
+    /*
+     * encode all the datagrams of the frame @frame into the pool, to be sent with sendWireDatagrams
+     *  return the number of datagrams, -1 if the pool can not grow
+     * */
+    int encodeWireFrame(WireSender* sender, const WireFrame* frame)
+    {
+        int fragments = wireFragments(frame->count);
+        int i;
+
+        if( reserveWireSender(sender, fragments) != 0 )
+        {
+            sender->stats.errors++;
+            return -1;
+        }
+        for( i = 0; i < fragments; i++ )
+            encodeWire(wireDatagram(sender, i), frame, i);
+        return fragments;
+    }
+
+    /*
+     * encode the frame @frame into the pool and send all its datagrams
+     *  return 0 if all were sent, -1 otherwise
+     * */
+    int sendWireFrame(WireSender* sender, const WireFrame* frame)
+    {
+        int fragments = encodeWireFrame(sender, frame);
+
+        if( fragments < 0 )
+            return -1;
+        return sendWireDatagrams(sender, fragments);
+    }
@@ -0,0 +1,349 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<math.h>
+#include"ps_wire.h"
+#include"ps_track.h"
+#include"ps_brake.h"
+#include"ps_lane.h"
+
+#define TEST_WIRE_RECORDS   100     //records of the frame, several datagrams
+#define TEST_TRACK_MESSAGES 500
+#define TEST_TRACK_OBJECTS  128
+#define TEST_TRACK_PATH     2.0     //width of the path of the car, as CAR_WIDTH of the nodes
+#define TEST_TRACK_CHURN    0.05    //share of the objects replaced by a new id every message
+#define TEST_LANE_FRAMES    200
+#define TEST_LANE_CONES     60
+#define TEST_LANE_WIDTH     3.5     //of the track between the cones
+#define TEST_LANE_KNOCKED   0.1     //share of the cones moved off the boundary
+
+    static double uniform(double low, double high)
+    {
+        return low + (high - low) * rand() / (double)RAND_MAX;
+    }
+
+    /*
+     * a frame encoded datagram by datagram and decoded again has its header and every record
+     * */
+    static int testWire()
+    {
+        WireRecord record[TEST_WIRE_RECORDS], decoded;
+        unsigned char datagram[WIRE_DATAGRAM_SIZE];
+        WireHeader header;
+        WireFrame frame;
+        size_t size;
+        int i, k, f, fragments, seen = 0;
+
+        memset(record, 0, sizeof(record));
+        for( i = 0; i < TEST_WIRE_RECORDS; i++ )
+        {
+            record[i].id = 0x0123456789ABCDEFULL + i;
+            record[i].points = (uint32_t)i * 3;
+            record[i].classification = (uint32_t)i % 7;
+            for( k = 0; k < 3; k++ )
+            {
+                record[i].centroid[k] = (float)uniform(-50, 50);
+                record[i].min[k] = record[i].centroid[k] - 1;
+                record[i].max[k] = record[i].centroid[k] + 1;
+                record[i].velocity[k] = (float)uniform(-20, 20);
+            }
+        }
+        frame.kind = WIRE_KIND_OBJECTS;
+        frame.sequence = 42;
+        frame.timestamp = 1234567890123ULL;
+        frame.record = record;
+        frame.count = TEST_WIRE_RECORDS;
+        fragments = wireFragments(frame.count);
+        for( f = 0; f < fragments; f++ )
+        {
+            size = encodeWire(datagram, &frame, f);
+            if( decodeWireHeader(&header, datagram, size) != 0 || header.kind != frame.kind
+                    || header.sequence != frame.sequence || header.timestamp != frame.timestamp
+                    || header.fragment != f || header.fragments != fragments || header.total != (uint32_t)frame.count )
+            {
+                printf("header of datagram %d of %d does not decode\n", f, fragments);
+                return -1;
+            }
+            for( i = 0; i < header.records; i++, seen++ )
+            {
+                decodeWireRecord(&decoded, datagram + WIRE_HEADER_SIZE + i * header.recordSize);
+                if( memcmp(&decoded, &record[seen], sizeof(decoded)) != 0 )
+                {
+                    printf("record %d does not decode\n", seen);
+                    return -1;
+                }
+            }
+        }
+        if( seen != TEST_WIRE_RECORDS )
+        {
+            printf("%d records decoded instead of %d\n", seen, TEST_WIRE_RECORDS);
+            return -1;
+        }
+        return 0;
+    }
+
+    //objects of a message of the LUX, x y length width vx vy
+    typedef struct TestObject
+    {
+        uint64_t id;
+        double position[2];
+        double size[2];
+        double velocity[2];
+    }TestObject;
+
+    static void makeObject(TestObject* object, uint64_t id)
+    {
+        object->id = id;
+        object->position[0] = uniform(-10, 80);
+        object->position[1] = uniform(-15, 15);
+        object->size[0] = uniform(0.5, 5);
+        object->size[1] = uniform(0.5, 2);
+        object->velocity[0] = uniform(-15, 5);
+        object->velocity[1] = uniform(-1, 1);
+    }
+
+    //the closest object in the path the way the handlers found it, a scan of the message
+    static int scanClosest(const TestObject* object, int count, double* best)
+    {
+        int i, closest = -1;
+        double gap;
+        for( i = 0; i < count; i++ )
+        {
+            if( object[i].position[0] + object[i].size[0] / 2 <= 0 || fabs(object[i].position[1]) - object[i].size[1] / 2 >= TEST_TRACK_PATH / 2 )
+                continue;
+            gap = object[i].position[0] - object[i].size[0] / 2;
+            gap = gap > 0 ? gap : 0;
+            if( closest < 0 || gap < *best )
+            {
+                closest = i;
+                *best = gap;
+            }
+        }
+        return closest;
+    }
+
+    /*
+     * the closest object of the table, updated object by object, against a scan of every message
+     * */
+    static int testTrack()
+    {
+        TestObject object[TEST_TRACK_OBJECTS];
+        ObjectTable table;
+        const TrackedObject* closest;
+        double best = 0;
+        uint64_t next = 1;
+        int m, i, found, failed = 0;
+
+        if( initialObjectTable(&table, TRACK_OBJECTS, TEST_TRACK_PATH) != 0 )
+        {
+            printf("test track malloc error!\n");
+            return -1;
+        }
+        for( i = 0; i < TEST_TRACK_OBJECTS; i++ )
+            makeObject(&object[i], next++);
+        for( m = 0; m < TEST_TRACK_MESSAGES && !failed; m++ )
+        {
+            //a period of 80ms, some objects leave and others come in
+            for( i = 0; i < TEST_TRACK_OBJECTS; i++ )
+            {
+                if( uniform(0, 1) < TEST_TRACK_CHURN )
+                    makeObject(&object[i], next++);
+                object[i].position[0] += object[i].velocity[0] * 0.08;
+                object[i].position[1] += object[i].velocity[1] * 0.08;
+            }
+            beginObjectFrame(&table);
+            for( i = 0; i < TEST_TRACK_OBJECTS; i++ )
+                (void)updateObject(&table, object[i].id, object[i].position, object[i].size, object[i].velocity);
+            endObjectFrame(&table);
+
+            found = scanClosest(object, TEST_TRACK_OBJECTS, &best);
+            closest = closestObject(&table);
+            if( (found < 0) != (closest == NULL) || (closest && closest->gap != best) )
+            {
+                printf("closest object of the table differs from the scan at message %d\n", m);
+                failed = 1;
+            }
+        }
+        if( table.dropped > 0 )
+        {
+            printf("%lu updates dropped, the table was full\n", table.dropped);
+            failed = 1;
+        }
+        destroyObjectTable(&table);
+        return failed ? -1 : 0;
+    }
+
+    /*
+     * required deceleration against values worked out by hand, reaction 0.5 s and margin 2 m
+     *  room = gap - margin - closing * reaction, the car at 10 m/s unless said otherwise:
+     *  still object        closing 10, gap 32, room 25: 10 * 10 / 50 = 2
+     *  leading at 4 m/s    closing 6, gap 23, room 18: 6 * 6 / 36 = 1
+     *  receding            closing -3: 0
+     *  oncoming at 5 m/s   closing 15, gap 34.5, room 25: the car stops in 2.5 s over 12.5 m while
+     *                      the object comes 12.5 m, 10 * (30 - 10) / 50 = 4
+     *  the same, car still nothing to brake away from it: 0
+     *  the same, no CAN    taken as still at the closing speed: 15 * 15 / 50 = 4.5
+     *  gap of 5            no room left: HUGE_VAL
+     * then a path longer than pathObjects, of which the soonest, the closest and pathObjects others are evaluated
+     * */
+    static int testBrake()
+    {
+        static const struct
+        {
+            const char* name;
+            double vx;
+            double gap;
+            double egoSpeed;
+            double decel;
+        }brake_case[] = {
+            {"still", -10, 32, 10, 2},
+            {"leading", -6, 23, 10, 1},
+            {"receding", 3, 32, 10, 0},
+            {"oncoming", -15, 34.5, 10, 4},
+            {"oncoming, car still", -15, 34.5, 0, 0},
+            {"oncoming, no CAN", -15, 34.5, BRAKE_EGO_UNKNOWN, 4.5},
+            {"no room", -10, 5, 10, HUGE_VAL},
+        };
+        BrakeEnvelope envelope;
+        BrakeDemand demand;
+        ObjectTable table;
+        TrackedObject object;
+        double decel, position[2], size[2] = {1, 1}, velocity[2] = {-5, 0};
+        int c, failed = 0;
+
+        initialBrakeEnvelope(&envelope);
+        envelope.reaction = 0.5;
+        envelope.margin = 2;
+        memset(&object, 0, sizeof(object));
+        for( c = 0; c < (int)(sizeof(brake_case) / sizeof(brake_case[0])); c++ )
+        {
+            object.vx = brake_case[c].vx;
+            object.gap = brake_case[c].gap;
+            decel = requiredDeceleration(&envelope, &object, brake_case[c].egoSpeed);
+            if( !(decel == brake_case[c].decel || fabs(decel - brake_case[c].decel) < 1e-12) )
+            {
+                printf("%s object needs %g m/s^2 instead of %g\n", brake_case[c].name, decel, brake_case[c].decel);
+                failed = 1;
+            }
+        }
+
+        if( initialObjectTable(&table, TRACK_OBJECTS, TEST_TRACK_PATH) != 0 )
+        {
+            printf("test brake malloc error!\n");
+            return -1;
+        }
+        envelope.pathObjects = 10;
+        beginObjectFrame(&table);
+        for( c = 0; c < 4 * envelope.pathObjects; c++ )
+        {
+            position[0] = 10 + c;
+            position[1] = 0;
+            (void)updateObject(&table, c + 1, position, size, velocity);
+        }
+        endObjectFrame(&table);
+        evaluateBrake(&envelope, &table, 10, &demand);
+        if( demand.evaluated > envelope.pathObjects + 2 || demand.evaluated < envelope.pathObjects + 1 || !demand.truncated )
+        {
+            printf("%d objects of a path of %d evaluated for a cap of %d\n", demand.evaluated, table.pathCount, envelope.pathObjects);
+            failed = 1;
+        }
+        destroyObjectTable(&table);
+        return failed ? -1 : 0;
+    }
+
+    /*
+     * every kernel of the track boundaries fits the lines of the scalar one, from the same gate and seed,
+     * on a drive with knocked cones so the RANSAC fit is taken too
+     * */
+    static int testLane()
+    {
+        double x[TEST_LANE_CONES], y[TEST_LANE_CONES], offset[LANE_SIDES], slope = 0, middle = 0;
+        LaneEstimator lane;
+        LaneGate gate;
+        unsigned int seed;
+        int f, i, side, level, failed = 0;
+
+        if( initialLaneEstimator(&lane, TEST_LANE_CONES) != 0 )
+        {
+            printf("test lane malloc error!\n");
+            return -1;
+        }
+        for( f = 0; f < TEST_LANE_FRAMES && !failed; f++ )
+        {
+            slope = fmin(0.1, fmax(-0.1, slope + uniform(-0.01, 0.01)));
+            middle = fmin(0.5, fmax(-0.5, middle + uniform(-0.05, 0.05)));
+            for( i = 0; i < TEST_LANE_CONES; i++ )
+            {
+                side = i & 1;
+                x[i] = 2 + (LANE_RANGE - 2) * (i / 2) / (TEST_LANE_CONES / 2);
+                y[i] = slope * x[i] + middle + (side == LANE_LEFT ? 1 : -1) * TEST_LANE_WIDTH / 2 + uniform(-0.03, 0.03);
+                if( uniform(0, 1) < TEST_LANE_KNOCKED )
+                    y[i] += (uniform(0, 1) < 0.5 ? -1 : 1) * uniform(0.5, 1.5);
+            }
+
+            //every level from the same gate and seed, the scalar one goes last and is kept
+            gate = lane.gate;
+            seed = lane.seed;
+            for( level = detectSimd(); level >= SIMD_SCALAR; level-- )
+            {
+                lane.gate = gate;
+                lane.seed = seed;
+                lane.kernel = selectLaneKernel(level);
+                if( beginLane(&lane, TEST_LANE_CONES) != 0 )
+                {
+                    printf("test lane malloc error!\n");
+                    destroyLaneEstimator(&lane);
+                    return -1;
+                }
+                for( i = 0; i < TEST_LANE_CONES; i++ )
+                    addLaneCone(&lane, x[i], y[i]);
+                fitLane(&lane);
+                for( side = 0; side < LANE_SIDES; side++ )
+                {
+                    if( level == detectSimd() )
+                        offset[side] = lane.line[side].offset;
+                    else if( fabs(offset[side] - lane.line[side].offset) > 1e-9 )
+                        failed = 1;
+                }
+            }
+            if( failed )
+                printf("the kernels fit different boundaries at message %d\n", f);
+        }
+        destroyLaneEstimator(&lane);
+        return failed ? -1 : 0;
+    }
+
+typedef struct TestCase
+{
+    const char* name;
+    int (*run)(void);
+}TestCase;
+
+static const TestCase test_case[] = {
+    {"wire", testWire},
+    {"track", testTrack},
+    {"brake", testBrake},
+    {"lane", testLane},
+};
+
+//every test, or those named on the command line; the exit status is the number that failed
+int main(int argc, char* argv[])
+{
+    int t, a, selected, failed = 0;
+    srand(1);
+    for( t = 0; t < (int)(sizeof(test_case) / sizeof(test_case[0])); t++ )
+    {
+        for( a = 1, selected = argc == 1; a < argc && !selected; a++ )
+            selected = strcmp(argv[a], test_case[t].name) == 0;
+        if( !selected )
+            continue;
+        if( test_case[t].run() != 0 )
+        {
+            printf("%-12s FAILED\n", test_case[t].name);
+            failed++;
+        }
+        else
+            printf("%-12s ok\n", test_case[t].name);
+    }
+    return failed;
+}
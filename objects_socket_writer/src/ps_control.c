@@ -1,41 +1,69 @@
 #include"ps_control.h"
 #include<math.h>
+#include<string.h>
 
 
-// PID process, return control variables
-void AEB_pid(velocity_error_t *vel, distance_error_t *dis, velocity_distance_error_t *vel_dis)
+// coefficients of the incremental PID, once, and an empty history
+// delta(k) = A0 * e(k) + A1 * e(k-1) + A2 * e(k-2)
+void aeb_init(aeb_controller_t *aeb, double p, double i, double d, double period)
 {
-	double PID_A0 = PID_P*( 1 + PERIOD/PID_I + PID_D/PERIOD);
-	double PID_A1 = -PID_P*( 1 + 2 * PID_D/PERIOD);
-	double PID_A2 = -PID_P * PID_D/PERIOD;
-	
-	vel_dis->error_velocity = 
-			PID_A0 * vel->error[2] + 
-			PID_A1 * vel->error[1] +
-			PID_A2 * vel->error[0];
-		
-	vel_dis->error_distance = 
-			PID_A0 * dis->error[2] + 
-			PID_A1 * dis->error[1] +
-			PID_A2 * dis->error[0];
+	aeb->a0 = p * (1 + period / i + d / period);
+	aeb->a1 = -p * (1 + 2 * d / period);
+	aeb->a2 = p * d / period;
+
+	aeb_reset(aeb);
 }
 
-// testing whether receive four data, in order to active PID program
-int is_receive_four(int num)
+// forget the errors and the command, the coefficients are kept
+void aeb_reset(aeb_controller_t *aeb)
 {
-	if (num >0 && num % 3 ==0 )
-	{
-		//*num = 0;
-		return 1;
-	}
-	else 
+	memset(aeb->error, 0, sizeof(aeb->error));
+	memset(&aeb->delta, 0, sizeof(aeb->delta));
+	memset(&aeb->command, 0, sizeof(aeb->command));
+	aeb->head = 0;
+	aeb->updates = 0;
+}
+
+// push the errors of one object update, return 1 once the history is long enough for @delta and @command
+int aeb_update(aeb_controller_t *aeb, double distance, double velocity)
+{
+	const velocity_distance_error_t *e1 = NULL;
+	const velocity_distance_error_t *e2 = NULL;
+	velocity_distance_error_t *e0 = NULL;
+
+	aeb->head = (aeb->head + 1) & (AEB_HISTORY - 1);
+	aeb->updates++;
+
+	e0 = &aeb->error[aeb->head];
+	e1 = &aeb->error[(aeb->head - 1) & (AEB_HISTORY - 1)];
+	e2 = &aeb->error[(aeb->head - 2) & (AEB_HISTORY - 1)];
+
+	e0->error_velocity = velocity - VELOCITY_EXPECT;
+	e0->error_distance = distance - DISTANCE_EXPECT;
+
+	if (aeb->updates < 3)
 		return 0;
+
+	aeb->delta.error_velocity = 
+			aeb->a0 * e0->error_velocity + 
+			aeb->a1 * e1->error_velocity +
+			aeb->a2 * e2->error_velocity;
+
+	aeb->delta.error_distance = 
+			aeb->a0 * e0->error_distance + 
+			aeb->a1 * e1->error_distance +
+			aeb->a2 * e2->error_distance;
+
+	aeb->command.error_velocity += aeb->delta.error_velocity;
+	aeb->command.error_distance += aeb->delta.error_distance;
+
+	return 1;
 }
 
 // judge whether the objects is in front
 int is_object_front( double y)
 {
-	if(abs(y) < CAR_WIDTH / 2)
+	if(fabs(y) < CAR_WIDTH / 2)
 		return 1;
 	else
 		return 0;
@@ -58,30 +86,3 @@ double return_velocity(double x, double y)
 	
 	return sqrt(x*x*temp_x + y*y*temp_y);
 }
-
-void ps_memory(velocity_distance_t *data, 
-			   velocity_distance_error_t *vel_dis,
-			   velocity_error_t *vel_err,
-			   distance_error_t *dis_err)
-{
-	data = (struct  velocity_distance*)malloc(sizeof(struct  velocity_distance));
-    
-    vel_dis = (struct  velocity_distance_error*)malloc(sizeof(struct  velocity_distance_error))  ;
-    
-    vel_err = (struct  velocity_error*)malloc(sizeof(struct  velocity_error));
-    
-    dis_err = (struct  distance_error*)malloc(sizeof(struct  distance_error));
-}
-
-void ps_free_memory(velocity_distance_t *data, 
-			   velocity_distance_error_t *vel_dis,
-			   velocity_error_t *vel_err,
-			   distance_error_t *dis_err)
-{
-	free(data);
-	free(vel_dis);
-	free(vel_err);
-	free(dis_err);
-}
-	
-
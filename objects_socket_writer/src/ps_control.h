@@ -1,14 +1,17 @@
 #ifndef PS_CONTROL_H_
 #define PS_CONTROL_H_
 
-static double BRAKE_MAX = 60.0;  //deg
-static double VELOCITY_EXPECT = 0.0; // M
-static double DISTANCE_EXPECT = 0.5; // M
-static double PID_P = 3.0;
-static double PID_I = 0.1;
-static double PID_D = 3.0;
-static double PERIOD = 0.08;
-static double CAR_WIDTH = 20.0;
+#define BRAKE_MAX (60.0)  //deg
+#define VELOCITY_EXPECT (0.0) // M
+#define DISTANCE_EXPECT (0.5) // M
+#define PID_P (3.0)
+#define PID_I (0.1)
+#define PID_D (3.0)
+#define PERIOD (0.08)
+#define CAR_WIDTH (2.0)   // M, width of the path in front
+
+// errors kept by the controller, a power of two, the PID reads the last 3
+#define AEB_HISTORY (4)
 
 
 typedef struct velocity_distance_error
@@ -17,34 +20,27 @@ typedef struct velocity_distance_error
 	double error_distance;
 } velocity_distance_error_t;
 
-typedef struct velocity_error
-{
-	double error[3];
-} velocity_error_t;
-
-typedef struct distance_error
-{
-	double error[3];
-} distance_error_t;
-
-typedef struct velocity_distance
+// incremental PID on the velocity and the distance of the closest object in front
+// the controller owns its history across frames, an update only writes one slot of the ring
+// and reads the coefficients computed by aeb_init, there is no allocation
+typedef struct aeb_controller
 {
-	double velocity[4];
-	double distance[4];
-} velocity_distance_t;
-
-
-
-void AEB_pid(velocity_error_t *vel, distance_error_t *dis, velocity_distance_error_t *vel_dis);
-int is_receive_four(int num);
+	double a0;                                      // PID_A0, PID_A1 and PID_A2 of the gains
+	double a1;
+	double a2;
+	velocity_distance_error_t error[AEB_HISTORY];   // ring of the errors, newest at @head
+	unsigned int head;
+	unsigned long updates;                          // errors pushed since the last reset
+	velocity_distance_error_t delta;                // increment of the last update
+	velocity_distance_error_t command;              // sum of the increments since the last reset
+} aeb_controller_t;
+
+
+void aeb_init(aeb_controller_t *aeb, double p, double i, double d, double period);
+void aeb_reset(aeb_controller_t *aeb);
+int aeb_update(aeb_controller_t *aeb, double distance, double velocity);
 int is_object_front( double y);
 int is_velocity_right(double x);
 double return_velocity(double x, double y);
 
-void ps_memory(velocity_distance_t *, 
-			   velocity_distance_error_t *,
-			   velocity_error_t *,
-			   distance_error_t *);
-
 #endif
-
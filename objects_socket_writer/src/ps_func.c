@@ -1,87 +1,114 @@
 #include"ps_func.h"
-int  ps_socket_send(ps_socket *socket, unsigned char *buffer)
+static unsigned int objects_sequence = 0;
+
+
+// send the objects of @message as a WIRE_KIND_OBJECTS frame, one datagram per WIRE_RECORDS_PER_DATAGRAM objects,
+// all encoded in the buffers of @sender and sent in one batch
+int  ps_socket_send(WireSender *sender, const ps_msg_ref const message)
 {
-	int ret = DTC_NONE;
-	unsigned long buffer_size = 0;
-    unsigned long bytes_written = 0;
+	const ps_objects_msg * const objects_msg = (ps_objects_msg*) message;
+	const ps_object *_buffer = objects_msg->objects._buffer;
+	unsigned long objects_index = 0;
+    unsigned char *datagram = NULL;
+    int fragment = 0;
+    int fragments = 0;
+    int records = 0;
+    int i = 0;
+    int k = 0;
+    WireFrame frame;
+    WireRecord record;
     
     
-    // zero
-    memset( buffer, 0, sizeof(buffer) );
+    // the records are encoded straight from the message
+    frame.kind = WIRE_KIND_OBJECTS;
+    frame.sequence = objects_sequence++;
+    frame.timestamp = (uint64_t) objects_msg->header.timestamp;
+    frame.record = NULL;
+    frame.count = (int) objects_msg->objects._length;
     
-    // copy bytes into buffer
-    strcpy( buffer, "message from socket write");
+    fragments = wireFragments(frame.count);
+    
+    if( reserveWireSender(sender, fragments) != 0 )
+    {
+        return DTC_MEMERR;
+    }
+    
+    for( fragment = 0; fragment < fragments; fragment++ )
+    {
+        datagram = wireDatagram(sender, fragment);
+        (void) encodeWireHeader(datagram, &frame, fragment);
+        records = wireFragmentRecords(&frame, fragment);
+        
+        for( i = 0; i < records; i++, objects_index++ )
+        {
+            record.id = (uint64_t) _buffer[objects_index].id;
+            record.points = 0;
+            record.classification = (uint32_t) _buffer[objects_index].classification;
+            
+            // the bounding box is centered on the position
+            for( k = 0; k < 3; k++ )
+            {
+                record.centroid[k] = (float) _buffer[objects_index].position[k];
+                record.min[k] = (float) (_buffer[objects_index].position[k] - _buffer[objects_index].size[k] / 2.0);
+                record.max[k] = (float) (_buffer[objects_index].position[k] + _buffer[objects_index].size[k] / 2.0);
+                record.velocity[k] = (float) _buffer[objects_index].velocity[k];
+            }
+            
+            encodeWireRecord(datagram + WIRE_HEADER_SIZE + i * WIRE_RECORD_SIZE, &record);
+        }
+    }
     
-    // set buffer size
-    buffer_size = strlen(buffer) + 1;
-
-	printf( "writing socket buffer '%s' - %lu bytes\n",
-            buffer,
-            buffer_size );
-
     // send data
-    ret = psync_socket_send_to(
-            socket,
-            (unsigned char*) buffer,
-            buffer_size,
-            &bytes_written );
-	return ret;
+	return sendWireDatagrams(sender, fragments) == 0 ? DTC_NONE : DTC_IOERR;
 }
 
 
-void ps_printf( const ps_msg_ref const message )
+// log the objects of @message, one record per object, when PS_LOG asks for debug:objects
+void ps_printf( Logger *logger, const ps_msg_ref const message )
 {
 	// cast to message
     const ps_objects_msg * const objects_msg = (ps_objects_msg*) message;
-
-    // print details
-    printf( "received objects message from node 0x%016llX\n", (ps_ull) objects_msg->header.src_guid );
-    printf( "received timestamp 0x%016llX\n", (ps_ull) objects_msg->header.timestamp);
-	
-    unsigned long objects_index = 0;
     const ps_object *_buffer = objects_msg->objects._buffer;
-    
+    unsigned long objects_index = 0;
+
+	// nothing to copy when objects are not logged
+	if( !loggerEnabled( logger, LOGGER_DEBUG, LOGGER_OBJECTS ) )
+	{
+		return;
+	}
+
+	LOG_AT( logger, LOGGER_DEBUG, LOGGER_OBJECTS, "objects message from node 0x%016llX, timestamp 0x%016llX, %lu objects",
+			(ps_ull) objects_msg->header.src_guid,
+			(ps_ull) objects_msg->header.timestamp,
+			(unsigned long) objects_msg->objects._length );
+
     while( objects_index < objects_msg->objects._length )
     {
+		const ps_object * const object = &_buffer[objects_index];
+		const unsigned long classification = (unsigned long) object->classification;
+
+		LOG_AT( logger, LOGGER_DEBUG, LOGGER_OBJECTS,
+				"id 0x%016llX position %f %f %f size %f %f %f velocity %f %f %f course %f class %s quality %llu",
+				(ps_ull) object->id,
+				(double) object->position[0], (double) object->position[1], (double) object->position[2],
+				(double) object->size[0], (double) object->size[1], (double) object->size[2],
+				(double) object->velocity[0], (double) object->velocity[1], (double) object->velocity[2],
+				(double) object->course_angle,
+				classification < sizeof(CLASIFICATION) / sizeof(CLASIFICATION[0]) ? CLASIFICATION[classification] : "unknown",
+				(ps_ull) object->classification_quality );
 
-        printf( "-------------------Publishers objects--------------------\n");
-        printf( "Id = 0x%016llX\n", (ps_ull) _buffer[objects_index].id);
-		printf( "Position:\nx = %016lf\ny = %016lf\nz = %016lf\n",
-                (double) _buffer[objects_index].position[0],
-				(double) _buffer[objects_index].position[1],
-				(double) _buffer[objects_index].position[2]);
-				
-		printf( "Size:\nx = %016lf\ny = %016lf\nz = %016lf\n",
-                (double) _buffer[objects_index].size[0],
-				(double) _buffer[objects_index].size[1],
-				(double) _buffer[objects_index].size[2]);
-		
-		printf( "Velocity:\nx = %016lf\ny = %016lf\nz = %016lf\n",
-                (double) _buffer[objects_index].velocity[0],
-				(double) _buffer[objects_index].velocity[1],
-				(double) _buffer[objects_index].velocity[2]);
-		
-		printf( "Course_angle = %016lf\n", (ps_ull) _buffer[objects_index].course_angle);
-		
-		printf( "Classification = %s\n", CLASIFICATION[(int) _buffer[objects_index].classification]);
-		
-		printf( "Classification quality = %d\n", (ps_ull) _buffer[objects_index].classification_quality);
-		
         objects_index++;
-        
     }
-
-    printf( "\n\n" );
 }
 
-void ps_socket_error(ps_socket* socket)
+void ps_socket_error(WireSender* sender)
 {
 	// check reference since other routines don't
-    if( socket == NULL )
+    if( sender == NULL )
     {
         psync_log_message(
                 LOG_LEVEL_ERROR,
-                "%s : (%u) -- invalid socket",
+                "%s : (%u) -- invalid sender",
                 __FILE__,
                 __LINE__ );
 
@@ -97,7 +124,7 @@ void ps_socket_send_error(int ret)
     {
         psync_log_message(
                 LOG_LEVEL_ERROR,
-                "%s : (%u) -- psync_socket_send_to returned DTC %d",
+                "%s : (%u) -- failed to send the objects, DTC %d",
                 __FILE__,
                 __LINE__,
                 ret );
@@ -114,42 +141,7 @@ void ps_socket_init_error(int ret)
     {
         psync_log_message(
                 LOG_LEVEL_ERROR,
-                "%s : (%u) -- psync_socket_init returned DTC %d",
-                __FILE__,
-                __LINE__,
-                ret );
-
-        //psync_node_activate_fault( node_ref, ret, NODE_STATE_FATAL );
-        return;
-    }
-}
-
-void ps_socket_set_address_error(int ret)
-{
-	// activate fatal error and return if failed
-    if( ret != DTC_NONE )
-    {
-        psync_log_message(
-                LOG_LEVEL_ERROR,
-                "%s : (%u) -- psync_socket_set_address returned DTC %d",
-                __FILE__,
-                __LINE__,
-                ret );
-
-        //psync_node_activate_fault( node_ref, ret, NODE_STATE_FATAL );
-        return;
-    }
-}
-
-
-void ps_socket_set_reuse_option_error(int ret)
-{
-	// activate fatal error and return if failed
-    if( ret != DTC_NONE )
-    {
-        psync_log_message(
-                LOG_LEVEL_ERROR,
-                "%s : (%u) -- psync_socket_set_reuse_option returned DTC %d",
+                "%s : (%u) -- failed to open the UDP output, DTC %d",
                 __FILE__,
                 __LINE__,
                 ret );
@@ -193,6 +185,64 @@ void ps_message_register_listener_error(int ret)
     }
 }
 
+// one log line per stage of @recorder, p50/p99/max so far
+void ps_latency_log(const LatencyRecorder *recorder)
+{
+	char text[160];
+	int stage = 0;
+
+	for( stage = 0; stage < recorder->stages; stage++ )
+	{
+		(void) formatLatency( text, sizeof(text), &recorder->stage[stage] );
+
+		psync_log_message(
+				LOG_LEVEL_INFO,
+				"%s : (%u) -- %s latency %s",
+				__FILE__,
+				__LINE__,
+				recorder->name,
+				text );
+	}
+}
 
+// apply the objects of @message to @table, the objects it does not carry are forgotten
+void ps_track_objects( ObjectTable *table, const ps_msg_ref const message )
+{
+	const ps_objects_msg * const objects_msg = (ps_objects_msg*) message;
+	const ps_object *_buffer = objects_msg->objects._buffer;
+	unsigned long objects_index = 0;
+
+	beginObjectFrame( table );
+
+	for( objects_index = 0; objects_index < objects_msg->objects._length; objects_index++ )
+	{
+		(void) updateObject(
+				table,
+				(uint64_t) _buffer[objects_index].id,
+				_buffer[objects_index].position,
+				_buffer[objects_index].size,
+				_buffer[objects_index].velocity );
+	}
+
+	endObjectFrame( table );
+}
 
-
+// copy the objects of @message for the control thread, those beyond TRACK_OBJECTS are left out
+// and the message is counted in the truncated of the jitter report
+void ps_post_objects( RtMailbox *mailbox, const ps_msg_ref const message )
+{
+	const ps_objects_msg * const objects_msg = (ps_objects_msg*) message;
+	ps_objects_slot * const slot = (ps_objects_slot*) rtMailboxBack( mailbox );
+
+	slot->msg = *objects_msg;
+	slot->msg.objects._maximum = TRACK_OBJECTS;
+	slot->msg.objects._length = fillRtMailbox(
+			mailbox,
+			offsetof( ps_objects_slot, object ),
+			objects_msg->objects._buffer,
+			objects_msg->objects._length,
+			sizeof(ps_object) );
+	slot->msg.objects._buffer = slot->object;
+
+	postRtMailbox( mailbox );
+}
@@ -6,6 +6,9 @@
 #include <stdlib.h>
 #include <signal.h>
 #include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <stddef.h>
 
 // API headers
 #include "polysync_core.h"
@@ -15,6 +18,27 @@
 #include "polysync_socket.h"
 #include "polysync_node_template.h"
 
+// motion CAN of the LUX, the speed of the car
+#include "ibeo_lux_4l_driver.h"
+
+// wire format of the objects
+#include "ps_wire.h"
+
+// stage timings, compiled out without PS_LATENCY
+#include "ps_latency.h"
+
+// asynchronous log, nothing is formatted nor written in the callbacks
+#include "ps_log.h"
+
+// objects kept across messages, the closest in the path is read without a scan
+#include "ps_track.h"
+
+// braking demand from the time to collision of the objects in the path
+#include "ps_brake.h"
+
+// real-time mode of the control, PS_RT
+#include "ps_rt.h"
+
 
 
 
@@ -28,9 +52,26 @@
 
 #define UDP_PORT (9966)
 
+// datagrams the UDP output is allocated for in on_init, a larger message grows it once
+#define WIRE_SENDER_DATAGRAMS (4)
+
+// period of the control thread in the real-time mode, a message waits at most this long
+#define CONTROL_PERIOD_NS (10000000ULL)
+
+// last objects message, copied for the control thread of the real-time mode
+typedef struct ps_objects_slot
+{
+    ps_objects_msg msg;
+    ps_object object[TRACK_OBJECTS];
+} ps_objects_slot;
+
 static const char UDP_ADDRESS[] = "192.168.1.201";
 static const char NODE_NAME[] = "polysync-socket-writer-c";
 static const char OBJECTS_MSG_NAME[] = "ps_objects_msg";
+static const char CAN_FRAME_MSG_NAME[] = "ps_can_frame_msg";
+
+// log of the node, PS_LOG=debug:objects for every object
+static const char LOG_FILE[] = "polysync-objects-socket-writer.log";
 
 typedef unsigned long long ps_ull;
 static const char CLASIFICATION[12][30] = {
@@ -57,6 +98,11 @@ static void ps_objects_msg__handler(
         const ps_msg_ref const message,
         void * const user_data );
 
+static void ps_can_frame_msg__handler(
+        const ps_msg_type msg_type,
+        const ps_msg_ref const message,
+        void * const user_data );
+
 static int set_configuration(
         ps_node_configuration_data * const node_config );
 
@@ -95,15 +141,16 @@ static void on_ok(
 // *****************************************************
 // user-definition function declarations
 // *****************************************************
-void ps_printf( const ps_msg_ref const message );
-void ps_socket_error(ps_socket* socket);
+void ps_printf( Logger *logger, const ps_msg_ref const message );
+void ps_socket_error(WireSender* sender);
 void ps_socket_send_error(int ret);
 void ps_socket_init_error(int ret);
-void ps_socket_set_address_error(int ret);
-void ps_socket_set_reuse_option_error(int ret);
 void ps_message_get_type_by_name_error(int ret);
 void ps_message_register_listener_error(int ret);
-int  ps_socket_send(ps_socket *socket, unsigned char *buf);
+int  ps_socket_send(WireSender *sender, const ps_msg_ref const message);
+void ps_latency_log(const LatencyRecorder *recorder);
+void ps_track_objects( ObjectTable *table, const ps_msg_ref const message );
+void ps_post_objects( RtMailbox *mailbox, const ps_msg_ref const message );
 
 
 #endif
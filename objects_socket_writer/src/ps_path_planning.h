@@ -3,21 +3,13 @@
 
 #include"ps_func.h"
 
-#define OBJECT_NUMBER 20
-
-int *path_left_right_objects_fsae(
-			const ps_msg_ref const message,
-			double left_objects[OBJECT_NUMBER][2],
-			double right_objects[OBJECT_NUMBER][2]);
-			
-void *staight_line_fsae(
-			double left_objects[OBJECT_NUMBER][2],
-			double right_objects[OBJECT_NUMBER][2],
-			int left_right_length[2]);
-			
-void *cube_line_fsae(const ps_msg_ref const message);
-
-double cube_insert_fsae(double point[3]);
+// boundaries of the track from the cones among the objects, a line on each side
+#include"ps_lane.h"
+
+// cones the boundaries are allocated for in on_init, a larger message grows them once
+#define LANE_CONES (TRACK_OBJECTS)
+
+int path_left_right_objects_fsae( LaneEstimator *lane, const ps_msg_ref const message );
 
 
 
@@ -1,19 +1,187 @@
 #include"ps_func.h"
 #include"ps_control.h"
+#include"ps_path_planning.h"
 
-#define PS_DEBUG		1
 #define PS_UDP_SEND		0
 #define PS_PID			0
+#define PS_LANE			0
 
 
-int pid_raw_data_count = 0;
 //
-ps_socket *my_socket = NULL;
+WireSender *my_sender = NULL;
+
+// AEB control of the closest object in front, its history is kept across messages
+static aeb_controller_t my_aeb;
+
+// objects of the last messages by id, with the closest one in the path of the car
+static ObjectTable my_objects;
+
+// braking envelope and the demand of the last message
+static BrakeEnvelope my_brake;
+static BrakeDemand my_demand;
+
+// evaluations of the braking demand since the last report, those over the budget and the longest one,
+// only written by the thread of the control
+static unsigned long brake_evaluations;
+static unsigned long brake_over_budget;
+static uint64_t brake_max_ns;
+
+// boundaries of the track, the middle of the last message sorts the cones of the next
+static LaneEstimator my_lane;
+
+// speed of the car from the motion CAN and the timestamp of its frame, published together by the CAN listener
+static EgoSpeed my_ego;
+
+// log of the objects and of the control, written by a background thread
+static Logger my_logger;
+
+// stages timed by the listener, the last one from the timestamp of the objects to the UDP send
+enum
+{
+	OBJECTS_RECEIVE,
+	OBJECTS_SEND,
+	OBJECTS_END_TO_END,
+	OBJECTS_PRINT,
+	OBJECTS_TRACK,
+	OBJECTS_BRAKE,
+	OBJECTS_CONTROL,
+	OBJECTS_LANE,
+	OBJECTS_STAGES
+};
+
+static const char * const OBJECTS_STAGE_NAME[] = { "receive", "encode+send", "end-to-end", "print", "track", "brake", "control", "lane" };
+
+static const char * const LANE_FIT_NAME[] = { "least squares", "ransac" };
+
+// latency histograms, only written by the listener
+static LatencyRecorder objects_latency;
+
+// real-time mode, PS_RT: the control runs on its own period, the listener hands it the last message
+static RtConfig my_rt;
+static RtPeriod my_period;
+static RtMailbox my_mailbox;
+
+// latency histograms of the control thread, only written by it
+static LatencyRecorder control_latency;
 
 // *****************************************************
 // static definitions
 // *****************************************************
 
+// evaluations of the braking demand over the budget since the last report, the budget is not enforced
+static void ps_brake_log( void )
+{
+	LOG_AT( &my_logger, brake_over_budget ? LOGGER_WARN : LOGGER_INFO, LOGGER_NODE, "brake %lu of %lu evaluations over the budget of %.1f us, max %.1f us",
+			brake_over_budget, brake_evaluations, my_brake.budgetNs / 1000.0, brake_max_ns / 1000.0 );
+	brake_evaluations = 0;
+	brake_over_budget = 0;
+	brake_max_ns = 0;
+}
+
+// track the objects of @message, then the braking demand and the PID, timed in @recorder
+// on the listener, or on the control thread in the real-time mode
+static void ps_objects_control(
+        const ps_msg_ref const message,
+        LatencyRecorder * const recorder )
+{
+    LATENCY_CLOCK( clock );
+
+    LATENCY_START( clock );
+
+/*---------------------------------- start braking demand--------------------------------------------*/
+
+	// every object updates its own entry, the closest and the soonest in the path follow
+	ps_track_objects( &my_objects, message );
+
+	LATENCY_LAP( recorder, OBJECTS_TRACK, clock );
+
+	// the speed of the car is only trusted close to the objects
+	const double ego = egoSpeedAt( &my_ego, ((const ps_objects_msg*) message)->header.timestamp );
+	const int level = my_demand.level;
+
+	evaluateBrake( &my_brake, &my_objects, ego, &my_demand );
+
+	LATENCY_LAP( recorder, OBJECTS_BRAKE, clock );
+
+	// every message while braking or warning, once when it ends
+	if( my_demand.level != BRAKE_NONE || level != BRAKE_NONE )
+	{
+		LOG_AT( &my_logger, LOGGER_INFO, LOGGER_CONTROL, "brake %s demand %.2f decel %.2f ttc %.2f object %llu ego %.2f",
+				BRAKE_LEVEL_NAME[my_demand.level], my_demand.demand, my_demand.decel,
+				my_demand.ttc < TRACK_TTC_NONE ? my_demand.ttc : -1.0, (ps_ull) my_demand.id, ego );
+	}
+
+	if( my_demand.truncated )
+	{
+		LOG_AT( &my_logger, LOGGER_WARN, LOGGER_CONTROL, "brake evaluated %d objects of %d in the path",
+				my_demand.evaluated, my_objects.pathCount );
+	}
+
+	brake_evaluations++;
+	brake_over_budget += my_demand.overBudget;
+	if( my_demand.elapsed > brake_max_ns )
+		brake_max_ns = my_demand.elapsed;
+
+/*---------------------------------- end braking demand----------------------------------------------*/
+
+
+/*---------------------------------- start PID control-----------------------------------------------*/
+	#ifdef PS_PID
+    	const TrackedObject *closest = closestObject( &my_objects );
+    
+    	// one step of the controller per message, a new history once the path is clear
+    	// the velocity is the closing speed, vx is negative while the gap shrinks
+    	if(closest == NULL)
+    	{
+    		aeb_reset(&my_aeb);
+    	}
+    	else if(aeb_update(&my_aeb, closest->gap, return_velocity(-closest->vx, closest->vy)))
+    	{
+			LOG_AT( &my_logger, LOGGER_DEBUG, LOGGER_CONTROL, "pid increment velocity %f distance %f, command velocity %f distance %f",
+					my_aeb.delta.error_velocity, my_aeb.delta.error_distance,
+					my_aeb.command.error_velocity, my_aeb.command.error_distance );
+		}
+
+		LATENCY_LAP( recorder, OBJECTS_CONTROL, clock );
+	#endif //end if define PS_PID
+    	 
+/*---------------------------------- end PID control-------------------------------------------------*/
+
+
+/*---------------------------------- start track boundaries------------------------------------------*/
+	#ifdef PS_LANE
+		// a line on each side of the track from the cones in the objects
+		if( path_left_right_objects_fsae( &my_lane, message ) < 0 )
+		{
+			LOG_AT( &my_logger, LOGGER_WARN, LOGGER_CONTROL, "lane %lu cones do not fit in memory",
+					(unsigned long) ((const ps_objects_msg*) message)->objects._length );
+		}
+		else
+		{
+			for( int side = 0; side < LANE_SIDES; side++ )
+			{
+				const LaneLine * const line = &my_lane.line[side];
+
+				if( line->valid )
+				{
+					LOG_AT( &my_logger, LOGGER_DEBUG, LOGGER_CONTROL, "lane %s slope %.3f offset %.2f rms %.3f, %d of %d cones by %s",
+							LANE_SIDE_NAME[side], line->slope, line->offset, line->rms, line->inliers, line->cones,
+							LANE_FIT_NAME[line->robust] );
+				}
+				else
+				{
+					LOG_AT( &my_logger, LOGGER_DEBUG, LOGGER_CONTROL, "lane %s none, %d cones", LANE_SIDE_NAME[side], line->cones );
+				}
+			}
+		}
+
+		LATENCY_LAP( recorder, OBJECTS_LANE, clock );
+	#endif //end if define PS_LANE
+
+/*---------------------------------- end track boundaries--------------------------------------------*/
+}
+
+
 static void ps_objects_msg__handler(
         const ps_msg_type msg_type,
         const ps_msg_ref const message,
@@ -21,19 +189,26 @@ static void ps_objects_msg__handler(
 {
 	// local vars
     int ret = DTC_NONE;
+    LATENCY_CLOCK( clock );
+
+    // how old the objects are when they get here
+    LATENCY_START( clock );
+    LATENCY_SENSOR_AGE( &objects_latency, OBJECTS_RECEIVE, ((const ps_objects_msg*) message)->header.timestamp );
   
 /*---------------------------------- start UDP send ------------------------------------------------*/   
     
     #ifdef PS_UDP_SEND
-    	unsigned char buffer[1248];
-   		ps_socket *socket = NULL;
+   		WireSender *sender = NULL;
 
     	// cast
-    	socket = (ps_socket*) my_socket;
-		ps_socket_error(socket);
+    	sender = my_sender;
+		ps_socket_error(sender);
 		//
-    	ret = ps_socket_send(socket, buffer);
+    	ret = ps_socket_send(sender, message);
 		ps_socket_send_error(ret);
+
+		LATENCY_LAP( &objects_latency, OBJECTS_SEND, clock );
+		LATENCY_SENSOR_AGE( &objects_latency, OBJECTS_END_TO_END, ((const ps_objects_msg*) message)->header.timestamp );
 	#endif //// end if define PS_UDP_SEND
 	
 /*---------------------------------- end UDP send ---------------------------------------------------*/ 	
@@ -41,75 +216,65 @@ static void ps_objects_msg__handler(
 	
 /*---------------------------------- start print objects information---------------------------------*/
 
-	#ifdef PS_DEBUG
-    	ps_printf(message);
-    #endif // end if define PS_DEBUG
+	// only queued, and only when PS_LOG asks for it
+	ps_printf(&my_logger, message);
+
+	LATENCY_LAP( &objects_latency, OBJECTS_PRINT, clock );
     
 /*---------------------------------- end of print objects information--------------------------------*/    
     
 
-/*---------------------------------- start PID control-----------------------------------------------*/
-	#ifdef PS_PID
-    	const ps_objects_msg * const objects_msg = (ps_objects_msg*) message;
-    	const ps_object *_buffer = objects_msg->objects._buffer; 
-    	unsigned long objects_index = 0;
-    	double distance_min = 1000.0;
-    	double velocity_now = 0;
-    
-    	while(objects_index < objects_msg->objects._length)
-    	{
-    		double x = _buffer[objects_index].position[0];
-    		double y = _buffer[objects_index].position[1];
-    		if(is_object_front(y) && x < distance_min)
-    		{
-    			distance_min = x;
-    			velocity_now = 
-    				return_velocity(_buffer[objects_index].velocity[0], 
-    						    	_buffer[objects_index].velocity[0]);
-    	
-    	
-    		}
-    		objects_index++;
-   	 }
-    
-    	//printf("%lf\t%lf\n",distance_min, velocity_now);
-    
-   		velocity_distance_t *data;
-		velocity_distance_error_t *vel_dis;
-		velocity_error_t *vel_err;
-		distance_error_t *dis_err;
-		
- 		ps_memory(data, vel_dis, vel_err, dis_err);
- 
-		if(is_receive_four(pid_raw_data_count))
-    	{
-    		for (int i =1; i <4; i++)
-			{
-    			vel_err->error[i] = data->velocity[i] - data->velocity[i-1];
-				dis_err->error[i] = data->distance[i] - data->distance[i-1];
-			}
-			pid_raw_data_count = 0;
-		
-			/*------------------------------------*/
-			AEB_pid(vel_err, dis_err, vel_dis );
-			printf("%lf\t%lf\n",vel_dis->error_velocity, vel_dis->error_distance);
-			/*------------------------------------*/
-		}
-		else
-		{
-			data->velocity[pid_raw_data_count] = velocity_now;
-			data->distance[pid_raw_data_count] = distance_min;
-			pid_raw_data_count++;
-		}
-		
-		ps_free_memory(data, vel_dis, vel_err, dis_err);
-	#endif //end if define PS_PID
-    	 
-/*---------------------------------- end PID control-------------------------------------------------*/    
+/*---------------------------------- start control---------------------------------------------------*/
+
+	// in the real-time mode the control thread takes the message at its next period
+	if( my_rt.enabled )
+	{
+		ps_post_objects( &my_mailbox, message );
+	}
+	else
+	{
+		ps_objects_control( message, &objects_latency );
+	}
+
+/*---------------------------------- end control-----------------------------------------------------*/
+
+#ifdef PS_LATENCY
+	// periodic report, every LATENCY_REPORT_NS
+	static uint64_t report = 0;
+
+	if( report == 0 )
+		report = latencyNow();
+	if( latencyNow() - report > LATENCY_REPORT_NS )
+	{
+		ps_latency_log( &objects_latency );
+		ps_brake_log();
+		report = latencyNow();
+	}
+#endif
     
 }
 
 
+// speed of the car from the motion CAN, the other frames are not ours
+static void ps_can_frame_msg__handler(
+        const ps_msg_type msg_type,
+        const ps_msg_ref const message,
+        void * const user_data )
+{
+	const ps_can_frame_msg * const can_msg = (ps_can_frame_msg*) message;
+	double speed = 0.0;
+
+	if( can_msg->id != IBEO_LUX_MOTION_CAN_ID_VELOCITY ||
+			egoSpeedFromCan( can_msg->data_buffer._buffer, can_msg->data_buffer._length, IBEO_LUX_MOTION_CAN_VELOCITY_SCALE, &speed ) != 0 )
+	{
+		return;
+	}
+
+	// reversing is not braked for
+	publishEgoSpeed( &my_ego, speed >= 0.0 ? speed : BRAKE_EGO_UNKNOWN, can_msg->header.timestamp );
+}
+
+
 
 
 
@@ -156,7 +321,7 @@ static int set_configuration(
         ps_node_configuration_data * const node_config )
 {
     // local vars
-    ps_socket *socket = NULL;
+    WireSender *sender = NULL;
 
 
     // set node configuration default values
@@ -180,24 +345,25 @@ static int set_configuration(
     memset( node_config->node_name, 0, sizeof(node_config->node_name) );
     strncpy( node_config->node_name, NODE_NAME, sizeof(node_config->node_name) );
 
-    // create CAN channel
-    if( (socket = malloc( sizeof(*socket) )) == NULL )
+    // create UDP output
+    if( (sender = malloc( sizeof(*sender) )) == NULL )
     {
         psync_log_message(
                 LOG_LEVEL_ERROR,
-                "%s : (%u) -- failed to allocate socket data structure",
+                "%s : (%u) -- failed to allocate sender data structure",
                 __FILE__,
                 __LINE__ );
 
         return DTC_MEMERR;
     }
 
-    // zero
-    memset( socket, 0, sizeof(*socket) );
+    // zero, no socket yet
+    memset( sender, 0, sizeof(*sender) );
+    sender->fd = -1;
 
     // set user data pointer to our top-level node data
     // this will get passed around to the various interface routines
-    node_config->user_data = (void*) socket;
+    node_config->user_data = (void*) sender;
 
     return DTC_NONE;
 }
@@ -211,38 +377,102 @@ static void on_init(
 {
     // local vars
     int ret = DTC_NONE;
-    ps_socket *socket = NULL;
+    WireSender *sender = NULL;
     ps_msg_type msg_type = PSYNC_MSG_TYPE_INVALID;
 
     // cast
-    socket = (ps_socket*) user_data;
+    sender = (WireSender*) user_data;
 
     // check reference since other routines don't
-    ps_socket_error(socket);
+    ps_socket_error(sender);
 
-    // init UDP socket
-    ret = psync_socket_init(
-            socket,
-            AF_INET,
-            SOCK_DGRAM,
-            IPPROTO_UDP );
+    // init UDP socket to the address and port
+    ret = openWireSender( sender, UDP_ADDRESS, UDP_PORT, WIRE_SENDER_DATAGRAMS ) == 0 ? DTC_NONE : DTC_IOERR;
 
     ps_socket_init_error(ret);
 
-    // set address and port
-    ret = psync_socket_set_address(
-            socket,
-            UDP_ADDRESS,
-            UDP_PORT );
 
-    ps_socket_set_address_error(ret);
-	
-    // set socket reuse option for multiple connections
-    ret = psync_socket_set_reuse_option( socket, 1 );
-    ps_socket_set_reuse_option_error(ret);
+    my_sender = sender;
+
+    // log, PS_LOG sets what is logged
+    if( openLogger( &my_logger, LOG_FILE, LOGGER_RECORDS ) != 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_WARN,
+                "%s : (%u) -- failed to open the log %s, nothing is logged",
+                __FILE__,
+                __LINE__,
+                LOG_FILE );
+    }
+
+    // gains of the AEB control, computed once
+    aeb_init( &my_aeb, PID_P, PID_I, PID_D, PERIOD );
+
+    // objects table, allocated once for TRACK_OBJECTS objects
+    if( initialObjectTable( &my_objects, TRACK_OBJECTS, CAR_WIDTH ) != 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_ERROR,
+                "%s : (%u) -- failed to allocate the objects table",
+                __FILE__,
+                __LINE__ );
+
+        psync_node_activate_fault( node_ref, DTC_MEMERR, NODE_STATE_FATAL );
+        return;
+    }
+
+    // track boundaries, allocated once for LANE_CONES cones
+    if( initialLaneEstimator( &my_lane, LANE_CONES ) != 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_ERROR,
+                "%s : (%u) -- failed to allocate the track boundaries",
+                __FILE__,
+                __LINE__ );
+
+        psync_node_activate_fault( node_ref, DTC_MEMERR, NODE_STATE_FATAL );
+        return;
+    }
 
+    // braking envelope of the AEB
+    initialBrakeEnvelope( &my_brake );
+    initialEgoSpeed( &my_ego );
+    memset( &my_demand, 0, sizeof(my_demand) );
 
-    my_socket = socket;
+    // real-time mode, everything it needs is allocated here, then the memory is locked
+    if( rtConfigFromEnv( &my_rt ) != 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_WARN,
+                "%s : (%u) -- %s=%s is not cpu[:priority], the real-time mode is off",
+                __FILE__,
+                __LINE__,
+                RT_ENV,
+                getenv( RT_ENV ) );
+    }
+
+    if( my_rt.enabled )
+    {
+        if( initialRtMailbox( &my_mailbox, sizeof(ps_objects_slot) ) != 0 )
+        {
+            psync_log_message(
+                    LOG_LEVEL_ERROR,
+                    "%s : (%u) -- failed to allocate the objects mailbox",
+                    __FILE__,
+                    __LINE__ );
+
+            psync_node_activate_fault( node_ref, DTC_MEMERR, NODE_STATE_FATAL );
+            return;
+        }
+
+        initialRtPeriod( &my_period, "control period", CONTROL_PERIOD_NS );
+        initialLatency( &control_latency, "control", OBJECTS_STAGE_NAME, OBJECTS_STAGES );
+        logRtLockMemory( &my_logger );
+    }
+
+    // empty histograms, the clock is calibrated before the first message
+    initialLatencyClock();
+    initialLatency( &objects_latency, "listener", OBJECTS_STAGE_NAME, OBJECTS_STAGES );
 
 
     // get objects message type identifier
@@ -261,6 +491,18 @@ static void on_init(
             NULL );
 
     ps_message_register_listener_error(ret);
+
+    // speed of the car, the braking demand does without it on the relative velocities
+    if( psync_message_get_type_by_name( node_ref, CAN_FRAME_MSG_NAME, &msg_type ) != DTC_NONE
+            || psync_message_register_listener( node_ref, msg_type, ps_can_frame_msg__handler, NULL ) != DTC_NONE )
+    {
+        psync_log_message(
+                LOG_LEVEL_WARN,
+                "%s : (%u) -- no %s, the speed of the car is unknown",
+                __FILE__,
+                __LINE__,
+                CAN_FRAME_MSG_NAME );
+    }
     
     
        
@@ -273,7 +515,42 @@ static void on_release(
         const ps_diagnostic_state * const state,
         void * const user_data )
 {
-    // do nothing, sleep for 10 milliseconds
+#ifdef PS_LATENCY
+    // latency of the stages
+    ps_latency_log( &objects_latency );
+#endif
+
+    // braking demands over the budget since the last report
+    ps_brake_log();
+
+    // close the UDP output
+    if( my_sender != NULL )
+    {
+        closeWireSender( my_sender );
+        my_sender = NULL;
+    }
+
+    // jitter of the control period
+    if( my_rt.enabled )
+    {
+#ifdef PS_LATENCY
+        ps_latency_log( &control_latency );
+#endif
+        ps_latency_log( &my_period.latency );
+        logRtPeriod( &my_logger, &my_period, &my_mailbox );
+        destroyRtMailbox( &my_mailbox );
+    }
+
+    // objects table
+    destroyObjectTable( &my_objects );
+
+    // track boundaries
+    destroyLaneEstimator( &my_lane );
+
+    // write what is still queued
+    closeLogger( &my_logger );
+
+    // sleep for 10 milliseconds
     (void) psync_sleep_micro( 10000 );
     
 }
@@ -318,9 +595,33 @@ static void on_ok(
         const ps_diagnostic_state * const state,
         void * const user_data )
 {
+    const ps_objects_slot *slot = NULL;
 
-    // sleep for 500 milliseconds
-    (void) psync_sleep_micro( 100000 );
+    // the listener does the work, sleep for 100 milliseconds
+    if( !my_rt.enabled )
+    {
+        (void) psync_sleep_micro( 100000 );
+        return;
+    }
 
+    // the first period makes this thread the control thread
+    if( my_period.cycles == 0 )
+    {
+        logRtEnterThread( &my_logger, &my_rt );
+    }
+
+    waitRtPeriod( &my_period );
+
+    if( (slot = takeRtMailbox( &my_mailbox )) != NULL )
+    {
+        ps_objects_control( (ps_msg_ref) &slot->msg, &control_latency );
+    }
 
+    // periodic report, every LATENCY_REPORT_NS
+    if( my_period.cycles % (LATENCY_REPORT_NS / CONTROL_PERIOD_NS) == 0 )
+    {
+        ps_latency_log( &my_period.latency );
+        logRtPeriod( &my_logger, &my_period, &my_mailbox );
+        ps_brake_log();
+    }
 }
@@ -0,0 +1,232 @@
+#include "ps_cluster.h"
+
+
+//
+static ps_ull elapsed_us( const struct timespec * const start )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    return (ps_ull) ( (now.tv_sec - start->tv_sec) * 1000000LL + (now.tv_nsec - start->tv_nsec) / 1000 );
+}
+
+
+//
+int ps_cluster_init( ps_cluster_frame *frame, int capacity )
+{
+    memset( frame, 0, sizeof(*frame) );
+
+    frame->points = malloc( sizeof(*frame->points) * capacity );
+    if( frame->points == NULL )
+    {
+        return -1;
+    }
+
+    frame->capacity = capacity;
+    frame->ctx = dbscan_ctx_create( capacity, CLUSTER_NEIGHBORHOOD, CLUSTER_MIN_PTS );
+    if( frame->ctx == NULL )
+    {
+        ps_cluster_release( frame );
+        return -1;
+    }
+
+    dbscan_ctx_set_dimensions( frame->ctx, CLUSTER_DIMENSIONS, CLUSTER_NEIGHBORHOOD_Z );
+
+    // same clusters for the same frame
+    frame->ctx->seedMode = DBSCAN_SEED_ORDERED;
+
+    return 0;
+}
+
+
+//
+void ps_cluster_release( ps_cluster_frame *frame )
+{
+    if( frame->ctx != NULL )
+    {
+        dbscan_ctx_destroy( frame->ctx );
+    }
+
+    free( frame->points );
+
+    frame->ctx = NULL;
+    frame->points = NULL;
+    frame->capacity = 0;
+}
+
+
+// the clustering of CLUSTER_MODE_ENV, return -1 if the value is unknown, DBSCAN is then kept
+int ps_cluster_mode_from_env( ps_cluster_frame *frame )
+{
+    const char *mode = getenv( CLUSTER_MODE_ENV );
+
+    frame->ctx->clusterMode = DBSCAN_CLUSTER_DENSITY;
+
+    if( mode == NULL || strcmp( mode, "dbscan" ) == 0 )
+    {
+        return 0;
+    }
+
+    if( strcmp( mode, "range" ) == 0 )
+    {
+        frame->ctx->clusterMode = DBSCAN_CLUSTER_RANGE;
+        return 0;
+    }
+
+    return -1;
+}
+
+
+// start a frame of @length points received at @received, or now if NULL, and empty the buffer, growing it if needed
+int ps_cluster_begin( ps_cluster_frame *frame, ps_ull timestamp, unsigned long length, const struct timespec *received )
+{
+    Point *points = NULL;
+
+    if( received != NULL )
+    {
+        frame->start = *received;
+    }
+    else
+    {
+        clock_gettime( CLOCK_MONOTONIC, &frame->start );
+    }
+
+    frame->size = 0;
+    frame->packet.timestamp = timestamp;
+    frame->packet.cluster_count = 0;
+    frame->packet.points = 0;
+
+    if( length > (unsigned long) frame->capacity )
+    {
+        if( (points = realloc( frame->points, sizeof(*points) * length )) == NULL )
+        {
+            frame->dropped++;
+            return -1;
+        }
+
+        frame->points = points;
+        frame->capacity = (int) length;
+    }
+
+    return 0;
+}
+
+
+// the points of the frame, already filtered by ps_roi_filter, at most the length given to ps_cluster_begin
+void ps_cluster_set_points( ps_cluster_frame *frame, const float *x, const float *y, const float *z, unsigned long count )
+{
+    unsigned long index = 0;
+
+    for( index = 0; index < count; index++ )
+    {
+        frame->points[index].x = x[index];
+        frame->points[index].y = y[index];
+        frame->points[index].z = z[index];
+    }
+
+    frame->size = (int) count;
+}
+
+
+// cluster the points of the frame and fill the packet, return the number of clusters,
+// or -1 if the clustering ran out of memory, the frame is then dropped and its packet left empty
+int ps_cluster_run( ps_cluster_frame *frame )
+{
+    ps_cluster_packet * const packet = &frame->packet;
+    const int *cluster = NULL;
+    int cluster_count = 0;
+    int boxes = 0;
+    int i = 0;
+
+    cluster_count = dbscan_ctx_run( frame->ctx, frame->points, frame->size );
+    if( cluster_count < 0 )
+    {
+        frame->dropped++;
+        return -1;
+    }
+
+    cluster = dbscan_ctx_results( frame->ctx, NULL );
+
+    boxes = cluster_count < CLUSTER_MAX_BOXES ? cluster_count : CLUSTER_MAX_BOXES;
+
+    // velocity stays 0
+    memset( packet->box, 0, sizeof(packet->box[0]) * boxes );
+    for( i = 0; i < boxes; i++ )
+    {
+        packet->box[i].id = (uint64_t) i + 1;
+    }
+
+    // one pass over the labels for every box
+    for( i = 0; i < frame->size; i++ )
+    {
+        const float x = (float) frame->points[i].x;
+        const float y = (float) frame->points[i].y;
+        const float z = (float) frame->points[i].z;
+        WireRecord *box = NULL;
+
+        if( cluster[i] == 0 || cluster[i] > boxes )
+        {
+            continue;
+        }
+
+        box = &packet->box[cluster[i] - 1];
+
+        if( box->points == 0 )
+        {
+            box->min[0] = box->max[0] = x;
+            box->min[1] = box->max[1] = y;
+            box->min[2] = box->max[2] = z;
+        }
+        else
+        {
+            box->min[0] = x < box->min[0] ? x : box->min[0];
+            box->min[1] = y < box->min[1] ? y : box->min[1];
+            box->min[2] = z < box->min[2] ? z : box->min[2];
+            box->max[0] = x > box->max[0] ? x : box->max[0];
+            box->max[1] = y > box->max[1] ? y : box->max[1];
+            box->max[2] = z > box->max[2] ? z : box->max[2];
+        }
+
+        box->centroid[0] += x;
+        box->centroid[1] += y;
+        box->centroid[2] += z;
+        box->points++;
+    }
+
+    for( i = 0; i < boxes; i++ )
+    {
+        packet->box[i].centroid[0] /= (float) packet->box[i].points;
+        packet->box[i].centroid[1] /= (float) packet->box[i].points;
+        packet->box[i].centroid[2] /= (float) packet->box[i].points;
+    }
+
+    packet->cluster_count = (unsigned int) boxes;
+    packet->points = (unsigned int) frame->size;
+
+    return cluster_count;
+}
+
+
+// stop the clock of the frame, return 1 if it took longer than CLUSTER_FRAME_BUDGET_US
+int ps_cluster_end( ps_cluster_frame *frame )
+{
+    ps_cluster_latency * const latency = &frame->latency;
+
+    latency->last_us = elapsed_us( &frame->start );
+    latency->frames++;
+    latency->total_us += latency->last_us;
+
+    if( latency->last_us > latency->max_us )
+    {
+        latency->max_us = latency->last_us;
+    }
+
+    if( latency->last_us > CLUSTER_FRAME_BUDGET_US )
+    {
+        latency->over_budget++;
+        return 1;
+    }
+
+    return 0;
+}
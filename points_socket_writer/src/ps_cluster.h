@@ -0,0 +1,136 @@
+#ifndef PS_CLUSTER_H_
+#define PS_CLUSTER_H_
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// clustering engine
+#include "dbscan.h"
+
+// wire format of the clusters
+#include "ps_wire.h"
+
+
+
+
+// *****************************************************
+// static global types/macros
+// *****************************************************
+
+/**
+ * @brief Clustering parameters of the lidar points.
+ *
+ */
+#define CLUSTER_NEIGHBORHOOD (0.3)
+#define CLUSTER_MIN_PTS (2)
+
+
+/**
+ * @brief The points are clustered on x, y and z.
+ *
+ * Two points are neighbors within \ref CLUSTER_NEIGHBORHOOD in the ground plane
+ * and within \ref CLUSTER_NEIGHBORHOOD_Z in height, so a sign over the road or a
+ * curb below it is not merged with what stands next to it. 2 clusters on x and y only.
+ *
+ */
+#define CLUSTER_DIMENSIONS (3)
+#define CLUSTER_NEIGHBORHOOD_Z (0.2)
+
+
+/**
+ * @brief Environment variable selecting the clustering, read in on_init.
+ *
+ * "dbscan", the default, runs DBSCAN on the neighbor grid; "range" segments the
+ * range image of the scan, adjacent beams and layers only, which is O(n).
+ *
+ */
+#define CLUSTER_MODE_ENV "PS_CLUSTER_MODE"
+
+
+/**
+ * @brief Points of a frame the buffers are allocated for in on_init.
+ *
+ * A larger frame grows them once.
+ *
+ */
+#define CLUSTER_POINTS_CAPACITY (8192)
+
+
+/**
+ * @brief Time allowed from the reception of a frame to its clusters being sent, in microseconds.
+ *
+ */
+#define CLUSTER_FRAME_BUDGET_US (20000)
+
+
+/**
+ * @brief Clusters sent per frame, the smallest ids first.
+ *
+ */
+#define CLUSTER_MAX_BOXES (1024)
+
+
+typedef unsigned long long ps_ull;
+
+
+/**
+ * @brief Clusters of a frame, one \ref WireRecord each with its number of points, centroid and bounding box.
+ *
+ */
+typedef struct ps_cluster_packet
+{
+    ps_ull timestamp;
+    unsigned int cluster_count;
+    unsigned int points;
+    WireRecord box[CLUSTER_MAX_BOXES];
+} ps_cluster_packet;
+
+
+/**
+ * @brief Latency of the frames, from their reception to ps_cluster_end.
+ *
+ */
+typedef struct ps_cluster_latency
+{
+    unsigned long frames;
+    unsigned long over_budget;
+    ps_ull last_us;
+    ps_ull max_us;
+    ps_ull total_us;
+} ps_cluster_latency;
+
+
+/**
+ * @brief All the state of the per-frame clustering, allocated once.
+ *
+ */
+typedef struct ps_cluster_frame
+{
+    dbscan_ctx *ctx;
+    Point *points;
+    int capacity;
+    int size;
+    ps_cluster_packet packet;
+    struct timespec start;
+    ps_cluster_latency latency;
+    unsigned long dropped;
+} ps_cluster_frame;
+
+
+
+
+// *****************************************************
+// user-definition function declarations
+// *****************************************************
+int  ps_cluster_init( ps_cluster_frame *frame, int capacity );
+void ps_cluster_release( ps_cluster_frame *frame );
+int  ps_cluster_mode_from_env( ps_cluster_frame *frame );
+int  ps_cluster_begin( ps_cluster_frame *frame, ps_ull timestamp, unsigned long length, const struct timespec *received );
+void ps_cluster_set_points( ps_cluster_frame *frame, const float *x, const float *y, const float *z, unsigned long count );
+int  ps_cluster_run( ps_cluster_frame *frame );
+int  ps_cluster_end( ps_cluster_frame *frame );
+
+
+#endif
@@ -0,0 +1,201 @@
+#include <string.h>
+#include "ps_frame_queue.h"
+
+
+#define LOAD(p) __atomic_load_n( (p), __ATOMIC_ACQUIRE )
+#define STORE(p, v) __atomic_store_n( (p), (v), __ATOMIC_RELEASE )
+
+
+//
+int ps_frame_queue_init( ps_frame_queue *queue, unsigned long capacity )
+{
+    unsigned int i = 0;
+
+    memset( queue, 0, sizeof(*queue) );
+
+    for( i = 0; i < FRAME_QUEUE_SLOTS + 1; i++ )
+    {
+        queue->frame[i].x = malloc( sizeof(float) * capacity );
+        queue->frame[i].y = malloc( sizeof(float) * capacity );
+        queue->frame[i].z = malloc( sizeof(float) * capacity );
+        if( queue->frame[i].x == NULL || queue->frame[i].y == NULL || queue->frame[i].z == NULL )
+        {
+            ps_frame_queue_release( queue );
+            return -1;
+        }
+
+        queue->frame[i].capacity = capacity;
+    }
+
+    // the listener owns frame 0, the worker frame 1, all the others are spare
+    queue->writing = 0;
+    queue->reading = 1;
+    for( i = 0; i < FRAME_QUEUE_SLOTS - 1; i++ )
+    {
+        queue->spare[i] = i + 2;
+    }
+    queue->spare_head = FRAME_QUEUE_SLOTS - 1;
+
+    if( sem_init( &queue->available, 0, 0 ) != 0 )
+    {
+        ps_frame_queue_release( queue );
+        return -1;
+    }
+
+    return 0;
+}
+
+
+//
+void ps_frame_queue_release( ps_frame_queue *queue )
+{
+    unsigned int i = 0;
+
+    for( i = 0; i < FRAME_QUEUE_SLOTS + 1; i++ )
+    {
+        free( queue->frame[i].x );
+        free( queue->frame[i].y );
+        free( queue->frame[i].z );
+        queue->frame[i].x = NULL;
+        queue->frame[i].y = NULL;
+        queue->frame[i].z = NULL;
+        queue->frame[i].capacity = 0;
+    }
+
+    sem_destroy( &queue->available );
+}
+
+
+// listener side: the frame to fill, large enough for @length points, NULL if it can not grow
+ps_frame *ps_frame_queue_writing( ps_frame_queue *queue, unsigned long length )
+{
+    ps_frame * const frame = &queue->frame[queue->writing];
+    float *coordinate[3] = { NULL, NULL, NULL };
+
+    if( length > frame->capacity )
+    {
+        coordinate[0] = realloc( frame->x, sizeof(float) * length );
+        if( coordinate[0] != NULL )
+        {
+            frame->x = coordinate[0];
+        }
+        coordinate[1] = realloc( frame->y, sizeof(float) * length );
+        if( coordinate[1] != NULL )
+        {
+            frame->y = coordinate[1];
+        }
+        coordinate[2] = realloc( frame->z, sizeof(float) * length );
+        if( coordinate[2] != NULL )
+        {
+            frame->z = coordinate[2];
+        }
+
+        if( coordinate[0] == NULL || coordinate[1] == NULL || coordinate[2] == NULL )
+        {
+            return NULL;
+        }
+
+        frame->capacity = length;
+    }
+
+    return frame;
+}
+
+
+// listener side: publish the filled frame and take the next one, dropping the oldest if none is spare
+void ps_frame_queue_push( ps_frame_queue *queue )
+{
+    const unsigned int head = queue->ready_head;
+    unsigned int tail = 0;
+    unsigned int next = 0;
+    unsigned long depth = 0;
+
+    __atomic_store_n( &queue->ready[head % FRAME_QUEUE_SLOTS], queue->writing, __ATOMIC_RELAXED );
+    STORE( &queue->ready_head, head + 1 );
+    queue->stats.pushed++;
+
+    depth = head + 1 - LOAD( &queue->ready_tail );
+    if( depth > queue->stats.max_depth )
+    {
+        queue->stats.max_depth = depth;
+    }
+
+    (void) sem_post( &queue->available );
+
+    for( ; ; )
+    {
+        // a frame given back by the worker
+        if( queue->spare_tail != LOAD( &queue->spare_head ) )
+        {
+            queue->writing = queue->spare[queue->spare_tail % FRAME_QUEUE_SLOTS];
+            STORE( &queue->spare_tail, queue->spare_tail + 1 );
+            return;
+        }
+
+        // none, the worker is behind: take back the oldest waiting frame
+        tail = LOAD( &queue->ready_tail );
+        if( tail != head + 1 )
+        {
+            next = queue->ready[tail % FRAME_QUEUE_SLOTS];
+            if( __atomic_compare_exchange_n( &queue->ready_tail, &tail, tail + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
+            {
+                queue->writing = next;
+                queue->stats.dropped++;
+                return;
+            }
+        }
+    }
+}
+
+
+// worker side: the oldest waiting frame, owned until the next pop, NULL if there is none
+ps_frame *ps_frame_queue_pop( ps_frame_queue *queue )
+{
+    unsigned int tail = 0;
+    unsigned int next = 0;
+
+    do
+    {
+        tail = LOAD( &queue->ready_tail );
+        if( tail == LOAD( &queue->ready_head ) )
+        {
+            return NULL;
+        }
+        // may be overwritten once the listener dropped it, the exchange below then fails
+        next = __atomic_load_n( &queue->ready[tail % FRAME_QUEUE_SLOTS], __ATOMIC_RELAXED );
+    }
+    while( !__atomic_compare_exchange_n( &queue->ready_tail, &tail, tail + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) );
+
+    // give back the frame of the previous pop
+    queue->spare[queue->spare_head % FRAME_QUEUE_SLOTS] = queue->reading;
+    STORE( &queue->spare_head, queue->spare_head + 1 );
+
+    queue->reading = next;
+    queue->stats.popped++;
+
+    return &queue->frame[next];
+}
+
+
+// worker side: sleep until a frame was pushed or ps_frame_queue_wake was called
+void ps_frame_queue_wait( ps_frame_queue *queue )
+{
+    while( sem_wait( &queue->available ) != 0 )
+    {
+        // interrupted by a signal
+    }
+}
+
+
+//
+void ps_frame_queue_wake( ps_frame_queue *queue )
+{
+    (void) sem_post( &queue->available );
+}
+
+
+// frames waiting for the worker
+unsigned long ps_frame_queue_depth( const ps_frame_queue *queue )
+{
+    return (unsigned long) ( LOAD( &queue->ready_head ) - LOAD( &queue->ready_tail ) );
+}
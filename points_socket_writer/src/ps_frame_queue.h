@@ -0,0 +1,96 @@
+#ifndef PS_FRAME_QUEUE_H_
+#define PS_FRAME_QUEUE_H_
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <semaphore.h>
+
+
+
+
+// *****************************************************
+// static global types/macros
+// *****************************************************
+
+/**
+ * @brief Frames that can wait for the worker, the oldest is dropped beyond.
+ *
+ */
+#define FRAME_QUEUE_SLOTS (8)
+
+
+/**
+ * @brief A lidar frame in preallocated buffers, one array per coordinate.
+ *
+ */
+typedef struct ps_frame
+{
+    unsigned long long timestamp;
+    struct timespec received;
+    unsigned long long clock;
+    unsigned long length;
+    unsigned long capacity;
+    float *x;
+    float *y;
+    float *z;
+} ps_frame;
+
+
+/**
+ * @brief Counters of the queue, written by their own side only.
+ *
+ */
+typedef struct ps_frame_queue_stats
+{
+    unsigned long pushed;
+    unsigned long dropped;
+    unsigned long popped;
+    unsigned long max_depth;
+} ps_frame_queue_stats;
+
+
+/**
+ * @brief Single-producer single-consumer queue of lidar frames, lock-free.
+ *
+ * The frames are never copied: the listener fills the frame it owns and
+ * pushes its index, the worker pops an index and owns that frame until its
+ * next pop, then gives it back through @spare. With one frame on each side,
+ * the others are either waiting in @ready or spare: when no frame is spare
+ * the queue is full and the listener takes back the oldest waiting frame
+ * instead, so a slow worker only loses old frames and never blocks the listener.
+ *
+ */
+typedef struct ps_frame_queue
+{
+    ps_frame frame[FRAME_QUEUE_SLOTS + 1];
+    unsigned int ready[FRAME_QUEUE_SLOTS];
+    unsigned int ready_head;
+    unsigned int ready_tail;
+    unsigned int spare[FRAME_QUEUE_SLOTS];
+    unsigned int spare_head;
+    unsigned int spare_tail;
+    unsigned int writing;
+    unsigned int reading;
+    sem_t available;
+    ps_frame_queue_stats stats;
+} ps_frame_queue;
+
+
+
+
+// *****************************************************
+// user-definition function declarations
+// *****************************************************
+int  ps_frame_queue_init( ps_frame_queue *queue, unsigned long capacity );
+void ps_frame_queue_release( ps_frame_queue *queue );
+ps_frame *ps_frame_queue_writing( ps_frame_queue *queue, unsigned long length );
+void ps_frame_queue_push( ps_frame_queue *queue );
+ps_frame *ps_frame_queue_pop( ps_frame_queue *queue );
+void ps_frame_queue_wait( ps_frame_queue *queue );
+void ps_frame_queue_wake( ps_frame_queue *queue );
+unsigned long ps_frame_queue_depth( const ps_frame_queue *queue );
+
+
+#endif
@@ -0,0 +1,427 @@
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include "ps_roi.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ROI_X86
+#endif
+
+
+#define DEG_TO_RAD (0.017453292519943295)
+
+
+/**
+ * @brief Vector path available, set by the ps_roi_set functions.
+ *
+ */
+static int roi_avx2 = 0;
+
+
+#ifdef ROI_X86
+/**
+ * @brief Lane order moving the kept lanes of an 8-bit mask to the front.
+ *
+ */
+static int roi_compaction[256][8];
+#endif
+
+
+//
+static void roi_init_vector( void )
+{
+#ifdef ROI_X86
+    int mask = 0;
+    int lane = 0;
+    int kept = 0;
+
+    __builtin_cpu_init();
+    roi_avx2 = __builtin_cpu_supports( "avx2" );
+
+    for( mask = 0; mask < 256; mask++ )
+    {
+        kept = 0;
+        for( lane = 0; lane < 8; lane++ )
+        {
+            if( mask & (1 << lane) )
+            {
+                roi_compaction[mask][kept++] = lane;
+            }
+        }
+        while( kept < 8 )
+        {
+            roi_compaction[mask][kept++] = 0;
+        }
+    }
+#endif
+}
+
+
+//
+void ps_roi_set_box( ps_roi_config *roi, float x_min, float x_max, float y_min, float y_max, float ground_z )
+{
+    memset( roi, 0, sizeof(*roi) );
+
+    roi->type = ROI_BOX;
+    roi->ground_z = ground_z;
+    roi->box_min[0] = x_min;
+    roi->box_max[0] = x_max;
+    roi->box_min[1] = y_min;
+    roi->box_max[1] = y_max;
+
+    roi_init_vector();
+}
+
+
+// return 0 on success, -1 if the number of vertices is not 3..ROI_MAX_VERTICES
+int ps_roi_set_polygon( ps_roi_config *roi, const float (*vertex)[2], int vertices, float ground_z )
+{
+    int i = 0;
+    float dy = 0.0f;
+
+    if( vertices < 3 || vertices > ROI_MAX_VERTICES )
+    {
+        return -1;
+    }
+
+    memset( roi, 0, sizeof(*roi) );
+
+    roi->type = ROI_POLYGON;
+    roi->ground_z = ground_z;
+    roi->vertices = vertices;
+
+    for( i = 0; i < vertices; i++ )
+    {
+        roi->vertex[i][0] = vertex[i][0];
+        roi->vertex[i][1] = vertex[i][1];
+    }
+
+    // closed, so edge i always ends at vertex i + 1
+    roi->vertex[vertices][0] = vertex[0][0];
+    roi->vertex[vertices][1] = vertex[0][1];
+
+    // a horizontal edge is never crossed, its slope is not used
+    for( i = 0; i < vertices; i++ )
+    {
+        dy = roi->vertex[i + 1][1] - roi->vertex[i][1];
+        roi->edge_slope[i] = dy != 0.0f ? (roi->vertex[i + 1][0] - roi->vertex[i][0]) / dy : 0.0f;
+    }
+
+    roi_init_vector();
+
+    return 0;
+}
+
+
+// azimuths in degrees, counterclockwise from x, the sector goes from @azimuth_min to @azimuth_max
+void ps_roi_set_sector( ps_roi_config *roi, float range_min, float range_max, float azimuth_min, float azimuth_max, float ground_z )
+{
+    double span = azimuth_max - azimuth_min;
+
+    memset( roi, 0, sizeof(*roi) );
+
+    while( span <= 0.0 )
+    {
+        span += 360.0;
+    }
+    while( span > 360.0 )
+    {
+        span -= 360.0;
+    }
+
+    roi->type = ROI_SECTOR;
+    roi->ground_z = ground_z;
+    roi->range2_min = range_min * range_min;
+    roi->range2_max = range_max * range_max;
+    roi->azimuth_dir[0][0] = (float) cos( azimuth_min * DEG_TO_RAD );
+    roi->azimuth_dir[0][1] = (float) sin( azimuth_min * DEG_TO_RAD );
+    roi->azimuth_dir[1][0] = (float) cos( (azimuth_min + span) * DEG_TO_RAD );
+    roi->azimuth_dir[1][1] = (float) sin( (azimuth_min + span) * DEG_TO_RAD );
+    roi->wide = span > 180.0;
+
+    roi_init_vector();
+}
+
+
+// parse a PS_ROI string, return 0 on success, -1 if it is not valid and @roi is unchanged
+int ps_roi_parse( ps_roi_config *roi, const char *spec, float ground_z )
+{
+    float value[2 * ROI_MAX_VERTICES + 1];
+    char type[16];
+    int count = 0;
+    int used = 0;
+    const char *cursor = NULL;
+
+    if( sscanf( spec, "%15s%n", type, &used ) != 1 )
+    {
+        return -1;
+    }
+
+    // read all the numbers after the type
+    cursor = spec + used;
+    while( count < 2 * ROI_MAX_VERTICES + 1 && sscanf( cursor, "%f%n", &value[count], &used ) == 1 )
+    {
+        cursor += used;
+        count++;
+    }
+
+    if( strcmp( type, "box" ) == 0 && count == 4 )
+    {
+        ps_roi_set_box( roi, value[0], value[1], value[2], value[3], ground_z );
+        return 0;
+    }
+
+    if( strcmp( type, "sector" ) == 0 && count == 4 )
+    {
+        ps_roi_set_sector( roi, value[0], value[1], value[2], value[3], ground_z );
+        return 0;
+    }
+
+    if( strcmp( type, "polygon" ) == 0 && count % 2 == 0 )
+    {
+        ps_roi_config polygon;
+
+        if( ps_roi_set_polygon( &polygon, (const float (*)[2]) value, count / 2, ground_z ) != 0 )
+        {
+            return -1;
+        }
+
+        *roi = polygon;
+        return 0;
+    }
+
+    return -1;
+}
+
+
+// the region of interest of PS_ROI and PS_ROI_GROUND, the box in front of the car by default
+int ps_roi_from_env( ps_roi_config *roi )
+{
+    const char *spec = getenv( ROI_ENV );
+    const char *ground = getenv( ROI_GROUND_ENV );
+    const float ground_z = ground != NULL ? (float) atof( ground ) : 0.0f;
+
+    ps_roi_set_box( roi, -FLT_MAX, 15.0f, -1.2f, 1.2f, ground_z );
+
+    if( spec == NULL )
+    {
+        return 0;
+    }
+
+    return ps_roi_parse( roi, spec, ground_z );
+}
+
+
+// 1 if the point is kept, the tests are combined without a branch
+static int roi_inside( const ps_roi_config * const roi, const float px, const float py, const float pz )
+{
+    int inside = 0;
+    int i = 0;
+
+    switch( roi->type )
+    {
+        case ROI_BOX:
+            inside = (px > roi->box_min[0]) & (px < roi->box_max[0])
+                    & (py > roi->box_min[1]) & (py < roi->box_max[1]);
+            break;
+
+        case ROI_POLYGON:
+            // crossing number, one crossing test per edge
+            for( i = 0; i < roi->vertices; i++ )
+            {
+                const float y0 = roi->vertex[i][1];
+                const float y1 = roi->vertex[i + 1][1];
+
+                inside ^= ((y0 > py) != (y1 > py))
+                        & (px < roi->vertex[i][0] + (py - y0) * roi->edge_slope[i]);
+            }
+            break;
+
+        case ROI_SECTOR:
+        {
+            const float range2 = px * px + py * py;
+            const float from = roi->azimuth_dir[0][0] * py - roi->azimuth_dir[0][1] * px;
+            const float to = px * roi->azimuth_dir[1][1] - py * roi->azimuth_dir[1][0];
+
+            // a sector over 180 degrees is all but the sector between its two sides
+            inside = (range2 >= roi->range2_min) & (range2 <= roi->range2_max)
+                    & ( roi->wide ? ((from >= 0.0f) | (to >= 0.0f)) : ((from >= 0.0f) & (to >= 0.0f)) );
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return inside & (pz > roi->ground_z);
+}
+
+
+//
+static unsigned long roi_filter_scalar(
+        const ps_roi_config * const roi,
+        const float *position,
+        const unsigned long stride,
+        const unsigned long count,
+        float *x,
+        float *y,
+        float *z )
+{
+    unsigned long index = 0;
+    unsigned long kept = 0;
+
+    for( index = 0; index < count; index++ )
+    {
+        const float * const p = (const float*) ((const char*) position + index * stride);
+
+        // always written, only kept points move the end of the output
+        x[kept] = p[0];
+        y[kept] = p[1];
+        z[kept] = p[2];
+        kept += (unsigned long) roi_inside( roi, p[0], p[1], p[2] );
+    }
+
+    return kept;
+}
+
+
+#ifdef ROI_X86
+//
+__attribute__((target("avx2")))
+static __m256 roi_inside_avx2( const ps_roi_config * const roi, const __m256 px, const __m256 py, const __m256 pz )
+{
+    __m256 inside = _mm256_setzero_ps();
+    int i = 0;
+
+    switch( roi->type )
+    {
+        case ROI_BOX:
+            inside = _mm256_and_ps(
+                    _mm256_and_ps(
+                            _mm256_cmp_ps( px, _mm256_set1_ps( roi->box_min[0] ), _CMP_GT_OQ ),
+                            _mm256_cmp_ps( px, _mm256_set1_ps( roi->box_max[0] ), _CMP_LT_OQ ) ),
+                    _mm256_and_ps(
+                            _mm256_cmp_ps( py, _mm256_set1_ps( roi->box_min[1] ), _CMP_GT_OQ ),
+                            _mm256_cmp_ps( py, _mm256_set1_ps( roi->box_max[1] ), _CMP_LT_OQ ) ) );
+            break;
+
+        case ROI_POLYGON:
+            for( i = 0; i < roi->vertices; i++ )
+            {
+                const __m256 y0 = _mm256_set1_ps( roi->vertex[i][1] );
+                const __m256 y1 = _mm256_set1_ps( roi->vertex[i + 1][1] );
+                const __m256 straddle = _mm256_xor_ps(
+                        _mm256_cmp_ps( y0, py, _CMP_GT_OQ ),
+                        _mm256_cmp_ps( y1, py, _CMP_GT_OQ ) );
+                const __m256 cross_x = _mm256_add_ps(
+                        _mm256_set1_ps( roi->vertex[i][0] ),
+                        _mm256_mul_ps( _mm256_sub_ps( py, y0 ), _mm256_set1_ps( roi->edge_slope[i] ) ) );
+
+                inside = _mm256_xor_ps( inside, _mm256_and_ps( straddle, _mm256_cmp_ps( px, cross_x, _CMP_LT_OQ ) ) );
+            }
+            break;
+
+        case ROI_SECTOR:
+        {
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 range2 = _mm256_add_ps( _mm256_mul_ps( px, px ), _mm256_mul_ps( py, py ) );
+            const __m256 from = _mm256_sub_ps(
+                    _mm256_mul_ps( _mm256_set1_ps( roi->azimuth_dir[0][0] ), py ),
+                    _mm256_mul_ps( _mm256_set1_ps( roi->azimuth_dir[0][1] ), px ) );
+            const __m256 to = _mm256_sub_ps(
+                    _mm256_mul_ps( px, _mm256_set1_ps( roi->azimuth_dir[1][1] ) ),
+                    _mm256_mul_ps( py, _mm256_set1_ps( roi->azimuth_dir[1][0] ) ) );
+            const __m256 from_ok = _mm256_cmp_ps( from, zero, _CMP_GE_OQ );
+            const __m256 to_ok = _mm256_cmp_ps( to, zero, _CMP_GE_OQ );
+
+            inside = _mm256_and_ps(
+                    _mm256_and_ps(
+                            _mm256_cmp_ps( range2, _mm256_set1_ps( roi->range2_min ), _CMP_GE_OQ ),
+                            _mm256_cmp_ps( range2, _mm256_set1_ps( roi->range2_max ), _CMP_LE_OQ ) ),
+                    roi->wide ? _mm256_or_ps( from_ok, to_ok ) : _mm256_and_ps( from_ok, to_ok ) );
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return _mm256_and_ps( inside, _mm256_cmp_ps( pz, _mm256_set1_ps( roi->ground_z ), _CMP_GT_OQ ) );
+}
+
+
+// 8 points at a time: gather, test, and store the kept lanes packed at the end of the output
+__attribute__((target("avx2")))
+static unsigned long roi_filter_avx2(
+        const ps_roi_config * const roi,
+        const float *position,
+        const unsigned long stride,
+        const unsigned long count,
+        float *x,
+        float *y,
+        float *z )
+{
+    const __m256i offset = _mm256_mullo_epi32( _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ), _mm256_set1_epi32( (int) stride ) );
+    unsigned long index = 0;
+    unsigned long kept = 0;
+    int mask = 0;
+
+    for( index = 0; index + 8 <= count; index += 8 )
+    {
+        const float * const base = (const float*) ((const char*) position + index * stride);
+        const __m256 px = _mm256_i32gather_ps( base, offset, 1 );
+        const __m256 py = _mm256_i32gather_ps( base + 1, offset, 1 );
+        const __m256 pz = _mm256_i32gather_ps( base + 2, offset, 1 );
+        __m256i order;
+
+        mask = _mm256_movemask_ps( roi_inside_avx2( roi, px, py, pz ) );
+        order = _mm256_loadu_si256( (const __m256i*) roi_compaction[mask] );
+
+        _mm256_storeu_ps( x + kept, _mm256_permutevar8x32_ps( px, order ) );
+        _mm256_storeu_ps( y + kept, _mm256_permutevar8x32_ps( py, order ) );
+        _mm256_storeu_ps( z + kept, _mm256_permutevar8x32_ps( pz, order ) );
+        kept += (unsigned long) __builtin_popcount( (unsigned int) mask );
+    }
+
+    return kept + roi_filter_scalar(
+            roi,
+            (const float*) ((const char*) position + index * stride),
+            stride,
+            count - index,
+            x + kept,
+            y + kept,
+            z + kept );
+}
+#endif
+
+
+/**
+ * @brief Keep the points inside the region of interest and above the ground.
+ *
+ * @param [in] position x of the first point, y and z follow it.
+ * @param [in] stride Bytes from a point to the next, sizeof(ps_lidar_point) for a lidar message.
+ * @param [out] x y z Kept points, packed, each able to hold @count floats.
+ *
+ * @return The number of points kept.
+ *
+ */
+unsigned long ps_roi_filter(
+        const ps_roi_config *roi,
+        const float *position,
+        unsigned long stride,
+        unsigned long count,
+        float *x,
+        float *y,
+        float *z )
+{
+#ifdef ROI_X86
+    // the gather takes 32-bit byte offsets
+    if( roi_avx2 && stride * 8 < 0x7fffffffUL )
+    {
+        return roi_filter_avx2( roi, position, stride, count, x, y, z );
+    }
+#endif
+
+    return roi_filter_scalar( roi, position, stride, count, x, y, z );
+}
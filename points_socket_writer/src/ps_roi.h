@@ -0,0 +1,91 @@
+#ifndef PS_ROI_H_
+#define PS_ROI_H_
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+
+
+// *****************************************************
+// static global types/macros
+// *****************************************************
+
+/**
+ * @brief Shapes of the region of interest.
+ *
+ */
+#define ROI_BOX (0)
+#define ROI_POLYGON (1)
+#define ROI_SECTOR (2)
+
+
+/**
+ * @brief Vertices a polygon can have.
+ *
+ */
+#define ROI_MAX_VERTICES (16)
+
+
+/**
+ * @brief Environment variables read by ps_roi_from_env.
+ *
+ * PS_ROI is one of
+ *   "box x_min x_max y_min y_max"
+ *   "polygon x1 y1 x2 y2 x3 y3 ..."
+ *   "sector range_min range_max azimuth_min azimuth_max", azimuths in degrees, counterclockwise from x
+ * PS_ROI_GROUND is the height a point must be above.
+ *
+ */
+#define ROI_ENV "PS_ROI"
+#define ROI_GROUND_ENV "PS_ROI_GROUND"
+
+
+/**
+ * @brief Region of interest in the sensor frame, in meters.
+ *
+ * Set the shape with ps_roi_set_box, ps_roi_set_polygon or ps_roi_set_sector,
+ * they also fill the precomputed members used by ps_roi_filter.
+ *
+ */
+typedef struct ps_roi_config
+{
+    int type;
+    float ground_z;
+    // ROI_BOX
+    float box_min[2];
+    float box_max[2];
+    // ROI_POLYGON, edge i goes from vertex i to vertex i + 1
+    int vertices;
+    float vertex[ROI_MAX_VERTICES + 1][2];
+    float edge_slope[ROI_MAX_VERTICES];
+    // ROI_SECTOR
+    float range2_min;
+    float range2_max;
+    float azimuth_dir[2][2];
+    int wide;
+} ps_roi_config;
+
+
+
+
+// *****************************************************
+// user-definition function declarations
+// *****************************************************
+void ps_roi_set_box( ps_roi_config *roi, float x_min, float x_max, float y_min, float y_max, float ground_z );
+int  ps_roi_set_polygon( ps_roi_config *roi, const float (*vertex)[2], int vertices, float ground_z );
+void ps_roi_set_sector( ps_roi_config *roi, float range_min, float range_max, float azimuth_min, float azimuth_max, float ground_z );
+int  ps_roi_parse( ps_roi_config *roi, const char *spec, float ground_z );
+int  ps_roi_from_env( ps_roi_config *roi );
+unsigned long ps_roi_filter(
+        const ps_roi_config *roi,
+        const float *position,
+        unsigned long stride,
+        unsigned long count,
+        float *x,
+        float *y,
+        float *z );
+
+
+#endif
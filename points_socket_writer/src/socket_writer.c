@@ -2,6 +2,9 @@
 #include <stdlib.h>
 #include <signal.h>
 #include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
 
 // API headers
 #include "polysync_core.h"
@@ -11,6 +14,17 @@
 #include "polysync_socket.h"
 #include "polysync_node_template.h"
 
+// per-frame clustering
+#include "ps_cluster.h"
+#include "ps_frame_queue.h"
+#include "ps_roi.h"
+
+// stage timings, compiled out without PS_LATENCY
+#include "ps_latency.h"
+
+// real-time mode of the worker, PS_RT
+#include "ps_rt.h"
+
 
 
 // *****************************************************
@@ -42,6 +56,13 @@
 static const char UDP_ADDRESS[] = "127.0.0.1";
 
 
+/**
+ * @brief Datagrams the UDP output is allocated for in on_init, a larger frame grows it once.
+ *
+ */
+#define WIRE_SENDER_DATAGRAMS (8)
+
+
 /**
  * @brief PolySync node name.
  *
@@ -56,24 +77,95 @@ static const char NODE_NAME[] = "polysync-socket-writer-c";
 static const char OBJECTS_MSG_NAME[] = "ps_lidar_points_msg";
 
 /**
- * @brief global socket.
+ * @brief global UDP output, datagrams of a frame sent in one batch.
  *
  */
-ps_socket *my_socket = NULL;
+WireSender *my_sender = NULL;
 
 
 /**
- * @brief Debug test.
+ * @brief global clustering state, only used by the worker thread.
  *
  */
-#define DEBUG_DEAN
-#ifdef DEBUG_DEAN
+static ps_cluster_frame my_cluster;
 
-	//#define TESE
-	//#define DETAIL
-	#define OUTPUT
 
-#endif
+/**
+ * @brief region of interest, set from the environment in on_init.
+ *
+ */
+static ps_roi_config my_roi;
+
+
+/**
+ * @brief frames handed from the listener to the worker thread.
+ *
+ */
+static ps_frame_queue my_queue;
+
+
+/**
+ * @brief worker thread, filters, clusters and sends the frames.
+ *
+ */
+static pthread_t my_worker;
+static int worker_running = 0;
+static int worker_quit = 0;
+
+
+/**
+ * @brief real-time mode of PS_RT, the worker is pinned and scheduled SCHED_FIFO.
+ *
+ * The frames drive the worker, it keeps waiting on @ref my_queue rather than on a period.
+ *
+ */
+static RtConfig my_rt;
+
+
+/**
+ * @brief sequence number of the next frame sent, only used by the worker thread.
+ *
+ */
+static unsigned int my_sequence = 0;
+
+
+/**
+ * @brief Stages timed by the listener, from the sensor timestamp of the frame.
+ *
+ */
+enum
+{
+    LISTENER_RECEIVE,
+    LISTENER_FILTER,
+    LISTENER_STAGES
+};
+
+static const char * const LISTENER_STAGE_NAME[] = { "receive", "filter" };
+
+
+/**
+ * @brief Stages timed by the worker, the last one from the sensor timestamp to the send.
+ *
+ */
+enum
+{
+    WORKER_QUEUE,
+    WORKER_CLUSTER,
+    WORKER_ENCODE,
+    WORKER_SEND,
+    WORKER_END_TO_END,
+    WORKER_STAGES
+};
+
+static const char * const WORKER_STAGE_NAME[] = { "queue", "cluster", "encode", "send", "end-to-end" };
+
+
+/**
+ * @brief latency histograms of the listener and of the worker, each written by its own thread only.
+ *
+ */
+static LatencyRecorder listener_latency;
+static LatencyRecorder worker_latency;
 
 // *****************************************************
 // static declarations
@@ -221,121 +313,267 @@ static void ps_lidar_points_msg__handler(
         const ps_msg_ref const message,
         void * const user_data )
 {
-    
-      // local vars
-    int ret = DTC_NONE;
-    //const ps_objects_msg * const objects_msg = (ps_objects_msg*) message;
-    char buffer[1248];
-    unsigned long buffer_size = 0;
-    unsigned long bytes_written = 0;
-    ps_socket *socket = NULL;
+    // local vars
+    ps_frame *frame = NULL;
+    LATENCY_CLOCK( clock );
 
+    // cast to message
+    const ps_lidar_points_msg * const lidar_points_msg = (ps_lidar_points_msg*) message;
+    const ps_lidar_point * const _buffer = lidar_points_msg->points._buffer;
 
-    // cast
-    socket = (ps_socket*) my_socket;
 
-    // check reference since other routines don't
-    if( socket == NULL )
+    // how old the scan is when it gets here
+    LATENCY_START( clock );
+    LATENCY_SENSOR_AGE( &listener_latency, LISTENER_RECEIVE, lidar_points_msg->header.timestamp );
+
+    // the frame owned by the listener, it only grows for a frame larger than any before
+    frame = ps_frame_queue_writing( &my_queue, lidar_points_msg->points._length );
+    if( frame == NULL )
     {
         psync_log_message(
                 LOG_LEVEL_ERROR,
-                "%s : (%u) -- invalid socket",
+                "%s : (%u) -- failed to allocate %lu lidar points",
                 __FILE__,
-                __LINE__ );
+                __LINE__,
+                (unsigned long) lidar_points_msg->points._length );
 
-        //psync_node_activate_fault( node_ref, DTC_USAGE, NODE_STATE_FATAL );
         return;
     }
 
-    // zero
-    memset( buffer, 0, sizeof(buffer) );
+    (void) clock_gettime( CLOCK_MONOTONIC, &frame->received );
+    frame->timestamp = (unsigned long long) lidar_points_msg->header.timestamp;
+
+    // only the points inside the region of interest are copied, the worker does the rest
+    frame->length = ps_roi_filter(
+            &my_roi,
+            _buffer[0].position,
+            sizeof(*_buffer),
+            lidar_points_msg->points._length,
+            frame->x,
+            frame->y,
+            frame->z );
 
-    // copy bytes into buffer
-    strcpy( buffer, "message from socket write");
+    LATENCY_LAP( &listener_latency, LISTENER_FILTER, clock );
+    LATENCY_KEEP( frame->clock, clock );
 
+    // hand it over, the oldest waiting frame is dropped if the worker is behind
+    ps_frame_queue_push( &my_queue );
+}
 
-    // set buffer size
-    buffer_size = strlen(buffer) + 1;
 
-    #ifdef TEST
-    	printf( "writing socket buffer '%s' - %lu bytes\n",
-            buffer,
-            buffer_size );
-	#endif
+/**
+ * @brief Send the clusters of a frame, fragmented in \ref WIRE_DATAGRAM_SIZE datagrams sent in one batch.
+ *
+ * @param [in] clock Time the encoding started, for the encode and send stages.
+ *
+ * @return DTC code:
+ * \li \ref DTC_NONE (zero) if all the datagrams went out.
+ * \li \ref DTC_MEMERR if the datagrams could not be allocated.
+ * \li \ref DTC_IOERR if a send failed.
+ *
+ */
+static int send_clusters(
+        WireSender * const sender,
+        const ps_cluster_packet * const packet,
+        unsigned long long clock )
+{
+    // local vars
+    WireFrame frame;
+    int datagrams = 0;
 
-    // send data
-    ret = psync_socket_send_to(
-            socket,
-            (unsigned char*) buffer,
-            buffer_size,
-            &bytes_written );
 
-    // activate fatal error and return if failed
-    if( ret != DTC_NONE )
+    frame.kind = WIRE_KIND_CLUSTERS;
+    frame.sequence = my_sequence++;
+    frame.timestamp = (uint64_t) packet->timestamp;
+    frame.record = packet->box;
+    frame.count = (int) packet->cluster_count;
+
+    if( (datagrams = encodeWireFrame( sender, &frame )) < 0 )
+    {
+        return DTC_MEMERR;
+    }
+
+    LATENCY_LAP( &worker_latency, WORKER_ENCODE, clock );
+
+    if( sendWireDatagrams( sender, datagrams ) != 0 )
+    {
+        return DTC_IOERR;
+    }
+
+    LATENCY_LAP( &worker_latency, WORKER_SEND, clock );
+    LATENCY_SENSOR_AGE( &worker_latency, WORKER_END_TO_END, frame.timestamp );
+
+    return DTC_NONE;
+}
+
+
+#ifdef PS_LATENCY
+/**
+ * @brief Log the latency histograms of the listener and of the worker.
+ *
+ */
+static void log_latency( void )
+{
+    // local vars
+    const LatencyRecorder * const recorder[] = { &listener_latency, &worker_latency };
+    char text[160];
+    unsigned int index = 0;
+    int stage = 0;
+
+
+    for( index = 0; index < sizeof(recorder) / sizeof(recorder[0]); index++ )
+    {
+        for( stage = 0; stage < recorder[index]->stages; stage++ )
+        {
+            (void) formatLatency( text, sizeof(text), &recorder[index]->stage[stage] );
+
+            psync_log_message(
+                    LOG_LEVEL_INFO,
+                    "%s : (%u) -- %s latency %s",
+                    __FILE__,
+                    __LINE__,
+                    recorder[index]->name,
+                    text );
+        }
+    }
+}
+#endif
+
+
+/**
+ * @brief Filter, cluster and send one frame, on the worker thread.
+ *
+ */
+static void process_frame(
+        WireSender * const sender,
+        const ps_frame * const frame )
+{
+    // local vars
+    int ret = DTC_NONE;
+    unsigned long long clock = frame->clock;
+
+
+    // time spent waiting in the queue
+    LATENCY_LAP( &worker_latency, WORKER_QUEUE, clock );
+
+    // start the frame at its reception
+    if( ps_cluster_begin( &my_cluster, frame->timestamp, frame->length, &frame->received ) != 0 )
     {
         psync_log_message(
                 LOG_LEVEL_ERROR,
-                "%s : (%u) -- psync_socket_send_to returned DTC %d",
+                "%s : (%u) -- failed to allocate %lu lidar points",
                 __FILE__,
                 __LINE__,
-                ret );
+                frame->length );
 
-       // psync_node_activate_fault( node_ref, ret, NODE_STATE_FATAL );
         return;
     }
 
+    // the points were filtered by the listener
+    ps_cluster_set_points( &my_cluster, frame->x, frame->y, frame->z, frame->length );
 
-    // cast to message
-    const ps_lidar_points_msg * const lidar_points_msg = (ps_lidar_points_msg*) message;
+    // cluster the frame and fill the packet, nothing is sent for a frame the memory was not there for
+    if( ps_cluster_run( &my_cluster ) < 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_ERROR,
+                "%s : (%u) -- failed to allocate the clustering of %lu lidar points, %lu frames dropped",
+                __FILE__,
+                __LINE__,
+                frame->length,
+                my_cluster.dropped );
 
-    #ifdef DETAIL
-		// print details
-    	printf( "  received lidar_points message from node 0x%016llX (%llu)\n",
-            	(unsigned long long) lidar_points_msg->header.src_guid,
-            	(unsigned long long) lidar_points_msg->header.src_guid );
+        return;
+    }
 
-    	printf( "  received lidar_points message from node 0x%016llX (%llu)\n",
-            	(unsigned long long) lidar_points_msg->header.timestamp,
-            	(unsigned long long) lidar_points_msg->header.timestamp );
-	#endif
+    LATENCY_LAP( &worker_latency, WORKER_CLUSTER, clock );
 
-    unsigned long lidar_points_index = 0;
+    // send the clusters of this frame
+    ret = send_clusters( sender, &my_cluster.packet, clock );
 
-    // 
-    while( lidar_points_index < lidar_points_msg->points._length )
+    if( ret != DTC_NONE )
     {
+        psync_log_message(
+                LOG_LEVEL_ERROR,
+                "%s : (%u) -- failed to send the clusters, DTC %d",
+                __FILE__,
+                __LINE__,
+                ret );
+    }
 
-        const ps_lidar_point *_buffer = lidar_points_msg->points._buffer;
-
-	#ifdef DETAIL
-        	printf( "  publishers lidar_points :\n");
-        	printf( "  received length = 0x%016llX\n",
-               	 	(unsigned long) lidar_points_msg->points._length);
-			printf( "  received position:\nx = %016lf\ny = %016lf\nz = %016lf\n",
-				(double) _buffer[lidar_points_index].position[0],
-				(double) _buffer[lidar_points_index].position[1],
-				(double) _buffer[lidar_points_index].position[2]);
-	#endif
+    // stop the clock of the frame
+    if( ps_cluster_end( &my_cluster ) != 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_WARN,
+                "%s : (%u) -- frame took %llu us, budget is %d us, %lu frames waiting",
+                __FILE__,
+                __LINE__,
+                my_cluster.latency.last_us,
+                CLUSTER_FRAME_BUDGET_US,
+                ps_frame_queue_depth( &my_queue ) );
+    }
+}
 
 
-	#ifdef	OUTPUT
+/**
+ * @brief Worker thread, processes the frames of @ref my_queue until on_release.
+ *
+ */
+static void *worker_main( void *arg )
+{
+    WireSender * const sender = (WireSender*) arg;
+    const ps_frame *frame = NULL;
+    LATENCY_CLOCK( report );
 
-		if(		_buffer[lidar_points_index].position[0] < 15 && 
-				abs( _buffer[lidar_points_index].position[1]*10) < 12 && 
-				_buffer[lidar_points_index].position[2] > 0)
-		
-			printf( "%016lf\t%016lf\t%016lf\n",
-                		(double) _buffer[lidar_points_index].position[0],
-						(double) _buffer[lidar_points_index].position[1],
-						(double) _buffer[lidar_points_index].position[2]);
+    LATENCY_START( report );
 
-	#endif
-			
-    lidar_points_index++;
+    // before the first frame, the listener keeps the default priority
+    if( my_rt.enabled )
+    {
+        if( rtEnterThread( &my_rt ) != 0 )
+        {
+            psync_log_message(
+                    LOG_LEVEL_WARN,
+                    "%s : (%u) -- SCHED_FIFO %d on cpu %d failed, %s, the worker runs at the default priority",
+                    __FILE__,
+                    __LINE__,
+                    my_rt.priority,
+                    my_rt.cpu,
+                    strerror( errno ) );
+        }
+        else
+        {
+            psync_log_message(
+                    LOG_LEVEL_INFO,
+                    "%s : (%u) -- worker thread SCHED_FIFO %d on cpu %d",
+                    __FILE__,
+                    __LINE__,
+                    my_rt.priority,
+                    my_rt.cpu );
+        }
     }
 
+    while( !__atomic_load_n( &worker_quit, __ATOMIC_ACQUIRE ) )
+    {
+        ps_frame_queue_wait( &my_queue );
+
+        while( (frame = ps_frame_queue_pop( &my_queue )) != NULL )
+        {
+            process_frame( sender, frame );
+        }
+
+#ifdef PS_LATENCY
+        // periodic report, off the path of a frame
+        if( latencyNow() - report > LATENCY_REPORT_NS )
+        {
+            log_latency();
+            report = latencyNow();
+        }
+#endif
+    }
 
-    printf( "\n" );
+    return NULL;
 }
 
 
@@ -344,7 +582,7 @@ static int set_configuration(
         ps_node_configuration_data * const node_config )
 {
     // local vars
-    ps_socket *socket = NULL;
+    WireSender *sender = NULL;
 
 
     // set node configuration default values
@@ -368,24 +606,25 @@ static int set_configuration(
     memset( node_config->node_name, 0, sizeof(node_config->node_name) );
     strncpy( node_config->node_name, NODE_NAME, sizeof(node_config->node_name) );
 
-    // create CAN channel
-    if( (socket = malloc( sizeof(*socket) )) == NULL )
+    // create UDP output
+    if( (sender = malloc( sizeof(*sender) )) == NULL )
     {
         psync_log_message(
                 LOG_LEVEL_ERROR,
-                "%s : (%u) -- failed to allocate socket data structure",
+                "%s : (%u) -- failed to allocate sender data structure",
                 __FILE__,
                 __LINE__ );
 
         return DTC_MEMERR;
     }
 
-    // zero
-    memset( socket, 0, sizeof(*socket) );
+    // zero, no socket yet
+    memset( sender, 0, sizeof(*sender) );
+    sender->fd = -1;
 
     // set user data pointer to our top-level node data
     // this will get passed around to the various interface routines
-    node_config->user_data = (void*) socket;
+    node_config->user_data = (void*) sender;
 
     return DTC_NONE;
 }
@@ -397,26 +636,20 @@ static void on_init(
         const ps_diagnostic_state * const state,
         void * const user_data )
 {
-<<<<<<< HEAD
-    //init cluster
-    Init();  
-    
-=======
->>>>>>> 3d00ae2e0548b50e0dad3ad7aa1a05209c9da2cf
     // local vars
     int ret = DTC_NONE;
-    ps_socket *socket = NULL;
+    WireSender *sender = NULL;
     ps_msg_type msg_type = PSYNC_MSG_TYPE_INVALID;
 
     // cast
-    socket = (ps_socket*) user_data;
+    sender = (WireSender*) user_data;
 
     // check reference since other routines don't
-    if( socket == NULL )
+    if( sender == NULL )
     {
         psync_log_message(
                 LOG_LEVEL_ERROR,
-                "%s : (%u) -- invalid socket",
+                "%s : (%u) -- invalid sender",
                 __FILE__,
                 __LINE__ );
 
@@ -424,66 +657,103 @@ static void on_init(
         return;
     }
 
-    // init UDP socket
-    ret = psync_socket_init(
-            socket,
-            AF_INET,
-            SOCK_DGRAM,
-            IPPROTO_UDP );
-
-    // activate fatal error and return if failed
-    if( ret != DTC_NONE )
+    // init UDP socket to the address and port, with datagram buffers for a typical frame
+    if( openWireSender( sender, UDP_ADDRESS, UDP_PORT, WIRE_SENDER_DATAGRAMS ) != 0 )
     {
         psync_log_message(
                 LOG_LEVEL_ERROR,
-                "%s : (%u) -- psync_socket_init returned DTC %d",
+                "%s : (%u) -- failed to open the UDP output to %s:%d",
                 __FILE__,
                 __LINE__,
-                ret );
+                UDP_ADDRESS,
+                UDP_PORT );
 
-        psync_node_activate_fault( node_ref, ret, NODE_STATE_FATAL );
+        psync_node_activate_fault( node_ref, DTC_IOERR, NODE_STATE_FATAL );
         return;
     }
 
-    // set address and port
-    ret = psync_socket_set_address(
-            socket,
-            UDP_ADDRESS,
-            UDP_PORT );
 
-    // activate fatal error and return if failed
-    if( ret != DTC_NONE )
+    // allocate the clustering and the frames once, not per frame
+    if( ps_cluster_init( &my_cluster, CLUSTER_POINTS_CAPACITY ) != 0
+            || ps_frame_queue_init( &my_queue, CLUSTER_POINTS_CAPACITY ) != 0 )
     {
         psync_log_message(
                 LOG_LEVEL_ERROR,
-                "%s : (%u) -- psync_socket_set_address returned DTC %d",
+                "%s : (%u) -- failed to allocate the clustering",
                 __FILE__,
-                __LINE__,
-                ret );
+                __LINE__ );
 
-        psync_node_activate_fault( node_ref, ret, NODE_STATE_FATAL );
+        psync_node_activate_fault( node_ref, DTC_MEMERR, NODE_STATE_FATAL );
         return;
     }
 
-    // set socket reuse option for multiple connections
-    ret = psync_socket_set_reuse_option( socket, 1 );
+    // DBSCAN or the range image
+    if( ps_cluster_mode_from_env( &my_cluster ) != 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_WARN,
+                "%s : (%u) -- invalid %s '%s', using dbscan",
+                __FILE__,
+                __LINE__,
+                CLUSTER_MODE_ENV,
+                getenv( CLUSTER_MODE_ENV ) );
+    }
 
-    // activate fatal error and return if failed
-    if( ret != DTC_NONE )
+    // region of interest of PS_ROI and PS_ROI_GROUND
+    if( ps_roi_from_env( &my_roi ) != 0 )
     {
         psync_log_message(
-                LOG_LEVEL_ERROR,
-                "%s : (%u) -- psync_socket_set_reuse_option returned DTC %d",
+                LOG_LEVEL_WARN,
+                "%s : (%u) -- invalid %s '%s', using the default box",
                 __FILE__,
                 __LINE__,
-                ret );
+                ROI_ENV,
+                getenv( ROI_ENV ) );
+    }
 
-        psync_node_activate_fault( node_ref, ret, NODE_STATE_FATAL );
-        return;
+    my_sender = sender;
+
+    // real-time mode, everything above is allocated so the memory is locked with it
+    if( rtConfigFromEnv( &my_rt ) != 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_WARN,
+                "%s : (%u) -- %s=%s is not cpu[:priority], the real-time mode is off",
+                __FILE__,
+                __LINE__,
+                RT_ENV,
+                getenv( RT_ENV ) );
     }
 
+    if( my_rt.enabled && rtLockMemory() != 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_WARN,
+                "%s : (%u) -- mlockall failed, %s, the memory is not locked",
+                __FILE__,
+                __LINE__,
+                strerror( errno ) );
+    }
+
+    // empty histograms, the clock is calibrated before any thread reads it
+    initialLatencyClock();
+    initialLatency( &listener_latency, "listener", LISTENER_STAGE_NAME, LISTENER_STAGES );
+    initialLatency( &worker_latency, "worker", WORKER_STAGE_NAME, WORKER_STAGES );
 
-    my_socket = socket;
+    // start the worker before any frame arrives
+    worker_quit = 0;
+    if( pthread_create( &my_worker, NULL, worker_main, (void*) sender ) != 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_ERROR,
+                "%s : (%u) -- failed to start the worker thread",
+                __FILE__,
+                __LINE__ );
+
+        psync_node_activate_fault( node_ref, DTC_USAGE, NODE_STATE_FATAL );
+        return;
+    }
+    worker_running = 1;
 
 
     // get objects message type identifier
@@ -534,8 +804,76 @@ static void on_release(
         const ps_diagnostic_state * const state,
         void * const user_data )
 {
-    // local vars
-    
+    // stop the worker, the frames still waiting are processed first
+    if( worker_running )
+    {
+        __atomic_store_n( &worker_quit, 1, __ATOMIC_RELEASE );
+        ps_frame_queue_wake( &my_queue );
+        (void) pthread_join( my_worker, NULL );
+        worker_running = 0;
+    }
+
+    psync_log_message(
+            LOG_LEVEL_INFO,
+            "%s : (%u) -- %lu frames received, %lu processed, %lu dropped, at most %lu waiting",
+            __FILE__,
+            __LINE__,
+            my_queue.stats.pushed,
+            my_queue.stats.popped,
+            my_queue.stats.dropped,
+            my_queue.stats.max_depth );
+
+    // frames the memory of the clustering was not there for
+    if( my_cluster.dropped > 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_WARN,
+                "%s : (%u) -- %lu frames dropped, the clustering ran out of memory",
+                __FILE__,
+                __LINE__,
+                my_cluster.dropped );
+    }
+
+    // latency of the frames
+    if( my_cluster.latency.frames > 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_INFO,
+                "%s : (%u) -- %lu frames, mean %llu us, max %llu us, %lu over the budget of %d us",
+                __FILE__,
+                __LINE__,
+                my_cluster.latency.frames,
+                my_cluster.latency.total_us / my_cluster.latency.frames,
+                my_cluster.latency.max_us,
+                my_cluster.latency.over_budget,
+                CLUSTER_FRAME_BUDGET_US );
+    }
+
+#ifdef PS_LATENCY
+    // latency of the stages, the threads that wrote them are stopped
+    log_latency();
+#endif
+
+    // output of the frames
+    if( my_sender != NULL )
+    {
+        psync_log_message(
+                LOG_LEVEL_INFO,
+                "%s : (%u) -- %lu frames sent in %lu datagrams and %lu system calls, %lu errors",
+                __FILE__,
+                __LINE__,
+                my_sender->stats.frames,
+                my_sender->stats.datagrams,
+                my_sender->stats.calls,
+                my_sender->stats.errors );
+
+        closeWireSender( my_sender );
+    }
+
+    my_sender = NULL;
+
+    ps_cluster_release( &my_cluster );
+    ps_frame_queue_release( &my_queue );
 }
 
 
@@ -579,16 +917,16 @@ static void on_ok(
         void * const user_data )
 {
     
-   ps_socket *socket = NULL;
+   WireSender *sender = NULL;
 
 
     // cast
-    socket = (ps_socket*) user_data;
-    if( socket == NULL )
+    sender = (WireSender*) user_data;
+    if( sender == NULL )
     {
         psync_log_message(
                 LOG_LEVEL_ERROR,
-                "%s : (%u) -- invalid socket",
+                "%s : (%u) -- invalid sender",
                 __FILE__,
                 __LINE__ );
 
@@ -0,0 +1,29 @@
+/**
+ * @file ibeo_lux_4l_driver.h
+ * @brief Replay stand-in of the Ibeo LUX driver header.
+ *
+ * Only the motion CAN of the car the objects node reads its speed from.
+ *
+ */
+#ifndef IBEO_LUX_4L_DRIVER_H
+#define IBEO_LUX_4L_DRIVER_H
+
+
+#include "polysync_core.h"
+
+
+/**
+ * @brief Ego/motion CAN ID for vehicle velocity. [unsigned long]
+ *
+ */
+#define IBEO_LUX_MOTION_CAN_ID_VELOCITY (0x303)
+
+
+/**
+ * @brief Ego/motion CAN vehicle velocity signal scale. [meters/second]
+ *
+ */
+#define IBEO_LUX_MOTION_CAN_VELOCITY_SCALE (0.01)
+
+
+#endif /* IBEO_LUX_4L_DRIVER_H */
@@ -0,0 +1,101 @@
+/**
+ * @file polysync_core.h
+ * @brief Replay stand-in of the PolySync core API.
+ *
+ * Only the types and routines the socket writer nodes use, so they build and
+ * run without the PolySync/OpenSplice runtime. Implemented by src/psync_replay.c.
+ *
+ */
+#ifndef POLYSYNC_CORE_H
+#define POLYSYNC_CORE_H
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+
+
+
+// *****************************************************
+// types
+// *****************************************************
+
+typedef unsigned long long ps_timestamp;
+typedef unsigned long long ps_guid;
+typedef unsigned long long ps_identifier;
+typedef unsigned int ps_node_type;
+typedef unsigned int ps_diagnostic_state;
+
+
+/**
+ * @brief Opaque node reference.
+ *
+ */
+typedef struct ps_node *ps_node_ref;
+
+
+/**
+ * @brief Diagnostic trouble codes.
+ *
+ */
+enum
+{
+    DTC_NONE = 0,
+    DTC_USAGE,
+    DTC_CONFIG,
+    DTC_MEMERR,
+    DTC_IOERR,
+    DTC_OSERR,
+    DTC_ENVERR,
+    DTC_DATAERR,
+    DTC_UNAVAILABLE
+};
+
+
+/**
+ * @brief Log levels.
+ *
+ */
+typedef enum
+{
+    LOG_LEVEL_ERROR = 0,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_DEBUG
+} ps_log_level_kind;
+
+
+#define PSYNC_DEFAULT_DOMAIN (0)
+#define PSYNC_INIT_FLAG_STDOUT_LOGGING (1UL << 0)
+
+
+
+
+// *****************************************************
+// routines
+// *****************************************************
+
+/**
+ * @brief Log a message, to stderr with its level.
+ *
+ */
+void psync_log_message( const ps_log_level_kind level, const char * format, ... ) __attribute__((format(printf, 2, 3)));
+
+
+/**
+ * @brief Get the UTC time in microseconds.
+ *
+ */
+int psync_get_timestamp( ps_timestamp * const timestamp );
+
+
+/**
+ * @brief Sleep for @interval microseconds.
+ *
+ */
+int psync_sleep_micro( const ps_timestamp interval );
+
+
+#endif /* POLYSYNC_CORE_H */
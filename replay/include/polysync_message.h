@@ -0,0 +1,157 @@
+/**
+ * @file polysync_message.h
+ * @brief Replay stand-in of the PolySync message API.
+ *
+ * The message types the replay publishes, with the fields of the
+ * PolySync data model the nodes read.
+ *
+ */
+#ifndef POLYSYNC_MESSAGE_H
+#define POLYSYNC_MESSAGE_H
+
+
+#include "polysync_core.h"
+
+
+
+
+// *****************************************************
+// types
+// *****************************************************
+
+typedef unsigned long ps_msg_type;
+typedef void *ps_msg_ref;
+
+#define PSYNC_MSG_TYPE_INVALID (0)
+
+
+/**
+ * @brief Header of every message.
+ *
+ */
+typedef struct
+{
+    ps_msg_type type;
+    ps_timestamp timestamp;
+    ps_guid src_guid;
+} ps_msg_header;
+
+
+/**
+ * @brief One lidar return.
+ *
+ */
+typedef struct
+{
+    float position[3];
+    unsigned char intensity;
+    unsigned char echo_number;
+    unsigned char quality;
+} ps_lidar_point;
+
+
+/**
+ * @brief "ps_lidar_points_msg", the returns of one scan.
+ *
+ */
+typedef struct
+{
+    ps_msg_header header;
+    ps_timestamp start_timestamp;
+    ps_timestamp end_timestamp;
+    struct
+    {
+        unsigned long _maximum;
+        unsigned long _length;
+        ps_lidar_point *_buffer;
+    } points;
+} ps_lidar_points_msg;
+
+
+/**
+ * @brief One tracked object.
+ *
+ */
+typedef struct
+{
+    ps_identifier id;
+    double position[3];
+    double size[3];
+    double velocity[3];
+    double course_angle;
+    unsigned char classification;
+    unsigned char classification_quality;
+} ps_object;
+
+
+/**
+ * @brief "ps_objects_msg", the objects of one scan.
+ *
+ */
+typedef struct
+{
+    ps_msg_header header;
+    struct
+    {
+        unsigned long _maximum;
+        unsigned long _length;
+        ps_object *_buffer;
+    } objects;
+} ps_objects_msg;
+
+
+/**
+ * @brief "ps_can_frame_msg", one frame of a CAN channel.
+ *
+ */
+typedef struct
+{
+    ps_msg_header header;
+    unsigned long id;
+    struct
+    {
+        unsigned long _maximum;
+        unsigned long _length;
+        unsigned char *_buffer;
+    } data_buffer;
+} ps_can_frame_msg;
+
+
+/**
+ * @brief Message handler, called by the replay for every frame.
+ *
+ */
+typedef void (*ps_message_handler)(
+        const ps_msg_type msg_type,
+        const ps_msg_ref const message,
+        void * const user_data );
+
+
+
+
+// *****************************************************
+// routines
+// *****************************************************
+
+/**
+ * @brief Get the type of the message named @name, "ps_lidar_points_msg", "ps_objects_msg" or "ps_can_frame_msg".
+ *
+ */
+int psync_message_get_type_by_name(
+        ps_node_ref const node_ref,
+        const char * const name,
+        ps_msg_type * const type );
+
+
+/**
+ * @brief Register @handler for the messages of type @type, one handler per type.
+ *
+ */
+int psync_message_register_listener(
+        ps_node_ref const node_ref,
+        const ps_msg_type type,
+        ps_message_handler handler,
+        void * const user_data );
+
+
+#endif /* POLYSYNC_MESSAGE_H */
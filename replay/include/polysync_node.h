@@ -0,0 +1,54 @@
+/**
+ * @file polysync_node.h
+ * @brief Replay stand-in of the PolySync node API.
+ *
+ */
+#ifndef POLYSYNC_NODE_H
+#define POLYSYNC_NODE_H
+
+
+#include "polysync_core.h"
+
+
+
+
+// *****************************************************
+// types
+// *****************************************************
+
+/**
+ * @brief Node states.
+ *
+ */
+enum
+{
+    NODE_STATE_INVALID = 0,
+    NODE_STATE_AUTH,
+    NODE_STATE_INIT,
+    NODE_STATE_OK,
+    NODE_STATE_WARN,
+    NODE_STATE_ERROR,
+    NODE_STATE_FATAL
+};
+
+
+#define PSYNC_NODE_TYPE_API_USER (4)
+
+
+
+
+// *****************************************************
+// routines
+// *****************************************************
+
+/**
+ * @brief Raise @dtc, a fatal state stops the replay after the current callback.
+ *
+ */
+int psync_node_activate_fault(
+        ps_node_ref const node_ref,
+        const int dtc,
+        const int state );
+
+
+#endif /* POLYSYNC_NODE_H */
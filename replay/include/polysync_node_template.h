@@ -0,0 +1,83 @@
+/**
+ * @file polysync_node_template.h
+ * @brief Replay stand-in of the PolySync node template.
+ *
+ * psync_node_main_entry does not join a bus: it initializes the node, publishes
+ * the frames of the recorded files given on the command line to the registered
+ * listener, and releases the node.
+ *
+ */
+#ifndef POLYSYNC_NODE_TEMPLATE_H
+#define POLYSYNC_NODE_TEMPLATE_H
+
+
+#include "polysync_core.h"
+#include "polysync_node.h"
+
+
+
+
+// *****************************************************
+// types
+// *****************************************************
+
+/**
+ * @brief Configuration filled by the set_config callback.
+ *
+ */
+typedef struct
+{
+    ps_node_type node_type;
+    unsigned long domain_id;
+    unsigned long long sdf_key;
+    unsigned long flags;
+    void *user_data;
+    char node_name[256];
+} ps_node_configuration_data;
+
+
+typedef void (*ps_node_state_callback)(
+        ps_node_ref const node_ref,
+        const ps_diagnostic_state * const state,
+        void * const user_data );
+
+
+/**
+ * @brief Node callbacks.
+ *
+ * The replay calls set_config, on_init, then on_release once the frames are
+ * published, and on_fatal if a fatal fault was raised. on_ok, on_warn and
+ * on_error are never called.
+ *
+ */
+typedef struct
+{
+    int (*set_config)( ps_node_configuration_data * const node_config );
+    ps_node_state_callback on_init;
+    ps_node_state_callback on_release;
+    ps_node_state_callback on_warn;
+    ps_node_state_callback on_error;
+    ps_node_state_callback on_fatal;
+    ps_node_state_callback on_ok;
+} ps_node_callbacks;
+
+
+
+
+// *****************************************************
+// routines
+// *****************************************************
+
+/**
+ * @brief Run the node over the recorded files of the command line.
+ *
+ * @return zero if every frame was published, nonzero otherwise.
+ *
+ */
+int psync_node_main_entry(
+        const ps_node_callbacks * const callbacks,
+        int argc,
+        char **argv );
+
+
+#endif /* POLYSYNC_NODE_TEMPLATE_H */
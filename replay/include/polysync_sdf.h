@@ -0,0 +1,16 @@
+/**
+ * @file polysync_sdf.h
+ * @brief Replay stand-in of the PolySync SDF API.
+ *
+ */
+#ifndef POLYSYNC_SDF_H
+#define POLYSYNC_SDF_H
+
+
+#include "polysync_core.h"
+
+
+#define PSYNC_SDF_ID_INVALID (0)
+
+
+#endif /* POLYSYNC_SDF_H */
@@ -0,0 +1,18 @@
+/**
+ * @file polysync_socket.h
+ * @brief Replay stand-in of the PolySync socket API.
+ *
+ * The nodes send through their own UDP sockets, only the headers they pull in are needed.
+ *
+ */
+#ifndef POLYSYNC_SOCKET_H
+#define POLYSYNC_SOCKET_H
+
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "polysync_core.h"
+
+
+#endif /* POLYSYNC_SOCKET_H */
@@ -0,0 +1,970 @@
+/**
+ * @file psync_replay.c
+ * @brief Replay implementation of the PolySync API subset in ../include.
+ *
+ * A node linked with this file runs without PolySync: psync_node_main_entry
+ * reads recorded frames, calls the node's set_config and on_init, publishes
+ * every frame to the listener the node registered, at the recorded rate or
+ * faster, then calls on_release. The UDP output of the node can be captured
+ * on the loopback and written as text, for regression tests of the whole chain.
+ *
+ * Recordings, one or more files:
+ * \li lidar points, one frame per file: a binary point cloud (dbscan_convert)
+ * or text with "x y [z]" per line.
+ * \li objects, text with "timestamp id x y z size_x size_y size_z vx vy vz classification"
+ * per line, consecutive lines of the same timestamp (microseconds) are one frame.
+ * A line "timestamp can id byte..." in hex, e.g. "1500000000000000 can 303 f4 01",
+ * is a frame of its own published as a "ps_can_frame_msg" when the node listens to it.
+ *
+ */
+
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "polysync_core.h"
+#include "polysync_message.h"
+#include "polysync_node.h"
+#include "polysync_node_template.h"
+
+// recordings and output
+#include "dbscan_cloud.h"
+#include "ps_wire.h"
+
+
+
+
+// *****************************************************
+// static global types/macros
+// *****************************************************
+
+/**
+ * @brief Message types known to the replay.
+ *
+ */
+#define REPLAY_LIDAR_POINTS (1)
+#define REPLAY_OBJECTS (2)
+#define REPLAY_CAN_FRAME (3)
+#define REPLAY_TYPES (4)
+
+
+/**
+ * @brief Bytes of a CAN frame.
+ *
+ */
+#define REPLAY_CAN_BYTES (8)
+
+
+/**
+ * @brief Time between the frames of recordings without timestamps, in microseconds.
+ *
+ */
+#define REPLAY_PERIOD_US (100000)
+
+
+/**
+ * @brief Loopback port the output of the nodes is captured on, UDP_PORT of the nodes.
+ *
+ */
+#define REPLAY_OUTPUT_PORT (9966)
+
+
+/**
+ * @brief Time to wait for the output of a frame with -s, in milliseconds.
+ *
+ */
+#define REPLAY_SYNC_TIMEOUT_MS (1000)
+
+
+/**
+ * @brief One recorded CAN frame.
+ *
+ */
+typedef struct replay_can
+{
+    unsigned long id;
+    unsigned long length;
+    unsigned char data[REPLAY_CAN_BYTES];
+} replay_can;
+
+
+/**
+ * @brief One recorded frame of @type, its points, objects or CAN frame from @offset in the recording.
+ *
+ */
+typedef struct replay_frame
+{
+    ps_msg_type type;
+    ps_timestamp timestamp;
+    unsigned long offset;
+    unsigned long length;
+} replay_frame;
+
+
+/**
+ * @brief All the frames of the recorded files, loaded before the replay starts.
+ *
+ */
+typedef struct replay_recording
+{
+    replay_frame *frame;
+    unsigned long frames;
+    unsigned long frame_capacity;
+    ps_lidar_point *point;
+    unsigned long points;
+    unsigned long point_capacity;
+    ps_object *object;
+    unsigned long objects;
+    unsigned long object_capacity;
+    replay_can *can;
+    unsigned long cans;
+    unsigned long can_capacity;
+} replay_recording;
+
+
+/**
+ * @brief Command line of the replay.
+ *
+ */
+typedef struct replay_options
+{
+    double rate;
+    ps_timestamp period_us;
+    unsigned long loops;
+    const char *output;
+    int sync;
+    int port;
+    int restamp;
+    int ok;
+} replay_options;
+
+
+/**
+ * @brief Captured output of the node.
+ *
+ */
+typedef struct replay_capture
+{
+    int fd;
+    FILE *file;
+    unsigned long datagrams;
+    unsigned long frames;
+    unsigned long invalid;
+} replay_capture;
+
+
+/**
+ * @brief The node being replayed, @type is the kind of its recordings, points or objects.
+ *
+ */
+struct ps_node
+{
+    ps_msg_type type;
+    ps_message_handler handler[REPLAY_TYPES];
+    void *handler_data[REPLAY_TYPES];
+    int fatal;
+    int dtc;
+};
+
+
+/**
+ * @brief Names of the message types, indexed by type.
+ *
+ */
+static const char * const MSG_TYPE_NAME[] = { "", "ps_lidar_points_msg", "ps_objects_msg", "ps_can_frame_msg" };
+
+
+/**
+ * @brief Names of the log levels.
+ *
+ */
+static const char * const LOG_LEVEL_NAME[] = { "ERROR", "WARN", "INFO", "DEBUG" };
+
+
+static struct ps_node replay_node;
+
+
+
+
+// *****************************************************
+// static definitions
+// *****************************************************
+
+//
+static ps_timestamp monotonic_us( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    return (ps_timestamp) now.tv_sec * 1000000ULL + (ps_timestamp) now.tv_nsec / 1000ULL;
+}
+
+
+// grow @buffer of @capacity elements of @size bytes to hold @count, NULL if it can not
+static void *grow( void *buffer, unsigned long *capacity, unsigned long count, size_t size )
+{
+    void *grown = NULL;
+    unsigned long next = *capacity > 0 ? *capacity : 64;
+
+    if( count <= *capacity )
+    {
+        return buffer;
+    }
+
+    while( next < count )
+    {
+        next *= 2;
+    }
+
+    if( (grown = realloc( buffer, next * size )) == NULL )
+    {
+        return NULL;
+    }
+
+    *capacity = next;
+
+    return grown;
+}
+
+
+// start a frame of @type at the end of the recording
+static replay_frame *add_frame( replay_recording *recording, ps_msg_type type, ps_timestamp timestamp, unsigned long offset )
+{
+    replay_frame *frame = NULL;
+
+    if( (recording->frame = grow( recording->frame, &recording->frame_capacity, recording->frames + 1, sizeof(*frame) )) == NULL )
+    {
+        return NULL;
+    }
+
+    frame = &recording->frame[recording->frames++];
+    frame->type = type;
+    frame->timestamp = timestamp;
+    frame->offset = offset;
+    frame->length = 0;
+
+    return frame;
+}
+
+
+// append the lidar points of @path as one frame
+static int load_points( replay_recording *recording, const char *path, const replay_options *options )
+{
+    PointCloud cloud;
+    FILE *file = NULL;
+    replay_frame *frame = NULL;
+    char line[256];
+    float value[3];
+    unsigned long i = 0;
+    int columns = 0;
+
+    frame = add_frame( recording, REPLAY_LIDAR_POINTS, (ps_timestamp) recording->frames * options->period_us, recording->points );
+    if( frame == NULL )
+    {
+        return -1;
+    }
+
+    // a binary point cloud is used in place
+    if( openCloud( &cloud, path ) == 0 )
+    {
+        if( (recording->point = grow( recording->point, &recording->point_capacity,
+                recording->points + cloud.header->count, sizeof(ps_lidar_point) )) == NULL )
+        {
+            closeCloud( &cloud );
+            return -1;
+        }
+
+        if( cloud.header->timestamp != 0 )
+        {
+            frame->timestamp = (ps_timestamp) cloud.header->timestamp;
+        }
+
+        for( i = 0; i < cloud.header->count; i++ )
+        {
+            ps_lidar_point * const point = &recording->point[recording->points++];
+
+            memset( point, 0, sizeof(*point) );
+            point->position[0] = cloud.xyz[i * cloud.header->dim];
+            point->position[1] = cloud.xyz[i * cloud.header->dim + 1];
+            point->position[2] = cloud.header->dim == 3 ? cloud.xyz[i * cloud.header->dim + 2] : 0.0f;
+        }
+
+        frame->length = cloud.header->count;
+        closeCloud( &cloud );
+
+        return 0;
+    }
+
+    // text, "x y [z]" per line
+    if( (file = fopen( path, "r" )) == NULL )
+    {
+        fprintf( stderr, "failed to open %s\n", path );
+        return -1;
+    }
+
+    while( fgets( line, sizeof(line), file ) != NULL )
+    {
+        columns = sscanf( line, "%f %f %f", &value[0], &value[1], &value[2] );
+        if( columns < 2 )
+        {
+            continue;
+        }
+
+        if( (recording->point = grow( recording->point, &recording->point_capacity,
+                recording->points + 1, sizeof(ps_lidar_point) )) == NULL )
+        {
+            fclose( file );
+            return -1;
+        }
+
+        memset( &recording->point[recording->points], 0, sizeof(ps_lidar_point) );
+        recording->point[recording->points].position[0] = value[0];
+        recording->point[recording->points].position[1] = value[1];
+        recording->point[recording->points].position[2] = columns == 3 ? value[2] : 0.0f;
+        recording->points++;
+        frame->length++;
+    }
+
+    fclose( file );
+
+    return 0;
+}
+
+
+// append the CAN frame of @line, "id byte..." in hex, as a frame of its own
+static int load_can( replay_recording *recording, ps_timestamp timestamp, const char *line )
+{
+    replay_can can;
+    replay_frame *frame = NULL;
+    unsigned int byte = 0;
+    int used = 0;
+
+    memset( &can, 0, sizeof(can) );
+
+    if( sscanf( line, "%lx%n", &can.id, &used ) != 1 )
+    {
+        return -1;
+    }
+
+    for( line += used; can.length < REPLAY_CAN_BYTES && sscanf( line, "%x%n", &byte, &used ) == 1; line += used )
+    {
+        can.data[can.length++] = (unsigned char) byte;
+    }
+
+    if( (frame = add_frame( recording, REPLAY_CAN_FRAME, timestamp, recording->cans )) == NULL )
+    {
+        return -1;
+    }
+
+    if( (recording->can = grow( recording->can, &recording->can_capacity,
+            recording->cans + 1, sizeof(can) )) == NULL )
+    {
+        return -1;
+    }
+
+    recording->can[recording->cans++] = can;
+    frame->length = 1;
+
+    return 0;
+}
+
+
+// append the objects of @path, one frame per timestamp, and its CAN frames
+static int load_objects( replay_recording *recording, const char *path )
+{
+    FILE *file = NULL;
+    replay_frame *frame = NULL;
+    char line[512];
+    unsigned long long timestamp = 0;
+    unsigned long long id = 0;
+    unsigned int classification = 0;
+    int used = 0;
+    ps_object object;
+
+    if( (file = fopen( path, "r" )) == NULL )
+    {
+        fprintf( stderr, "failed to open %s\n", path );
+        return -1;
+    }
+
+    while( fgets( line, sizeof(line), file ) != NULL )
+    {
+        memset( &object, 0, sizeof(object) );
+        used = 0;
+
+        if( line[0] != '#' && sscanf( line, "%llu can %n", &timestamp, &used ) == 1 && used > 0 )
+        {
+            if( load_can( recording, (ps_timestamp) timestamp, line + used ) != 0 )
+            {
+                fclose( file );
+                return -1;
+            }
+
+            // the objects after it are a new frame
+            frame = NULL;
+            continue;
+        }
+
+        if( line[0] == '#' || sscanf( line, "%llu %llu %lf %lf %lf %lf %lf %lf %lf %lf %lf %u",
+                &timestamp, &id,
+                &object.position[0], &object.position[1], &object.position[2],
+                &object.size[0], &object.size[1], &object.size[2],
+                &object.velocity[0], &object.velocity[1], &object.velocity[2],
+                &classification ) != 12 )
+        {
+            continue;
+        }
+
+        object.id = (ps_identifier) id;
+        object.classification = (unsigned char) classification;
+
+        if( frame == NULL || frame->timestamp != (ps_timestamp) timestamp )
+        {
+            if( (frame = add_frame( recording, REPLAY_OBJECTS, (ps_timestamp) timestamp, recording->objects )) == NULL )
+            {
+                fclose( file );
+                return -1;
+            }
+        }
+
+        if( (recording->object = grow( recording->object, &recording->object_capacity,
+                recording->objects + 1, sizeof(object) )) == NULL )
+        {
+            fclose( file );
+            return -1;
+        }
+
+        recording->object[recording->objects++] = object;
+        frame->length++;
+    }
+
+    fclose( file );
+
+    return 0;
+}
+
+
+//
+static void release_recording( replay_recording *recording )
+{
+    free( recording->frame );
+    free( recording->point );
+    free( recording->object );
+    free( recording->can );
+    memset( recording, 0, sizeof(*recording) );
+}
+
+
+// listen on the loopback for the output of the node, -1 if the port is taken
+static int open_capture( replay_capture *capture, const replay_options *options )
+{
+    struct sockaddr_in address;
+    int size = 1 << 22;
+
+    memset( capture, 0, sizeof(*capture) );
+    capture->fd = -1;
+
+    memset( &address, 0, sizeof(address) );
+    address.sin_family = AF_INET;
+    address.sin_port = htons( (unsigned short) options->port );
+    address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+    if( (capture->fd = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP )) < 0 )
+    {
+        return -1;
+    }
+
+    (void) setsockopt( capture->fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size) );
+
+    if( bind( capture->fd, (struct sockaddr*) &address, sizeof(address) ) != 0 )
+    {
+        close( capture->fd );
+        capture->fd = -1;
+        return -1;
+    }
+
+    if( options->output != NULL && (capture->file = fopen( options->output, "w" )) == NULL )
+    {
+        fprintf( stderr, "failed to open %s\n", options->output );
+        close( capture->fd );
+        capture->fd = -1;
+        return -1;
+    }
+
+    return 0;
+}
+
+
+// write one datagram of output, a line per frame and a line per record
+static void write_capture( replay_capture *capture, const unsigned char *datagram, size_t size )
+{
+    WireHeader header;
+    WireRecord record;
+    unsigned int i = 0;
+
+    capture->datagrams++;
+
+    if( decodeWireHeader( &header, datagram, size ) != 0 )
+    {
+        capture->invalid++;
+        return;
+    }
+
+    if( header.fragment + 1 == header.fragments )
+    {
+        capture->frames++;
+    }
+
+    if( capture->file == NULL )
+    {
+        return;
+    }
+
+    if( header.fragment == 0 )
+    {
+        fprintf( capture->file, "frame %u %llu kind %u records %u\n",
+                header.sequence, (unsigned long long) header.timestamp, header.kind, header.total );
+    }
+
+    for( i = 0; i < header.records; i++ )
+    {
+        decodeWireRecord( &record, datagram + WIRE_HEADER_SIZE + i * header.recordSize );
+
+        fprintf( capture->file, "  %llu %u %u %.3f %.3f %.3f %.3f %.3f %.3f %.3f %.3f %.3f %.3f %.3f %.3f\n",
+                (unsigned long long) record.id, record.points, record.classification,
+                record.centroid[0], record.centroid[1], record.centroid[2],
+                record.min[0], record.min[1], record.min[2],
+                record.max[0], record.max[1], record.max[2],
+                record.velocity[0], record.velocity[1], record.velocity[2] );
+    }
+}
+
+
+// read the output waiting, or until @frames frames are complete if @timeout_ms is not zero
+static void drain_capture( replay_capture *capture, unsigned long frames, int timeout_ms )
+{
+    unsigned char datagram[WIRE_DATAGRAM_SIZE];
+    struct pollfd waiting;
+    ssize_t size = 0;
+
+    if( capture->fd < 0 )
+    {
+        return;
+    }
+
+    waiting.fd = capture->fd;
+    waiting.events = POLLIN;
+
+    for( ; ; )
+    {
+        size = recv( capture->fd, datagram, sizeof(datagram), MSG_DONTWAIT );
+        if( size >= 0 )
+        {
+            write_capture( capture, datagram, (size_t) size );
+            continue;
+        }
+
+        if( timeout_ms == 0 || capture->frames >= frames || poll( &waiting, 1, timeout_ms ) <= 0 )
+        {
+            return;
+        }
+    }
+}
+
+
+//
+static void close_capture( replay_capture *capture )
+{
+    if( capture->fd >= 0 )
+    {
+        close( capture->fd );
+    }
+
+    if( capture->file != NULL )
+    {
+        fclose( capture->file );
+    }
+
+    capture->fd = -1;
+    capture->file = NULL;
+}
+
+
+// publish frame @index of the recording to the listener of its type, if the node has one
+static void publish( const replay_recording *recording, unsigned long index, unsigned long sequence, int restamp )
+{
+    const replay_frame * const frame = &recording->frame[index];
+    ps_lidar_points_msg points_msg;
+    ps_objects_msg objects_msg;
+    ps_can_frame_msg can_msg;
+    ps_timestamp timestamp = frame->timestamp;
+
+    if( replay_node.handler[frame->type] == NULL )
+    {
+        return;
+    }
+
+    // stamped now, as the sensor would, for the latency from the sensor timestamp
+    if( restamp )
+    {
+        (void) psync_get_timestamp( &timestamp );
+    }
+
+    if( frame->type == REPLAY_LIDAR_POINTS )
+    {
+        memset( &points_msg, 0, sizeof(points_msg) );
+        points_msg.header.type = frame->type;
+        points_msg.header.timestamp = timestamp;
+        points_msg.header.src_guid = (ps_guid) sequence;
+        points_msg.start_timestamp = timestamp;
+        points_msg.end_timestamp = timestamp;
+        points_msg.points._maximum = frame->length;
+        points_msg.points._length = frame->length;
+        points_msg.points._buffer = &recording->point[frame->offset];
+
+        replay_node.handler[frame->type]( frame->type, (ps_msg_ref) &points_msg, replay_node.handler_data[frame->type] );
+    }
+    else if( frame->type == REPLAY_OBJECTS )
+    {
+        memset( &objects_msg, 0, sizeof(objects_msg) );
+        objects_msg.header.type = frame->type;
+        objects_msg.header.timestamp = timestamp;
+        objects_msg.header.src_guid = (ps_guid) sequence;
+        objects_msg.objects._maximum = frame->length;
+        objects_msg.objects._length = frame->length;
+        objects_msg.objects._buffer = &recording->object[frame->offset];
+
+        replay_node.handler[frame->type]( frame->type, (ps_msg_ref) &objects_msg, replay_node.handler_data[frame->type] );
+    }
+    else
+    {
+        memset( &can_msg, 0, sizeof(can_msg) );
+        can_msg.header.type = frame->type;
+        can_msg.header.timestamp = timestamp;
+        can_msg.header.src_guid = (ps_guid) sequence;
+        can_msg.id = recording->can[frame->offset].id;
+        can_msg.data_buffer._maximum = REPLAY_CAN_BYTES;
+        can_msg.data_buffer._length = recording->can[frame->offset].length;
+        can_msg.data_buffer._buffer = (unsigned char*) recording->can[frame->offset].data;
+
+        replay_node.handler[frame->type]( frame->type, (ps_msg_ref) &can_msg, replay_node.handler_data[frame->type] );
+    }
+}
+
+
+//
+static void usage( const char *name )
+{
+    printf( "usage: %s [-r rate] [-p period_ms] [-l loops] [-o output] [-s] [-t] [-k] [-u port] file...\n", name );
+    printf( "  -r  times the recorded rate, 0 for as fast as possible, default 1\n" );
+    printf( "  -p  time between frames without a timestamp, default %d ms\n", REPLAY_PERIOD_US / 1000 );
+    printf( "  -l  times the recording is replayed, default 1\n" );
+    printf( "  -o  write the captured UDP output of the node as text\n" );
+    printf( "  -s  wait for the output of each frame before the next one\n" );
+    printf( "  -t  stamp the messages with the time they are published instead of the recorded time\n" );
+    printf( "  -k  call on_ok after each frame, as the node template does between messages\n" );
+    printf( "  -u  loopback port the output is captured on, default %d\n", REPLAY_OUTPUT_PORT );
+}
+
+
+
+
+// *****************************************************
+// public definitions
+// *****************************************************
+
+//
+void psync_log_message( const ps_log_level_kind level, const char * format, ... )
+{
+    va_list args;
+
+    va_start( args, format );
+    fprintf( stderr, "%s: ", LOG_LEVEL_NAME[level <= LOG_LEVEL_DEBUG ? level : LOG_LEVEL_DEBUG] );
+    vfprintf( stderr, format, args );
+    fprintf( stderr, "\n" );
+    va_end( args );
+}
+
+
+//
+int psync_get_timestamp( ps_timestamp * const timestamp )
+{
+    struct timespec now;
+
+    if( timestamp == NULL )
+    {
+        return DTC_USAGE;
+    }
+
+    clock_gettime( CLOCK_REALTIME, &now );
+    *timestamp = (ps_timestamp) now.tv_sec * 1000000ULL + (ps_timestamp) now.tv_nsec / 1000ULL;
+
+    return DTC_NONE;
+}
+
+
+//
+int psync_sleep_micro( const ps_timestamp interval )
+{
+    struct timespec wait;
+
+    wait.tv_sec = (time_t) (interval / 1000000ULL);
+    wait.tv_nsec = (long) (interval % 1000000ULL) * 1000L;
+
+    while( nanosleep( &wait, &wait ) != 0 && errno == EINTR )
+    {
+        // interrupted by a signal
+    }
+
+    return DTC_NONE;
+}
+
+
+//
+int psync_message_get_type_by_name(
+        ps_node_ref const node_ref,
+        const char * const name,
+        ps_msg_type * const type )
+{
+    ps_msg_type index = 0;
+
+    if( name == NULL || type == NULL )
+    {
+        return DTC_USAGE;
+    }
+
+    for( index = REPLAY_LIDAR_POINTS; index < REPLAY_TYPES; index++ )
+    {
+        if( strcmp( name, MSG_TYPE_NAME[index] ) == 0 )
+        {
+            *type = index;
+            return DTC_NONE;
+        }
+    }
+
+    return DTC_UNAVAILABLE;
+}
+
+
+//
+int psync_message_register_listener(
+        ps_node_ref const node_ref,
+        const ps_msg_type type,
+        ps_message_handler handler,
+        void * const user_data )
+{
+    if( node_ref == NULL || handler == NULL || type < REPLAY_LIDAR_POINTS || type >= REPLAY_TYPES )
+    {
+        return DTC_USAGE;
+    }
+
+    // the recordings are read as the points or the objects the node listens to
+    if( type != REPLAY_CAN_FRAME )
+    {
+        node_ref->type = type;
+    }
+
+    node_ref->handler[type] = handler;
+    node_ref->handler_data[type] = user_data;
+
+    return DTC_NONE;
+}
+
+
+//
+int psync_node_activate_fault(
+        ps_node_ref const node_ref,
+        const int dtc,
+        const int state )
+{
+    if( node_ref == NULL )
+    {
+        return DTC_USAGE;
+    }
+
+    node_ref->dtc = dtc;
+    if( state == NODE_STATE_FATAL )
+    {
+        node_ref->fatal = 1;
+    }
+
+    return DTC_NONE;
+}
+
+
+//
+int psync_node_main_entry(
+        const ps_node_callbacks * const callbacks,
+        int argc,
+        char **argv )
+{
+    // local vars
+    int ret = DTC_NONE;
+    int option = 0;
+    ps_diagnostic_state state = NODE_STATE_OK;
+    ps_node_configuration_data config;
+    replay_options options;
+    replay_recording recording;
+    replay_capture capture;
+    ps_timestamp start = 0;
+    ps_timestamp schedule = 0;
+    ps_timestamp elapsed = 0;
+    ps_timestamp span = 0;
+    ps_timestamp recorded = 0;
+    ps_timestamp last = 0;
+    unsigned long loop = 0;
+    unsigned long index = 0;
+    unsigned long published = 0;
+
+
+    memset( &replay_node, 0, sizeof(replay_node) );
+    memset( &config, 0, sizeof(config) );
+    memset( &recording, 0, sizeof(recording) );
+
+    options.rate = 1.0;
+    options.period_us = REPLAY_PERIOD_US;
+    options.loops = 1;
+    options.output = NULL;
+    options.sync = 0;
+    options.port = REPLAY_OUTPUT_PORT;
+    options.restamp = 0;
+    options.ok = 0;
+
+    while( (option = getopt( argc, argv, "r:p:l:o:stku:h" )) != -1 )
+    {
+        switch( option )
+        {
+            case 'r': options.rate = atof( optarg ); break;
+            case 'p': options.period_us = (ps_timestamp) (atof( optarg ) * 1000.0); break;
+            case 'l': options.loops = strtoul( optarg, NULL, 10 ); break;
+            case 'o': options.output = optarg; break;
+            case 's': options.sync = 1; break;
+            case 't': options.restamp = 1; break;
+            case 'k': options.ok = 1; break;
+            case 'u': options.port = atoi( optarg ); break;
+            default: usage( argv[0] ); return 1;
+        }
+    }
+
+    if( optind >= argc || options.rate < 0.0 )
+    {
+        usage( argv[0] );
+        return 1;
+    }
+
+    // the node registers its listener in on_init
+    if( callbacks->set_config != NULL && (ret = callbacks->set_config( &config )) != DTC_NONE )
+    {
+        fprintf( stderr, "set_config returned DTC %d\n", ret );
+        return 1;
+    }
+
+    if( open_capture( &capture, &options ) != 0 )
+    {
+        fprintf( stderr, "port %d is taken, the output is not captured\n", options.port );
+    }
+
+    callbacks->on_init( &replay_node, &state, config.user_data );
+
+    if( replay_node.fatal || replay_node.handler[replay_node.type] == NULL )
+    {
+        fprintf( stderr, "on_init failed, DTC %d\n", replay_node.dtc );
+        ret = 1;
+    }
+
+    // load everything before the clock starts
+    for( index = (unsigned long) optind; ret == DTC_NONE && index < (unsigned long) argc; index++ )
+    {
+        if( replay_node.type == REPLAY_LIDAR_POINTS ? load_points( &recording, argv[index], &options ) != 0
+                : load_objects( &recording, argv[index] ) != 0 )
+        {
+            fprintf( stderr, "failed to load %s\n", argv[index] );
+            ret = 1;
+        }
+    }
+
+    if( ret == DTC_NONE && recording.frames > 0 )
+    {
+        span = recording.frame[recording.frames - 1].timestamp - recording.frame[0].timestamp + options.period_us;
+    }
+
+    start = monotonic_us();
+
+    for( loop = 0; ret == DTC_NONE && loop < options.loops && !replay_node.fatal; loop++ )
+    {
+        for( index = 0; index < recording.frames && !replay_node.fatal; index++ )
+        {
+            // keep the recorded time between frames, divided by the rate
+            recorded = loop * span + recording.frame[index].timestamp - recording.frame[0].timestamp;
+            if( options.rate > 0.0 )
+            {
+                schedule = start + (ps_timestamp) ( (double) recorded / options.rate );
+                if( schedule > monotonic_us() )
+                {
+                    (void) psync_sleep_micro( schedule - monotonic_us() );
+                }
+            }
+
+            // the CAN frames are input of the node, there is no output to wait for
+            if( recording.frame[index].type == REPLAY_CAN_FRAME )
+            {
+                publish( &recording, index, published, options.restamp );
+                continue;
+            }
+
+            publish( &recording, index, published, options.restamp );
+            published++;
+
+            if( options.ok && callbacks->on_ok != NULL )
+            {
+                callbacks->on_ok( &replay_node, &state, config.user_data );
+            }
+
+            last = monotonic_us() - start;
+
+            drain_capture( &capture, published, options.sync ? REPLAY_SYNC_TIMEOUT_MS : 0 );
+        }
+    }
+
+    if( replay_node.fatal && callbacks->on_fatal != NULL )
+    {
+        callbacks->on_fatal( &replay_node, &state, config.user_data );
+    }
+
+    // the frames still queued in the node are sent before on_release returns
+    callbacks->on_release( &replay_node, &state, config.user_data );
+    elapsed = monotonic_us() - start;
+
+    drain_capture( &capture, published, 100 );
+
+    printf( "replayed %lu frames in %.1f ms, %.1f frames/s", published, (double) elapsed / 1000.0,
+            elapsed > 0 ? (double) published * 1e6 / (double) elapsed : 0.0 );
+    if( recorded > 0 && last > 0 )
+    {
+        printf( ", %.1fx real time", (double) recorded / (double) last );
+    }
+    printf( "\n" );
+
+    if( capture.fd >= 0 )
+    {
+        printf( "captured %lu frames of output in %lu datagrams, %lu invalid\n",
+                capture.frames, capture.datagrams, capture.invalid );
+    }
+
+    close_capture( &capture );
+    release_recording( &recording );
+
+    return ret != DTC_NONE || replay_node.fatal;
+}
@@ -1,57 +1,110 @@
 #include"ps_func.h"
 
-void ps_printf( const ps_msg_ref const message )
+// log the objects of @message, one record per object, when PS_LOG asks for debug:objects
+void ps_printf( Logger *logger, const ps_msg_ref const message )
 {
 	// cast to message
     const ps_objects_msg * const objects_msg = (ps_objects_msg*) message;
-
-    // print details
-    printf( "received objects message from node 0x%016llX\n", (ps_ull) objects_msg->header.src_guid );
-    printf( "received timestamp 0x%016llX\n", (ps_ull) objects_msg->header.timestamp);
-	
-    unsigned long objects_index = 0;
     const ps_object *_buffer = objects_msg->objects._buffer;
-    
+    unsigned long objects_index = 0;
+
+	// nothing to copy when objects are not logged
+	if( !loggerEnabled( logger, LOGGER_DEBUG, LOGGER_OBJECTS ) )
+	{
+		return;
+	}
+
+	LOG_AT( logger, LOGGER_DEBUG, LOGGER_OBJECTS, "objects message from node 0x%016llX, timestamp 0x%016llX, %lu objects",
+			(ps_ull) objects_msg->header.src_guid,
+			(ps_ull) objects_msg->header.timestamp,
+			(unsigned long) objects_msg->objects._length );
+
     while( objects_index < objects_msg->objects._length )
     {
+		const ps_object * const object = &_buffer[objects_index];
+		const unsigned long classification = (unsigned long) object->classification;
+
+		LOG_AT( logger, LOGGER_DEBUG, LOGGER_OBJECTS,
+				"id 0x%016llX position %f %f %f size %f %f %f velocity %f %f %f course %f class %s quality %llu",
+				(ps_ull) object->id,
+				(double) object->position[0], (double) object->position[1], (double) object->position[2],
+				(double) object->size[0], (double) object->size[1], (double) object->size[2],
+				(double) object->velocity[0], (double) object->velocity[1], (double) object->velocity[2],
+				(double) object->course_angle,
+				classification < sizeof(CLASIFICATION) / sizeof(CLASIFICATION[0]) ? CLASIFICATION[classification] : "unknown",
+				(ps_ull) object->classification_quality );
 
-        printf( "-------------------Publishers objects--------------------\n");
-        printf( "Id = 0x%016llX\n", (ps_ull) _buffer[objects_index].id);
-		printf( "Position:\nx = %016lf\ny = %016lf\nz = %016lf\n",
-                (double) _buffer[objects_index].position[0],
-				(double) _buffer[objects_index].position[1],
-				(double) _buffer[objects_index].position[2]);
-				
-		printf( "Size:\nx = %016lf\ny = %016lf\nz = %016lf\n",
-                (double) _buffer[objects_index].size[0],
-				(double) _buffer[objects_index].size[1],
-				(double) _buffer[objects_index].size[2]);
-		
-		printf( "Velocity:\nx = %016lf\ny = %016lf\nz = %016lf\n",
-                (double) _buffer[objects_index].velocity[0],
-				(double) _buffer[objects_index].velocity[1],
-				(double) _buffer[objects_index].velocity[2]);
-		
-		printf( "Course_angle = %016ld\n", (ps_ull) _buffer[objects_index].course_angle);
-		
-		printf( "Classification = %s\n", CLASIFICATION[(int) _buffer[objects_index].classification]);
-		
-		printf( "Classification quality = %ld\n", (ps_ull) _buffer[objects_index].classification_quality);
-		
         objects_index++;
-        
     }
-
-    printf( "\n\n" );
 }
 
 // judge whether the objects is in front
 int is_object_front( double y)
 {
-	if(abs(y) < CAR_WIDTH / 2)
+	if(fabs(y) < CAR_WIDTH / 2)
 		return 1;
 	else
 		return 0;
 }
 
+// one log line per stage of @recorder, p50/p99/max so far
+void ps_latency_log(const LatencyRecorder *recorder)
+{
+	char text[160];
+	int stage = 0;
+
+	for( stage = 0; stage < recorder->stages; stage++ )
+	{
+		(void) formatLatency( text, sizeof(text), &recorder->stage[stage] );
+
+		psync_log_message(
+				LOG_LEVEL_INFO,
+				"%s : (%u) -- %s latency %s",
+				__FILE__,
+				__LINE__,
+				recorder->name,
+				text );
+	}
+}
+
+// apply the objects of @message to @table, the objects it does not carry are forgotten
+void ps_track_objects( ObjectTable *table, const ps_msg_ref const message )
+{
+	const ps_objects_msg * const objects_msg = (ps_objects_msg*) message;
+	const ps_object *_buffer = objects_msg->objects._buffer;
+	unsigned long objects_index = 0;
+
+	beginObjectFrame( table );
+
+	for( objects_index = 0; objects_index < objects_msg->objects._length; objects_index++ )
+	{
+		(void) updateObject(
+				table,
+				(uint64_t) _buffer[objects_index].id,
+				_buffer[objects_index].position,
+				_buffer[objects_index].size,
+				_buffer[objects_index].velocity );
+	}
 
+	endObjectFrame( table );
+}
+
+// copy the objects of @message for the control thread, those beyond TRACK_OBJECTS are left out
+// and the message is counted in the truncated of the jitter report
+void ps_post_objects( RtMailbox *mailbox, const ps_msg_ref const message )
+{
+	const ps_objects_msg * const objects_msg = (ps_objects_msg*) message;
+	ps_objects_slot * const slot = (ps_objects_slot*) rtMailboxBack( mailbox );
+
+	slot->msg = *objects_msg;
+	slot->msg.objects._maximum = TRACK_OBJECTS;
+	slot->msg.objects._length = fillRtMailbox(
+			mailbox,
+			offsetof( ps_objects_slot, object ),
+			objects_msg->objects._buffer,
+			objects_msg->objects._length,
+			sizeof(ps_object) );
+	slot->msg.objects._buffer = slot->object;
+
+	postRtMailbox( mailbox );
+}
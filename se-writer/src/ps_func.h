@@ -6,6 +6,10 @@
 #include <stdlib.h>
 #include <signal.h>
 #include <unistd.h>
+#include <math.h>
+#include <string.h>
+#include <errno.h>
+#include <stddef.h>
 
 // API headers
 #include "polysync_core.h"
@@ -15,6 +19,18 @@
 #include "polysync_serial.h"
 #include "polysync_node_template.h"
 
+// stage timings, compiled out without PS_LATENCY
+#include "ps_latency.h"
+
+// asynchronous log, nothing is formatted nor written in the callbacks
+#include "ps_log.h"
+
+// objects kept across messages, the closest in the path is read without a scan
+#include "ps_track.h"
+
+// real-time mode of the serial output, PS_RT
+#include "ps_rt.h"
+
 
 
 
@@ -29,9 +45,22 @@
 #define SERIAL_DEVICE_DATARATE DATARATE_19200
 static const char SERIAL_PORT[] = "/dev/ttyS0";
 
+// period of the control thread in the real-time mode, a message waits at most this long
+#define CONTROL_PERIOD_NS (10000000ULL)
+
+// last objects message, copied for the control thread of the real-time mode
+typedef struct ps_objects_slot
+{
+    ps_objects_msg msg;
+    ps_object object[TRACK_OBJECTS];
+} ps_objects_slot;
+
 static const char NODE_NAME[] = "polysync-serial-writer-c";
 static const char OBJECTS_MSG_NAME[] = "ps_objects_msg";
 
+// log of the node, PS_LOG=debug:serial for every write, debug:objects for every object
+static const char LOG_FILE[] = "polysync-serial-writer-c.log";
+
 static float CAR_WIDTH = 2.0;
 static float DISTANCE_INIT = 300.0;
 typedef unsigned long long ps_ull;
@@ -57,8 +86,11 @@ static const char CLASIFICATION[12][30] = {
 // *****************************************************
 // user-definition function declarations
 // *****************************************************
-void ps_printf( const ps_msg_ref const message );
+void ps_printf( Logger *logger, const ps_msg_ref const message );
 int  ps_serial_send(void * const user_data, char *buf);
+void ps_latency_log(const LatencyRecorder *recorder);
+void ps_track_objects( ObjectTable *table, const ps_msg_ref const message );
+void ps_post_objects( RtMailbox *mailbox, const ps_msg_ref const message );
 
 
 #endif
@@ -2,7 +2,36 @@
 
 ps_serial_device *my_serial_device = NULL;
 
-#define PS_DEBUG
+// log of the objects and of the serial writes, written by a background thread
+static Logger my_logger;
+
+// objects of the last messages by id, with the closest one in the path of the car
+static ObjectTable my_objects;
+
+// stages timed by the listener, the last one from the timestamp of the objects to the serial write
+enum
+{
+	SERIAL_RECEIVE,
+	SERIAL_SELECT,
+	SERIAL_PRINT,
+	SERIAL_WRITE,
+	SERIAL_END_TO_END,
+	SERIAL_STAGES
+};
+
+static const char * const SERIAL_STAGE_NAME[] = { "receive", "select", "print", "write", "end-to-end" };
+
+// latency histograms, only written by the listener
+static LatencyRecorder serial_latency;
+
+// real-time mode, PS_RT: the serial writes run on their own period, the listener hands them the last message
+static RtConfig my_rt;
+static RtPeriod my_period;
+static RtMailbox my_mailbox;
+
+// latency histograms of the control thread, only written by it
+static LatencyRecorder control_latency;
+
 #define PS_SERIAL_SEND
 // *****************************************************
 // static declarations
@@ -50,98 +79,120 @@ static void on_ok(
 // static definitions
 // *****************************************************
 
+// write the distance of the closest object in the path of @message to the serial device, timed in @recorder
+// on the listener, or on the control thread in the real-time mode
+static void ps_serial_control(
+        const ps_msg_ref const message,
+        LatencyRecorder * const recorder )
+{
+    LATENCY_CLOCK( clock );
+
+    LATENCY_START( clock );
+
+	unsigned char buffer[6];
+	const ps_objects_msg * const objects_msg = (ps_objects_msg*) message;
+	const TrackedObject *closest = NULL;
+	float distance_min = DISTANCE_INIT;
+
+	// every object updates its own entry, the closest in the path follows
+	ps_track_objects( &my_objects, message );
+	closest = closestObject( &my_objects );
+	if( closest != NULL && closest->gap < distance_min )
+	{
+		distance_min = closest->gap;
+	}
+
+	LATENCY_LAP( recorder, SERIAL_SELECT, clock );
+	/*unsigned char * temp = (unsigned char *) &distance_min;
+	for(int i= 0; i < 4; i++)
+	{
+		buffer[i] = *temp;
+		temp++;
+	}
+	buffer[4] = 255;
+	buffer[5] = '\n';
+	*/
+	distance_min = distance_min * 100;
+	short int x_temp = (short int) distance_min;
+	unsigned char * temp = (unsigned char *) &x_temp;
+	buffer[0] = 255;
+	buffer[1] = temp[0];
+	buffer[2] = temp[1];
+
+	unsigned long buffer_size = 0;
+	unsigned long bytes_written = 0;
+	ps_serial_device *serial_device = NULL;
+	int ret = DTC_NONE;
+
+	// cast
+	serial_device = (ps_serial_device*) my_serial_device;
+
+	// check reference since other routines don't
+	if( serial_device == NULL )
+	{
+		psync_log_message(
+			LOG_LEVEL_ERROR,
+			"%s : (%u) -- invalid serial device",
+			__FILE__,
+			__LINE__ );
+
+		return;
+	}
+
+	// set buffer size
+	buffer_size = 3;
+
+	// only queued, and only when PS_LOG asks for it
+	LOG_AT( &my_logger, LOGGER_DEBUG, LOGGER_SERIAL, "distance %d cm, writing %lu bytes %02x %02x %02x",
+			x_temp, buffer_size, buffer[0], buffer[1], buffer[2] );
+
+	LATENCY_LAP( recorder, SERIAL_PRINT, clock );
+
+	// write data
+	ret = psync_serial_write(
+			serial_device,
+			(unsigned char*) buffer,
+			buffer_size,
+			&bytes_written );
+
+	// activate fatal error and return if failed
+	if( ret != DTC_NONE )
+	{
+		psync_log_message(
+			LOG_LEVEL_ERROR,
+			"%s : (%u) -- psync_serial_write returned DTC %d",
+			__FILE__,
+			__LINE__,
+			ret );
+
+		return;
+	}
+
+	LATENCY_LAP( recorder, SERIAL_WRITE, clock );
+	LATENCY_SENSOR_AGE( recorder, SERIAL_END_TO_END, objects_msg->header.timestamp );
+}
+
+
 static void ps_objects_msg__handler(
         const ps_msg_type msg_type,
         const ps_msg_ref const message,
         void * const user_data )
 {
+    // how old the objects are when they get here
+    LATENCY_SENSOR_AGE( &serial_latency, SERIAL_RECEIVE, ((const ps_objects_msg*) message)->header.timestamp );
   	
 /*---------------------------------- start SERIAL send ------------------------------------------------*/   
     #ifdef PS_SERIAL_SEND
 
-		unsigned char buffer[6];
-		const ps_objects_msg * const objects_msg = (ps_objects_msg*) message;
-    	const ps_object *_buffer = objects_msg->objects._buffer; 
-    	unsigned long objects_index = 0;
-    	float distance_min = DISTANCE_INIT;
-    	double x;
-    	double y;
-    
-    	while(objects_index < objects_msg->objects._length)
-    	{
-    		x = _buffer[objects_index].position[0];
-    		y = _buffer[objects_index].position[1];
-    		if(is_object_front(y) && x < distance_min && x > 0)
-    		{
-    			distance_min = x ;
-    	
-    		}
-    		objects_index++;
-   	 	}
-		/*unsigned char * temp = (unsigned char *) &distance_min;
-		for(int i= 0; i < 4; i++)
+		// in the real-time mode the control thread takes the message at its next period
+		if( my_rt.enabled )
 		{
-			buffer[i] = *temp;
-			temp++;
+			ps_post_objects( &my_mailbox, message );
+		}
+		else
+		{
+			ps_serial_control( message, &serial_latency );
 		}
-		buffer[4] = 255;
-		buffer[5] = '\n';
-		*/
-		distance_min = distance_min * 100;
-		short int x_temp = (short int) distance_min;
-		printf("distance_min = %d\n %f\n",x_temp, distance_min);
-		unsigned char * temp = (unsigned char *) &x_temp;
-		buffer[0] = 255;
-		buffer[1] = temp[0];
-		buffer[2] = temp[1];
-		
-		unsigned long buffer_size = 0;
-		unsigned long bytes_written = 0;
-    	ps_serial_device *serial_device = NULL;
-		int ret = DTC_NONE;
-
-    	// cast
-    	serial_device = (ps_serial_device*) my_serial_device;
-
-    	// check reference since other routines don't
-    	if( serial_device == NULL )
-    	{
-        	psync_log_message(
-                LOG_LEVEL_ERROR,
-                "%s : (%u) -- invalid serial device",
-                __FILE__,
-                __LINE__ );
-
-            return;
-   		}
-
-    	// set buffer size
-    	buffer_size = 3;
-
-    	printf( "writing serial buffer %lu bytes\n", buffer_size );
-		for( int i = 0; i < buffer_size; i++)
-			printf("%x\t",buffer[i]);
-		printf("\n");
-    	// write data
-    	ret = psync_serial_write(
-            	serial_device,
-            	(unsigned char*) buffer,
-            	buffer_size,
-            	&bytes_written );
-
-    	// activate fatal error and return if failed
-    	if( ret != DTC_NONE )
-    	{
-        	psync_log_message(
-                LOG_LEVEL_ERROR,
-                "%s : (%u) -- psync_serial_write returned DTC %d",
-                __FILE__,
-                __LINE__,
-                ret );
-
-            return;
-    	}
-
 
 	#endif //// end if define PS_SERIAL_SEND
 	
@@ -150,13 +201,22 @@ static void ps_objects_msg__handler(
 	
 /*---------------------------------- start print objects information---------------------------------*/
 
-	#ifdef PS_DEBUG
-    	//ps_printf(message);
-    #endif // end if define PS_DEBUG
+	ps_printf(&my_logger, message);
     
 /*---------------------------------- end of print objects information--------------------------------*/    
     
-
+#ifdef PS_LATENCY
+	// periodic report, every LATENCY_REPORT_NS
+	static uint64_t report = 0;
+
+	if( report == 0 )
+		report = latencyNow();
+	if( latencyNow() - report > LATENCY_REPORT_NS )
+	{
+		ps_latency_log( &serial_latency );
+		report = latencyNow();
+	}
+#endif
     
 }
 
@@ -356,6 +416,65 @@ static void on_init(
         return;
     }
     my_serial_device = serial_device;
+
+    // log, PS_LOG sets what is logged
+    if( openLogger( &my_logger, LOG_FILE, LOGGER_RECORDS ) != 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_WARN,
+                "%s : (%u) -- failed to open the log %s, nothing is logged",
+                __FILE__,
+                __LINE__,
+                LOG_FILE );
+    }
+
+    // empty histograms, the clock is calibrated before the first message
+    initialLatencyClock();
+    initialLatency( &serial_latency, "listener", SERIAL_STAGE_NAME, SERIAL_STAGES );
+
+    // objects table, allocated once for TRACK_OBJECTS objects
+    if( initialObjectTable( &my_objects, TRACK_OBJECTS, CAR_WIDTH ) != 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_ERROR,
+                "%s : (%u) -- failed to allocate the objects table",
+                __FILE__,
+                __LINE__ );
+
+        psync_node_activate_fault( node_ref, DTC_MEMERR, NODE_STATE_FATAL );
+        return;
+    }
+
+    // real-time mode, the control thread writes the serial device on a period
+    if( rtConfigFromEnv( &my_rt ) != 0 )
+    {
+        psync_log_message(
+                LOG_LEVEL_WARN,
+                "%s : (%u) -- %s=%s is not cpu[:priority], the real-time mode is off",
+                __FILE__,
+                __LINE__,
+                RT_ENV,
+                getenv( RT_ENV ) );
+    }
+
+    if( my_rt.enabled )
+    {
+        if( initialRtMailbox( &my_mailbox, sizeof(ps_objects_slot) ) != 0 )
+        {
+            psync_log_message(
+                    LOG_LEVEL_ERROR,
+                    "%s : (%u) -- failed to allocate the objects mailbox",
+                    __FILE__,
+                    __LINE__ );
+
+            psync_node_activate_fault( node_ref, DTC_MEMERR, NODE_STATE_FATAL );
+            return;
+        }
+
+        initialRtPeriod( &my_period, "control period", CONTROL_PERIOD_NS );
+        initialLatency( &control_latency, "control", SERIAL_STAGE_NAME, SERIAL_STAGES );
+        logRtLockMemory( &my_logger );
+    }
     
     ps_msg_type msg_type = PSYNC_MSG_TYPE_INVALID;
     // get objects message type identifier
@@ -418,6 +537,11 @@ static void on_release(
     // cast
     serial_device = (ps_serial_device*) user_data;
 
+#ifdef PS_LATENCY
+    // latency of the stages
+    ps_latency_log( &serial_latency );
+#endif
+
     // if valid
     if( serial_device != NULL )
     {
@@ -428,6 +552,24 @@ static void on_release(
         free( serial_device );
         serial_device = NULL;
     }
+
+    // jitter of the control period
+    if( my_rt.enabled )
+    {
+#ifdef PS_LATENCY
+        ps_latency_log( &control_latency );
+#endif
+        ps_latency_log( &my_period.latency );
+        logRtPeriod( &my_logger, &my_period, &my_mailbox );
+        destroyRtMailbox( &my_mailbox );
+    }
+
+    // objects table
+    destroyObjectTable( &my_objects );
+
+    // write what is still queued
+    closeLogger( &my_logger );
+
 	// do nothing, sleep for 10 milliseconds
     (void) psync_sleep_micro( 10000 );
     
@@ -473,9 +615,32 @@ static void on_ok(
         const ps_diagnostic_state * const state,
         void * const user_data )
 {
+    const ps_objects_slot *slot = NULL;
+
+    // the listener does the work, sleep for 100 milliseconds
+    if( !my_rt.enabled )
+    {
+        (void) psync_sleep_micro( 100000 );
+        return;
+    }
 
-    // sleep for 500 milliseconds
-    (void) psync_sleep_micro( 100000 );
+    // the first period makes this thread the control thread
+    if( my_period.cycles == 0 )
+    {
+        logRtEnterThread( &my_logger, &my_rt );
+    }
 
+    waitRtPeriod( &my_period );
 
+    if( (slot = takeRtMailbox( &my_mailbox )) != NULL )
+    {
+        ps_serial_control( (ps_msg_ref) &slot->msg, &control_latency );
+    }
+
+    // periodic report, every LATENCY_REPORT_NS
+    if( my_period.cycles % (LATENCY_REPORT_NS / CONTROL_PERIOD_NS) == 0 )
+    {
+        ps_latency_log( &my_period.latency );
+        logRtPeriod( &my_logger, &my_period, &my_mailbox );
+    }
 }